@@ -5,6 +5,7 @@
 #include "RootUtils.h"
 #include "FitterEngine.h"
 #include "ConfigUtils.h"
+#include "ForkedWorkers.h"
 
 #include "Logger.h"
 #include "CmdLineParser.h"
@@ -15,8 +16,12 @@
 #include "TH1D.h"
 #include "TH2D.h"
 
+#include "TRandom3.h"
+
 #include <string>
 #include <vector>
+#include <limits>
+#include <cstdint>
 
 
 #ifndef DISABLE_USER_HEADER
@@ -447,6 +452,9 @@ int main(int argc, char** argv){
 
     TH1D histogram{};
     std::vector<BinNormaliser> normList{};
+
+    std::vector<double> binVolumeList{};
+    std::vector<double> binDataSumList{}; // sum over the toys, before the bin volume
   };
   std::vector<CrossSectionData> crossSectionDataList{};
 
@@ -487,6 +495,23 @@ int main(int argc, char** argv){
       xsecEntry.normList.back().configure( normConfig );
     }
 
+    // bin volume
+    xsecEntry.binVolumeList.resize( sample.getHistogram().getNbBins(), 1 );
+    xsecEntry.binDataSumList.resize( sample.getHistogram().getNbBins(), 0 );
+    for( int iBin = 0 ; iBin < sample.getHistogram().getNbBins() ; iBin++ ){
+      auto& bin = sample.getHistogram().getBinContextList()[iBin].bin;
+      for( auto& edges : bin.getEdgesList() ){
+        if( edges.isConditionVar ){ continue; } // no volume, just a condition variable
+
+        // is this bin excluded from the normalisation ?
+        if( GenericToolbox::doesElementIsInVector(edges.varName, xsecEntry.normList, [](const BinNormaliser& n){ return n.disabledBinDim; }) ){
+          continue;
+        }
+
+        xsecEntry.binVolumeList[iBin] *= (edges.max - edges.min);
+      }
+    }
+
     xsecEntry.histogram = TH1D(
         sample.getName().c_str(),
         sample.getName().c_str(),
@@ -498,28 +523,38 @@ int main(int argc, char** argv){
 
   int nToys{ clParser.getOptionVal<int>("nToys") };
 
-  // no bin volume of events -> use the current weight container
-  for( auto& xsec : crossSectionDataList ){
-    {
-      auto& mcEvList{xsec.samplePtr->getEventList()};
-      std::for_each(mcEvList.begin(), mcEvList.end(), []( Event& ev_){ ev_.getWeights().current = 0; });
-    }
-//    {
-//      auto& dataEvList{xsec.samplePtr->getDataContainer().getEventList()};
-//      std::for_each(dataEvList.begin(), dataEvList.end(), []( Event& ev_){ ev_.getWeights().current = 0; });
-//    }
-  }
-
   bool enableEventMcThrow{true};
   bool enableStatThrowInToys{true};
   auto xsecCalcConfig   = GenericToolbox::Json::fetchValue( cHandler.getConfig(), "xsecCalcConfig", JsonType() );
   enableStatThrowInToys = GenericToolbox::Json::fetchValue( xsecCalcConfig, "enableStatThrowInToys", enableStatThrowInToys);
   enableEventMcThrow    = GenericToolbox::Json::fetchValue( xsecCalcConfig, "enableEventMcThrow", enableEventMcThrow);
 
-  auto writeBinDataFct = std::function<void()>([&]{
-    for( auto& xsec : crossSectionDataList ){
+  // toys propagated together in a single pass over the events.
+  int nToysPerBatch{1};
+  nToysPerBatch         = GenericToolbox::Json::fetchValue( xsecCalcConfig, "nToysPerBatch", nToysPerBatch);
+  LogThrowIf(nToysPerBatch < 1, "Invalid nToysPerBatch: " << nToysPerBatch);
+
+  // toys shared among forked processes. The workers inherit the loaded events.
+  int nToyWorkers{1};
+  nToyWorkers           = GenericToolbox::Json::fetchValue( xsecCalcConfig, "nToyWorkers", nToyWorkers);
+  LogThrowIf(nToyWorkers < 1, "Invalid nToyWorkers: " << nToyWorkers);
+  nToyWorkers = std::min(nToyWorkers, nToys);
+#ifdef GUNDAM_USING_CACHE_MANAGER
+  // the device context can't be shared with forked processes
+  if( GundamGlobals::isCacheManagerEnabled() and nToyWorkers > 1 ){
+    LogAlert << "nToyWorkers is ignored while the cache manager is enabled." << std::endl;
+    nToyWorkers = 1;
+  }
+#endif
 
-      xsec.branchBinsData.resetCurrentByteOffset();
+  int nBinsTotal{0};
+  for( auto& xsec : crossSectionDataList ){ nBinsTotal += xsec.samplePtr->getHistogram().getNbBins(); }
+
+  // the xsec value of every bin for the current parameters & histograms
+  auto computeBinDataFct = std::function<void(std::vector<double>&)>([&](std::vector<double>& binDataList_){
+    binDataList_.clear();
+    binDataList_.reserve( nBinsTotal );
+    for( auto& xsec : crossSectionDataList ){
       for( int iBin = 0 ; iBin < xsec.samplePtr->getHistogram().getNbBins() ; iBin++ ){
         double binData{ xsec.samplePtr->getHistogram().getBinContentList()[iBin].sumWeights };
 
@@ -544,41 +579,18 @@ int main(int argc, char** argv){
           }
         }
 
-        // no bin volume of events
-        {
-          auto& mcEvList{xsec.samplePtr->getEventList()};
-          std::for_each(mcEvList.begin(), mcEvList.end(), [&]( Event& ev_){
-            if( iBin != ev_.getIndices().bin ){ return; }
-            ev_.getWeights().current += binData;
-          });
-        }
-
-        // set event weight
-//        {
-//          auto& dataEvList{xsec.samplePtr->getDataContainer().getEventList()};
-//          std::for_each(dataEvList.begin(), dataEvList.end(), [&]( Event& ev_){
-//            if( iBin != ev_.getIndices().bin ){ return; }
-//            ev_.getWeights().current = binData;
-//          });
-//        }
-
-        // bin volume
-        auto& bin = xsec.samplePtr->getHistogram().getBinContextList()[iBin].bin;
-        double binVolume{1};
-
-        for( auto& edges : bin.getEdgesList() ){
-          if( edges.isConditionVar ){ continue; } // no volume, just a condition variable
-
-          // is this bin excluded from the normalisation ?
-          if( GenericToolbox::doesElementIsInVector(edges.varName, xsec.normList, [](const BinNormaliser& n){ return n.disabledBinDim; }) ){
-            continue;
-          }
-
-          binVolume *= (edges.max - edges.min);
-        }
+        binData /= xsec.binVolumeList[iBin];
+        binDataList_.emplace_back( binData );
+      }
+    }
+  });
 
-        binData /= binVolume;
-        xsec.branchBinsData.writeRawData( binData );
+  auto writeBinDataFct = std::function<void(const std::vector<double>&)>([&](const std::vector<double>& binDataList_){
+    size_t iBinGlobal{0};
+    for( auto& xsec : crossSectionDataList ){
+      xsec.branchBinsData.resetCurrentByteOffset();
+      for( int iBin = 0 ; iBin < xsec.samplePtr->getHistogram().getNbBins() ; iBin++ ){
+        xsec.branchBinsData.writeRawData( binDataList_[iBinGlobal++] );
       }
     }
   });
@@ -587,7 +599,9 @@ int main(int argc, char** argv){
     LogWarning << "Calculating weight at best-fit" << std::endl;
     for( auto& parSet : propagator.getParametersManager().getParameterSetsList() ){ parSet.moveParametersToPrior(); }
     propagator.propagateParameters();
-    writeBinDataFct();
+    std::vector<double> binDataList{};
+    computeBinDataFct(binDataList);
+    writeBinDataFct(binDataList);
     xsecAtBestFitTree->Fill();
     GenericToolbox::writeInTFile( GenericToolbox::mkdirTFile(calcXsecDir, "throws"), xsecAtBestFitTree );
   }
@@ -599,6 +613,19 @@ int main(int argc, char** argv){
   LogWarning << std::endl << GenericToolbox::addUpDownBars( "Generating toys..." ) << std::endl;
   propagator.getParametersManager().initializeStrippedGlobalCov();
 
+  // Each toy has its own random stream seeded from its index, so a toy doesn't
+  // depend on how the toys are batched or shared among the workers.
+  ULong_t toySeedBase{ gRandom->Integer( std::numeric_limits<UInt_t>::max() ) };
+  auto getToySeedFct = [&](int iToy_){
+    // splitmix64, folded to the 32 bits used by TRandom3 (0 would mean a UUID seed)
+    uint64_t x{ uint64_t(toySeedBase) + (uint64_t(iToy_) + 1) * 0x9E3779B97F4A7C15ULL };
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    x = x ^ (x >> 31);
+    auto seed = ULong_t( (x ^ (x >> 32)) & 0xFFFFFFFFULL );
+    return seed == 0 ? ULong_t(1) : seed;
+  };
+
   // stats printing
   GenericToolbox::Time::AveragedTimer<1> totalTimer{};
   GenericToolbox::Time::AveragedTimer<1> throwTimer{};
@@ -608,8 +635,7 @@ int main(int argc, char** argv){
   GenericToolbox::TablePrinter t{};
   std::stringstream progressSs;
   std::stringstream ss; ss << LogWarning.getPrefixString() << "Generating " << nToys << " toys...";
-  for( int iToy = 0 ; iToy < nToys ; iToy++ ){
-
+  auto displayProgressFct = [&](int iToy_){
     t.reset();
     t << "Total time" << GenericToolbox::TablePrinter::NextColumn;
     t << "Throw toys" << GenericToolbox::TablePrinter::NextColumn;
@@ -630,37 +656,94 @@ int main(int argc, char** argv){
     progressSs.str("");
     progressSs << t.generateTableString() << std::endl;
     progressSs << ss.str();
-    GenericToolbox::displayProgressBar( iToy+1, nToys, progressSs.str() );
+    GenericToolbox::displayProgressBar( iToy_+1, nToys, progressSs.str() );
+  };
 
-    // Do the throwing:
-    throwTimer.start();
-    propagator.getParametersManager().throwParametersFromGlobalCovariance( not GundamGlobals::isDebug() );
-    throwTimer.stop();
+  // generate the toys of the list, and hand over their bin data in the same order
+  std::vector<TRandom3> toyRandomList(nToysPerBatch);
+  auto generateToyListFct = [&](const std::vector<int>& toyList_, const std::function<void(int, const std::vector<double>&)>& onToyFct_){
+    TRandom* globalRandom{gRandom};
+    std::vector<double> binDataList{};
+    for( size_t iFirst = 0 ; iFirst < toyList_.size() ; iFirst += size_t(nToysPerBatch) ){
+      propagateTimer.start();
+      propagator.propagateParametersBatch(
+          int( std::min(size_t(nToysPerBatch), toyList_.size() - iFirst) ),
+          [&](int iBatchToy_){
+            // Do the throwing:
+            throwTimer.start();
+            toyRandomList[iBatchToy_].SetSeed( getToySeedFct( toyList_[iFirst + iBatchToy_] ) );
+            gRandom = &toyRandomList[iBatchToy_];
+            propagator.getParametersManager().throwParametersFromGlobalCovariance( not GundamGlobals::isDebug() );
+            gRandom = globalRandom;
+            throwTimer.stop();
+          },
+          [&](int iBatchToy_){
+            // the histograms now hold the propagated toy
+            if( iBatchToy_ == 0 ){ propagateTimer.stop(); }
+
+            if( enableStatThrowInToys ){
+              // MC stat (event by event) and Asimov -> toy data throws, in
+              // parallel: keyed by (seed, toy, sample, bin, event)
+              propagator.throwStatErrors(
+                  CounterRandom( toySeedBase, uint64_t(toyList_[iFirst + iBatchToy_]) ),
+                  enableEventMcThrow
+              );
+            }
 
-    propagateTimer.start();
-    propagator.propagateParameters();
+            // continue the random stream of the toy
+            gRandom = &toyRandomList[iBatchToy_];
 
-    if( enableStatThrowInToys ){
-      for( auto& xsec : crossSectionDataList ){
-        if( enableEventMcThrow and not xsec.samplePtr->isEventMcThrowDisabled() ){
-          // Take into account the finite amount of event in MC
-          xsec.samplePtr->getHistogram().throwEventMcError();
-        }
-        // Asimov bin content -> toy data
-        xsec.samplePtr->getHistogram().throwStatError();
-      }
+            otherTimer.start();
+            computeBinDataFct( binDataList );
+            otherTimer.stop();
+            gRandom = globalRandom;
+
+            onToyFct_( toyList_[iFirst + iBatchToy_], binDataList );
+          }
+      );
     }
-    propagateTimer.stop();
+  };
 
-    otherTimer.start();
-    // TODO: parallelize this
-    writeBinDataFct();
-    otherTimer.stop();
+  // the toys are written in order: the bin data are also summed for the event weights of the plots
+  auto writeToyFct = [&](int iToy_, const std::vector<double>& binDataList_){
+    displayProgressFct( iToy_ );
 
-    // Write the branches
     writeTimer.start();
+    writeBinDataFct( binDataList_ );
+    size_t iBinGlobal{0};
+    for( auto& xsec : crossSectionDataList ){
+      for( size_t iBin = 0 ; iBin < xsec.binDataSumList.size() ; iBin++ ){
+        xsec.binDataSumList[iBin] += binDataList_[iBinGlobal++] * xsec.binVolumeList[iBin];
+      }
+    }
     xsecThrowTree->Fill();
     writeTimer.stop();
+  };
+
+  if( nToyWorkers <= 1 ){
+    std::vector<int> toyList(nToys);
+    for( int iToy = 0 ; iToy < nToys ; iToy++ ){ toyList[iToy] = iToy; }
+    generateToyListFct( toyList, writeToyFct );
+  }
+  else{
+    LogInfo << "Sharing the toys among " << nToyWorkers << " worker processes." << std::endl;
+
+    // the workers send [iToy, bin data...], the toys are written in order
+    ForkedWorkers::run(
+        nToyWorkers, nToys, "toy worker",
+        [&](){
+          // only this thread survived the fork, the thread pools can't be used
+          propagator.setDevSingleThreadReweight( true );
+          propagator.setDevSingleThreadHistFill( true );
+        },
+        [&](const std::vector<int>& toyList_, const ForkedWorkers::SendFct& sendFct_){
+          generateToyListFct( toyList_, sendFct_ );
+        },
+        [&](int iToy_, const std::vector<double>& binDataList_){
+          LogThrowIf(binDataList_.size() != size_t(nBinsTotal), "Toy #" << iToy_ << " has " << binDataList_.size() << " bins instead of " << nBinsTotal);
+          writeToyFct( iToy_, binDataList_ );
+        }
+    );
   }
 
 
@@ -738,6 +821,7 @@ int main(int argc, char** argv){
       }
 
       std::for_each(mcEvList.begin(), mcEvList.end(), [&]( Event &ev_) {
+        ev_.getWeights().current = xsec.binDataSumList[ev_.getIndices().bin];
         ev_.getWeights().current /= nToys;
         ev_.getWeights().current /= double(nEventInBin[ev_.getIndices().bin]);
       });
@@ -0,0 +1,170 @@
+#include "CalculateSplineBatch.h"
+#include "CalculateCompactSpline.h"
+#include "CalculateUniformSpline.h"
+#include "CalculateMonotonicSpline.h"
+#include "CalculateGeneralSpline.h"
+#undef CHECK_OFFSET // also defined by CalculateGraph
+#include "CalculateGraph.h"
+
+#include "CmdLineParser.h"
+#include "Logger.h"
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cstring>
+#include <functional>
+
+
+#ifndef DISABLE_USER_HEADER
+LoggerInit([]{ Logger::getUserHeader() << "[" << FILENAME << "]"; });
+#endif
+
+// Compare the scalar Calculate*.h kernels with the SplineBatch kernels (for
+// every instruction set supported by the machine).  The dials are random
+// splines, and the batch results must be identical to the scalar ones.
+
+namespace {
+
+  typedef double (*ScalarKernel)(const double, const double, double, const double*, const int);
+
+  struct DialSample{
+    std::vector<std::vector<double>> dataList{};
+    std::vector<const double*> dataPtrList{};
+    std::vector<int> dimList{};
+    std::vector<double> xList{};
+    std::vector<double> lowerBoundList{};
+    std::vector<double> upperBoundList{};
+  };
+
+  // layout: "uniform" (low, step, y...), "slope" (low, step, y, dy...),
+  // "general" (low, step, y, dy, x...) or "graph" (y, x...)
+  DialSample generateSample(const std::string& layout_, int nDials_, int nKnots_, std::mt19937_64& rng_){
+    std::uniform_real_distribution<double> value(0.5, 1.5);
+    std::uniform_real_distribution<double> slope(-0.5, 0.5);
+    std::uniform_real_distribution<double> input(-3.5, 3.5); // a bit outside the knots
+
+    DialSample out;
+    out.dataList.resize(nDials_);
+    for( int iDial = 0 ; iDial < nDials_ ; iDial++ ){
+      auto& data = out.dataList[iDial];
+      const double low{-3};
+      const double step{6. / (nKnots_ - 1)};
+      if( layout_ != "graph" ){ data.emplace_back(low); data.emplace_back(step); }
+      for( int iKnot = 0 ; iKnot < nKnots_ ; iKnot++ ){
+        data.emplace_back( value(rng_) );
+        if( layout_ == "slope" or layout_ == "general" ){ data.emplace_back( slope(rng_) ); }
+        if( layout_ == "general" or layout_ == "graph" ){ data.emplace_back( low + iKnot * step ); }
+      }
+
+      out.dimList.emplace_back( layout_ == "uniform" ? int(data.size()) - 2 : int(data.size()) );
+      out.xList.emplace_back( input(rng_) );
+      out.lowerBoundList.emplace_back( 0.75 );
+      out.upperBoundList.emplace_back( 1.25 );
+    }
+    for( auto& data : out.dataList ){ out.dataPtrList.emplace_back( data.data() ); }
+    return out;
+  }
+
+  double timeIt(int nRepeat_, const std::function<void()>& fct_){
+    fct_(); // warm up
+    auto start = std::chrono::steady_clock::now();
+    for( int iRepeat = 0 ; iRepeat < nRepeat_ ; iRepeat++ ){ fct_(); }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / nRepeat_;
+  }
+
+}
+
+
+int main(int argc, char** argv){
+
+  CmdLineParser clParser;
+  clParser.getDescription() << " > " << FILENAME << " benchmarks the batch spline kernels against the scalar ones." << std::endl;
+
+  clParser.addOption("nDials",  {"-n", "--n-dials"}, "Number of dials evaluated per batch (default: 100000)");
+  clParser.addOption("nKnots",  {"-k", "--n-knots"}, "Number of knots of each dial (default: 7)");
+  clParser.addOption("nRepeat", {"-r", "--repeat"}, "Number of times each batch is evaluated (default: 100)");
+
+  LogInfo << "Usage: " << std::endl;
+  LogInfo << clParser.getConfigSummary() << std::endl << std::endl;
+
+  clParser.parseCmdLine(argc, argv);
+
+  const int nDials{clParser.isOptionTriggered("nDials") ? clParser.getOptionVal<int>("nDials") : 100000};
+  const int nKnots{clParser.isOptionTriggered("nKnots") ? clParser.getOptionVal<int>("nKnots") : 7};
+  const int nRepeat{clParser.isOptionTriggered("nRepeat") ? clParser.getOptionVal<int>("nRepeat") : 100};
+  LogThrowIf(nDials < 1 or nKnots < 4 or nRepeat < 1, "Invalid options.");
+
+  struct KernelDef{
+    std::string name;
+    std::string layout;
+    ScalarKernel scalarKernel;
+    SplineBatch::BatchFct batchKernel;
+  };
+  std::vector<KernelDef> kernelList{
+      {"CompactSpline",   "uniform", &CalculateCompactSpline,   &SplineBatch::evalCompactSpline},
+      {"MonotonicSpline", "uniform", &CalculateMonotonicSpline, &SplineBatch::evalMonotonicSpline},
+      {"UniformSpline",   "slope",   &CalculateUniformSpline,   &SplineBatch::evalUniformSpline},
+      {"GeneralSpline",   "general", &CalculateGeneralSpline,   &SplineBatch::evalGeneralSpline},
+      {"Graph",           "graph",   &CalculateGraph,           &SplineBatch::evalGraph},
+  };
+
+  std::vector<SplineBatch::Isa> isaList{SplineBatch::Isa::Portable};
+  for( auto isa : {SplineBatch::Isa::Avx2, SplineBatch::Isa::Avx512} ){
+    SplineBatch::setIsa( isa );
+    if( SplineBatch::getIsa() == isa ){ isaList.emplace_back( isa ); }
+  }
+  const auto bestIsa = SplineBatch::getBestSupportedIsa();
+
+  LogInfo << "Best supported instruction set: " << SplineBatch::getIsaName( bestIsa ) << std::endl;
+  LogInfo << nDials << " dials with " << nKnots << " knots, " << nRepeat << " repetitions." << std::endl;
+
+  std::mt19937_64 rng{12345};
+  bool isAllIdentical{true};
+  for( auto& kernel : kernelList ){
+    if( kernel.layout == "general" and nKnots > 16 ){ continue; } // the general spline search is limited to 16 knots
+    auto sample = generateSample( kernel.layout, nDials, nKnots, rng );
+
+    std::vector<double> scalarResults(nDials);
+    double scalarTime = timeIt(nRepeat, [&]{
+      for( int iDial = 0 ; iDial < nDials ; iDial++ ){
+        scalarResults[iDial] = kernel.scalarKernel(
+            sample.xList[iDial], sample.lowerBoundList[iDial], sample.upperBoundList[iDial],
+            sample.dataPtrList[iDial], sample.dimList[iDial]
+        );
+      }
+    });
+    LogInfo << kernel.name << ": scalar " << scalarTime / nDials << " ns/dial" << std::endl;
+
+    std::vector<double> batchResults(nDials);
+    SplineBatch::Batch batch;
+    batch.size = nDials;
+    batch.x = sample.xList.data();
+    batch.lowerBound = sample.lowerBoundList.data();
+    batch.upperBound = sample.upperBoundList.data();
+    batch.data = sample.dataPtrList.data();
+    batch.dim = sample.dimList.data();
+    batch.result = batchResults.data();
+
+    for( auto isa : isaList ){
+      SplineBatch::setIsa( isa );
+      std::fill( batchResults.begin(), batchResults.end(), 0 );
+      double batchTime = timeIt(nRepeat, [&]{ kernel.batchKernel( batch ); });
+      bool isIdentical{ std::memcmp(batchResults.data(), scalarResults.data(), nDials * sizeof(double)) == 0 };
+      isAllIdentical &= isIdentical;
+      LogInfo << kernel.name << ": batch " << SplineBatch::getIsaName( isa ) << " "
+              << batchTime / nDials << " ns/dial (x" << scalarTime / batchTime << ")"
+              << ( isIdentical ? "" : " -> DIFFERENT RESULTS" ) << std::endl;
+    }
+  }
+  SplineBatch::setIsa( bestIsa );
+
+  LogThrowIf(not isAllIdentical, "The batch kernels don't reproduce the scalar kernels.");
+  return EXIT_SUCCESS;
+}
+
+// Local Variables:
+// mode:c++
+// c-basic-offset:2
+// End:
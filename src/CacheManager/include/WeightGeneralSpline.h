@@ -4,6 +4,8 @@
 #include "CacheWeights.h"
 #include "WeightBase.h"
 
+#include "CalculateSegmentHint.h"
+
 #include "hemi/array.h"
 
 class SplineDial;
@@ -52,6 +54,10 @@ private:
   std::size_t    fSplineSpaceUsed;
   std::unique_ptr<hemi::Array<WEIGHT_BUFFER_FLOAT>> fSplineSpace;
 
+  /// The segment found by the last knot search for each parameter.  This is
+  /// only used when the weights are calculated on the host.
+  std::vector<SegmentHint> fSegmentHints;
+
 public:
   // A static method to return the number of knots that will be used by this
   // spline.
@@ -94,6 +100,11 @@ public:
   /// are used.
   std::size_t GetSplinesUsed() {return fSplinesUsed;}
 
+  /// The number of evaluations, and the number of knot searches avoided by
+  /// the segment hints (host calculation only).
+  long GetSegmentHintCalls() const;
+  long GetSegmentHintHits() const;
+
   /// Return the number of elements reserved to hold knots.
   std::size_t GetSplineSpaceReserved() const {return fSplineSpaceReserved;}
 
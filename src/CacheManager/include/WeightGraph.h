@@ -4,6 +4,8 @@
 #include "CacheWeights.h"
 #include "WeightBase.h"
 
+#include "CalculateSegmentHint.h"
+
 #include "hemi/array.h"
 
 #include <cstdint>
@@ -47,6 +49,10 @@ private:
   std::size_t    fGraphSpaceUsed;
   std::unique_ptr<hemi::Array<WEIGHT_BUFFER_FLOAT>> fGraphSpace;
 
+  /// The segment found by the last knot search for each parameter.  This is
+  /// only used when the weights are calculated on the host.
+  std::vector<SegmentHint> fSegmentHints;
+
 public:
   // Construct the class.  This should allocate all the memory on the host
   // and on the GPU.  The "results" are the total number of results to be
@@ -79,6 +85,11 @@ public:
   /// Return the number of graphs that were filled.
   std::size_t GetGraphsUsed() {return fGraphsUsed;}
 
+  /// The number of evaluations, and the number of knot searches avoided by
+  /// the segment hints (host calculation only).
+  long GetSegmentHintCalls() const;
+  long GetSegmentHintHits() const;
+
   /// Return the number of elements reserved to hold space.
   std::size_t GetGraphSpaceReserved() const {return fGraphSpaceReserved;}
 
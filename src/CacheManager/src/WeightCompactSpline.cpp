@@ -244,6 +244,7 @@ double Cache::Weight::CompactSpline::GetSplineKnot(int sIndex, int knot) {
 
 #include "CacheAtomicMult.h"
 #include "CalculateCompactSpline.h"
+#include "CalculateSplineBatch.h"
 
 // Define CACHE_DEBUG to get lots of output from the host
 #undef CACHE_DEBUG
@@ -302,6 +303,21 @@ void Cache::Weight::CompactSpline::Reset() {
 bool Cache::Weight::CompactSpline::Apply() {
   if (GetSplinesUsed() < 1) return false;
 
+#ifndef HEMI_CUDA_COMPILER
+  // The host launch runs the kernel serially, so use the batch kernels
+  // instead.  The weights are multiplied in the same order, so the results
+  // are identical.
+  SplineBatch::evalIndexed(&SplineBatch::evalCompactSpline, -2,
+                           GetSplinesUsed(),
+                           fWeights.writeOnlyPtr(),
+                           fParameters.readOnlyPtr(),
+                           fLowerClamp.readOnlyPtr(),
+                           fUpperClamp.readOnlyPtr(),
+                           fSplineSpace->readOnlyPtr(),
+                           fSplineResult->readOnlyPtr(),
+                           fSplineParameter->readOnlyPtr(),
+                           fSplineIndex->readOnlyPtr());
+#else
   HEMISplinesKernel splinesKernel;
   hemi::launch(splinesKernel,
                fWeights.writeOnlyPtr(),
@@ -314,6 +330,7 @@ bool Cache::Weight::CompactSpline::Apply() {
                fSplineIndex->readOnlyPtr(),
                GetSplinesUsed()
   );
+#endif
 
   return true;
 }
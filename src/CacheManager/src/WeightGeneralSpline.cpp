@@ -316,9 +316,46 @@ void Cache::Weight::GeneralSpline::Reset() {
   fSplineSpaceUsed = 0;
 }
 
+long Cache::Weight::GeneralSpline::GetSegmentHintCalls() const {
+  long calls = 0;
+  for (const SegmentHint& hint : fSegmentHints) calls += hint.nCalls;
+  return calls;
+}
+
+long Cache::Weight::GeneralSpline::GetSegmentHintHits() const {
+  long hits = 0;
+  for (const SegmentHint& hint : fSegmentHints) hits += hint.nHits;
+  return hits;
+}
+
 bool Cache::Weight::GeneralSpline::Apply() {
   if (GetSplinesUsed() < 1) return false;
 
+#ifndef HEMI_CUDA_COMPILER
+  // The host launch runs the kernel serially, so the segment found for a
+  // parameter can be used as the hint for the next spline of the same
+  // parameter (see CalculateSegmentHint.h).
+  if (fSegmentHints.size() != fParameters.size()) {
+    fSegmentHints.resize(fParameters.size());
+  }
+  double* results = fWeights.writeOnlyPtr();
+  const double* params = fParameters.readOnlyPtr();
+  const double* lowerClamp = fLowerClamp.readOnlyPtr();
+  const double* upperClamp = fUpperClamp.readOnlyPtr();
+  const WEIGHT_BUFFER_FLOAT* knots = fSplineSpace->readOnlyPtr();
+  const int* rIndex = fSplineResult->readOnlyPtr();
+  const short* pIndex = fSplineParameter->readOnlyPtr();
+  const int* sIndex = fSplineIndex->readOnlyPtr();
+  const int NP = GetSplinesUsed();
+  for (int i = 0; i < NP; ++i) {
+    const int id0 = sIndex[i];
+    const int dim = sIndex[i+1]-id0;
+    const int iPar = pIndex[i];
+    results[rIndex[i]] *= CalculateGeneralSplineHinted(
+        params[iPar], lowerClamp[iPar], upperClamp[iPar],
+        &knots[id0], dim, fSegmentHints[iPar]);
+  }
+#else
   HEMISplinesKernel splinesKernel;
   hemi::launch(splinesKernel,
                fWeights.writeOnlyPtr(),
@@ -331,6 +368,7 @@ bool Cache::Weight::GeneralSpline::Apply() {
                fSplineIndex->readOnlyPtr(),
                GetSplinesUsed()
   );
+#endif
 
   return true;
 }
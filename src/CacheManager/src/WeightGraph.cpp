@@ -300,9 +300,46 @@ void Cache::Weight::Graph::Reset() {
   fGraphSpaceUsed = 0;
 }
 
+long Cache::Weight::Graph::GetSegmentHintCalls() const {
+  long calls = 0;
+  for (const SegmentHint& hint : fSegmentHints) calls += hint.nCalls;
+  return calls;
+}
+
+long Cache::Weight::Graph::GetSegmentHintHits() const {
+  long hits = 0;
+  for (const SegmentHint& hint : fSegmentHints) hits += hint.nHits;
+  return hits;
+}
+
 bool Cache::Weight::Graph::Apply() {
   if (GetGraphsUsed() < 1) return false;
 
+#ifndef HEMI_CUDA_COMPILER
+  // The host launch runs the kernel serially, so the segment found for a
+  // parameter can be used as the hint for the next graph of the same
+  // parameter (see CalculateSegmentHint.h).
+  if (fSegmentHints.size() != fParameters.size()) {
+    fSegmentHints.resize(fParameters.size());
+  }
+  double* results = fWeights.writeOnlyPtr();
+  const double* params = fParameters.readOnlyPtr();
+  const double* lowerClamp = fLowerClamp.readOnlyPtr();
+  const double* upperClamp = fUpperClamp.readOnlyPtr();
+  const WEIGHT_BUFFER_FLOAT* knots = fGraphSpace->readOnlyPtr();
+  const int* rIndex = fGraphResult->readOnlyPtr();
+  const short* pIndex = fGraphParameter->readOnlyPtr();
+  const int* sIndex = fGraphIndex->readOnlyPtr();
+  const int NP = GetGraphsUsed();
+  for (int i = 0; i < NP; ++i) {
+    const int id0 = sIndex[i];
+    const int dim = sIndex[i+1]-id0;
+    const int iPar = pIndex[i];
+    results[rIndex[i]] *= CalculateGraphHinted(
+        params[iPar], lowerClamp[iPar], upperClamp[iPar],
+        &knots[id0], dim, fSegmentHints[iPar]);
+  }
+#else
   HEMIGraphsKernel graphsKernel;
   hemi::launch(graphsKernel,
                fWeights.writeOnlyPtr(),
@@ -315,6 +352,7 @@ bool Cache::Weight::Graph::Apply() {
                fGraphIndex->readOnlyPtr(),
                GetGraphsUsed()
   );
+#endif
 
   return true;
 }
@@ -277,6 +277,7 @@ double Cache::Weight::MonotonicSpline::GetSplineKnot(int sIndex, int knot) {
 
 #include "CacheAtomicMult.h"
 #include "CalculateMonotonicSpline.h"
+#include "CalculateSplineBatch.h"
 
 // Define CACHE_DEBUG to get lots of output from the host
 #undef CACHE_DEBUG
@@ -333,6 +334,21 @@ void Cache::Weight::MonotonicSpline::Reset() {
 bool Cache::Weight::MonotonicSpline::Apply() {
   if (GetSplinesUsed() < 1) return false;
 
+#ifndef HEMI_CUDA_COMPILER
+  // The host launch runs the kernel serially, so use the batch kernels
+  // instead.  The weights are multiplied in the same order, so the results
+  // are identical.
+  SplineBatch::evalIndexed(&SplineBatch::evalMonotonicSpline, -2,
+                           GetSplinesUsed(),
+                           fWeights.writeOnlyPtr(),
+                           fParameters.readOnlyPtr(),
+                           fLowerClamp.readOnlyPtr(),
+                           fUpperClamp.readOnlyPtr(),
+                           fSplineSpace->readOnlyPtr(),
+                           fSplineResult->readOnlyPtr(),
+                           fSplineParameter->readOnlyPtr(),
+                           fSplineIndex->readOnlyPtr());
+#else
   HEMISplinesKernel splinesKernel;
   hemi::launch(splinesKernel,
                fWeights.writeOnlyPtr(),
@@ -345,6 +361,7 @@ bool Cache::Weight::MonotonicSpline::Apply() {
                fSplineIndex->readOnlyPtr(),
                GetSplinesUsed()
   );
+#endif
 
   return true;
 }
@@ -268,6 +268,7 @@ double Cache::Weight::UniformSpline::GetSplineKnotSlope(int sIndex, int knot) {
 
 #include "CacheAtomicMult.h"
 #include "CalculateUniformSpline.h"
+#include "CalculateSplineBatch.h"
 
 // Define CACHE_DEBUG to get lots of output from the host
 #undef CACHE_DEBUG
@@ -339,6 +340,21 @@ void Cache::Weight::UniformSpline::Reset() {
 bool Cache::Weight::UniformSpline::Apply() {
   if (GetSplinesUsed() < 1) return false;
 
+#ifndef HEMI_CUDA_COMPILER
+  // The host launch runs the kernel serially, so use the batch kernels
+  // instead.  The weights are multiplied in the same order, so the results
+  // are identical.
+  SplineBatch::evalIndexed(&SplineBatch::evalUniformSpline, 0,
+                           GetSplinesUsed(),
+                           fWeights.writeOnlyPtr(),
+                           fParameters.readOnlyPtr(),
+                           fLowerClamp.readOnlyPtr(),
+                           fUpperClamp.readOnlyPtr(),
+                           fSplineSpace->readOnlyPtr(),
+                           fSplineResult->readOnlyPtr(),
+                           fSplineParameter->readOnlyPtr(),
+                           fSplineIndex->readOnlyPtr());
+#else
   HEMISplinesKernel splinesKernel;
   hemi::launch(splinesKernel,
                fWeights.writeOnlyPtr(),
@@ -351,6 +367,7 @@ bool Cache::Weight::UniformSpline::Apply() {
                fSplineIndex->readOnlyPtr(),
                GetSplinesUsed()
   );
+#endif
 
   return true;
 }
@@ -1122,10 +1122,8 @@ void DataDispenser::fillFunction(int iThread_){
 
           // dialBase is valid -> store it
           if (dialBase != nullptr) {
-            size_t freeSlotDial = dialCollectionRef->getNextDialFreeSlot();
             dialBase->setAllowExtrapolation(dialCollectionRef->isAllowDialExtrapolation());
-            dialCollectionRef->getDialBaseList()[freeSlotDial] = DialCollection::DialBaseObject(
-              dialBase.release());
+            size_t freeSlotDial = dialCollectionRef->storeEventDial(std::move(dialBase));
 
             dialEntryPtr->collectionIndex = iCollection;
             dialEntryPtr->interfaceIndex = freeSlotDial;
@@ -1163,12 +1161,10 @@ void DataDispenser::fillFunction(int iThread_){
               )
           );
 
-          // dialBase is valid -> store it
+          // dialBase is valid -> store it (or share an identical one)
           if (dialBase != nullptr) {
-            size_t freeSlotDial = dialCollectionRef->getNextDialFreeSlot();
             dialBase->setAllowExtrapolation(dialCollectionRef->isAllowDialExtrapolation());
-            dialCollectionRef->getDialBaseList()[freeSlotDial] = DialCollection::DialBaseObject(
-                dialBase.release());
+            size_t freeSlotDial = dialCollectionRef->storeEventDial(std::move(dialBase));
 
             dialEntryPtr->collectionIndex = iCollection;
             dialEntryPtr->interfaceIndex = freeSlotDial;
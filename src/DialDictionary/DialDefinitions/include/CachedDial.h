@@ -7,18 +7,30 @@
 
 #include "DialInputBuffer.h"
 
-/// This is a template to add caching to a DialBase derived class.
+#include <atomic>
+#include <cstdint>
+
+/// This is a template to add caching to a DialBase derived class.  The
+/// cache is keyed by the version of the input buffer (see
+/// DialInputBuffer::getVersion()), and is lock free: the response is
+/// guarded by the version as a sequence lock.  A thread which can't take
+/// the cache (another thread is filling it) returns its own response
+/// without storing it.
 template <typename T> class CachedDial: public T {
 public:
   CachedDial() = default;
+  CachedDial(const CachedDial& other_): T(other_) {}
+  CachedDial& operator=(const CachedDial& other_){ T::operator=(other_); _cachedVersion_ = 0; return *this; }
+
   double evalResponse(const DialInputBuffer& input_) const override;
   bool isCacheValid(const DialInputBuffer& input_) const;
-  void updateInputCache(const DialInputBuffer& input_) const;
 
 protected:
-  mutable double _cachedResponse_{std::nan("unset")}; // + 8 bytes
-  mutable GenericToolbox::NoCopyWrapper<std::mutex> _evalLock_{}; // + 64 bytes
-  mutable std::vector<double> _cachedInputs_{}; // + 24 bytes
+  // The version of the input used for the cached response: 0 while the
+  // cache is empty, busyVersion while it is being filled.
+  static constexpr uint64_t busyVersion{UINT64_MAX};
+  mutable std::atomic<uint64_t> _cachedVersion_{0}; // + 8 bytes
+  mutable std::atomic<double> _cachedResponse_{std::nan("unset")}; // + 8 bytes
 };
 
 
@@ -8,29 +8,30 @@
 #include "CachedDial.h"
 
 template <typename T> double CachedDial<T>::evalResponse(const DialInputBuffer& input_) const {
-  if (isCacheValid(input_)) {return _cachedResponse_;}
-  #if HAS_CPP_17
-  std::scoped_lock<std::mutex> g(_evalLock_);
-  #else
-  std::lock_guard<std::mutex> g(_evalLock_);
-  #endif
-  if (isCacheValid(input_)) {return _cachedResponse_;}
-  _cachedResponse_ = this->T::evalResponse(input_);
-  updateInputCache(input_);
-  return _cachedResponse_;
+  const uint64_t version{input_.getVersion()};
+
+  // read the response, and check that the version didn't change meanwhile
+  uint64_t cachedVersion{_cachedVersion_.load(std::memory_order_acquire)};
+  if( cachedVersion == version ){
+    const double response{_cachedResponse_.load(std::memory_order_relaxed)};
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if( _cachedVersion_.load(std::memory_order_relaxed) == version ){ return response; }
+    cachedVersion = _cachedVersion_.load(std::memory_order_acquire);
+  }
+
+  const double response{this->T::evalResponse(input_)};
+
+  // only one thread fills the cache, the others don't wait for it
+  if( cachedVersion != busyVersion
+      and _cachedVersion_.compare_exchange_strong(cachedVersion, busyVersion, std::memory_order_relaxed) ){
+    std::atomic_thread_fence(std::memory_order_release);
+    _cachedResponse_.store(response, std::memory_order_relaxed);
+    _cachedVersion_.store(version, std::memory_order_release);
+  }
+  return response;
 }
 template <typename T> bool CachedDial<T>::isCacheValid(const DialInputBuffer& input_) const {
-  if( _cachedInputs_.size() != input_.getBufferSize() ) return false;
-  return ( memcmp(
-             _cachedInputs_.data(), input_.getInputBuffer().data(),
-             input_.getBufferSize() * sizeof(*input_.getInputBuffer().data())) == 0 );
-}
-template <typename T> void CachedDial<T>::updateInputCache(const DialInputBuffer& input_) const {
-  if( _cachedInputs_.size() != input_.getBufferSize() ){
-    _cachedInputs_.resize(input_.getBufferSize(), std::nan("unset"));
-  }
-  memcpy(_cachedInputs_.data(), input_.getInputBuffer().data(),
-         input_.getBufferSize() * sizeof(*input_.getInputBuffer().data()));
+  return _cachedVersion_.load(std::memory_order_acquire) == input_.getVersion();
 }
 
 #endif //GUNDAM_CACHEDDIAL_IMPL_H
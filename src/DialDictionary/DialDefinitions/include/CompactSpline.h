@@ -24,6 +24,12 @@ public:
   [[nodiscard]] std::string getDialTypeName() const override { return {"CompactSpline"}; }
   [[nodiscard]] double evalResponse(const DialInputBuffer& input_) const override;
 
+  /// The input and the dim argument given to the spline kernel by
+  /// evalResponse() (also used by the batch kernels of CalculateSplineBatch.h).
+  [[nodiscard]] double getKernelInput(const DialInputBuffer& input_) const;
+  [[nodiscard]] int getKernelDim() const { return int(_splineData_.size()-2); }
+  [[nodiscard]] const DialUtils::Range& getSplineBounds() const { return _splineBounds_; }
+
   [[nodiscard]] std::string getSummary() const override;
 
   void setAllowExtrapolation(bool allowExtrapolation) override;
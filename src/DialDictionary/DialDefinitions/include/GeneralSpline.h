@@ -8,6 +8,7 @@
 #include "DialBase.h"
 #include "DialUtils.h"
 #include "DialInputBuffer.h"
+#include "CalculateSegmentHint.h"
 
 #include "TGraph.h"
 #include "TSpline.h"
@@ -25,6 +26,16 @@ public:
   [[nodiscard]] std::string getDialTypeName() const override { return {"GeneralSpline"}; }
   [[nodiscard]] double evalResponse(const DialInputBuffer& input_) const override;
 
+  /// The input and the dim argument given to the spline kernel by
+  /// evalResponse() (also used by the batch kernels of CalculateSplineBatch.h).
+  [[nodiscard]] double getKernelInput(const DialInputBuffer& input_) const;
+  [[nodiscard]] int getKernelDim() const { return int(_splineData_.size()); }
+  [[nodiscard]] const DialUtils::Range& getSplineBounds() const { return _splineBounds_; }
+
+  /// Same as evalResponse(), but the knot search starts from the segment of
+  /// the previous evaluation (see CalculateSegmentHint.h).
+  [[nodiscard]] double evalResponse(const DialInputBuffer& input_, SegmentHint& segmentHint_) const;
+
   void setAllowExtrapolation(bool allowExtrapolation) override;
   [[nodiscard]] bool getAllowExtrapolation() const override;
 
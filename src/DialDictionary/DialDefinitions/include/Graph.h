@@ -23,6 +23,8 @@ public:
 
   virtual void buildDial(const TGraph& grf, const std::string& option_="") override;
 
+  [[nodiscard]] const TGraph& getGraph() const { return _graph_; }
+
 protected:
   [[nodiscard]] double evaluateGraph(const DialInputBuffer& input_) const;
 
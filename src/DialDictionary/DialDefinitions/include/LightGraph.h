@@ -6,6 +6,7 @@
 #define GUNDAM_LIGHTGRAPH_H
 
 #include "DialBase.h"
+#include "CalculateSegmentHint.h"
 
 #include "TGraph.h"
 
@@ -24,6 +25,10 @@ public:
   [[nodiscard]] std::string getDialTypeName() const override { return {"LightGraph"}; }
   [[nodiscard]] double evalResponse(const DialInputBuffer& input_) const override;
 
+  /// Same as evalResponse(), but the knot search starts from the segment of
+  /// the previous evaluation (see CalculateSegmentHint.h).
+  [[nodiscard]] double evalResponse(const DialInputBuffer& input_, SegmentHint& segmentHint_) const;
+
   void setAllowExtrapolation(bool allowExtrapolation) override;
   [[nodiscard]] bool getAllowExtrapolation() const override;
 
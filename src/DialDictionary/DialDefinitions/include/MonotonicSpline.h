@@ -24,6 +24,11 @@ public:
   [[nodiscard]] std::string getDialTypeName() const override { return {"MonotonicSpline"}; }
   [[nodiscard]] double evalResponse(const DialInputBuffer& input_) const override;
 
+  /// The input and the dim argument given to the spline kernel by
+  /// evalResponse() (also used by the batch kernels of CalculateSplineBatch.h).
+  [[nodiscard]] double getKernelInput(const DialInputBuffer& input_) const;
+  [[nodiscard]] int getKernelDim() const { return int(_splineData_.size()-2); }
+
   void setAllowExtrapolation(bool allowExtrapolation) override;
   [[nodiscard]] bool getAllowExtrapolation() const override;
 
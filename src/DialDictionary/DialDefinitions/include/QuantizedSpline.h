@@ -0,0 +1,59 @@
+#ifndef GUNDAM_QUANTIZEDSPLINE_H
+#define GUNDAM_QUANTIZEDSPLINE_H
+
+#include "DialBase.h"
+#include "DialUtils.h"
+#include "DialInputBuffer.h"
+
+#include <vector>
+#include <cstdint>
+
+// A spline with uniformly spaced knots, like the UniformSpline, whose knot
+// values and slopes are stored as 16 bit fixed point numbers (see
+// CalculateQuantizedSpline.h).  The knot data takes a quarter of the memory
+// of a UniformSpline, at the price of a small error on the response.  The
+// quantised dials are made by DialCollection::quantizeDials().
+class QuantizedSpline : public DialBase {
+
+public:
+  QuantizedSpline() = default;
+  ~QuantizedSpline() override = default;
+
+  [[nodiscard]] std::unique_ptr<DialBase> clone() const override { return std::make_unique<QuantizedSpline>(*this); }
+  [[nodiscard]] std::string getDialTypeName() const override { return {"QuantizedSpline"}; }
+  [[nodiscard]] double evalResponse(const DialInputBuffer& input_) const override;
+
+  /// The input given to the spline kernel by evalResponse().
+  [[nodiscard]] double getKernelInput(const DialInputBuffer& input_) const;
+  [[nodiscard]] int getNbKnots() const { return int(_knotCodes_.size()/2); }
+
+  [[nodiscard]] std::string getSummary() const override;
+
+  void setAllowExtrapolation(bool allowExtrapolation) override;
+  [[nodiscard]] bool getAllowExtrapolation() const override;
+
+  /// Build from the knot positions (uniformly spaced), values and slopes.
+  void buildDial(const std::vector<double>& xPoints,
+                 const std::vector<double>& yPoints,
+                 const std::vector<double>& deriv,
+                 const std::string& option_="") override;
+
+  /// The knots decoded in the layout of the UniformSpline data (used for
+  /// the Cache::Manager, which doesn't store the quantised knots).
+  [[nodiscard]] std::vector<double> getDecodedData() const;
+
+  /// The memory used by the knot data, in bytes.
+  [[nodiscard]] size_t getKnotDataSize() const { return sizeof(_splineHeader_) + _knotCodes_.size()*sizeof(std::uint16_t); }
+
+protected:
+  bool _allowExtrapolation_{false};
+
+  // {lower bound, step, value offset, value scale, slope offset, slope scale}
+  double _splineHeader_[6]{0, 1, 0, 0, 0, 0};
+
+  // The codes of the value and of the slope of each knot.
+  std::vector<std::uint16_t> _knotCodes_{};
+  DialUtils::Range _splineBounds_{std::nan("unset"), std::nan("unset")};
+};
+
+#endif //GUNDAM_QUANTIZEDSPLINE_H
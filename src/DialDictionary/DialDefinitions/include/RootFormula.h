@@ -6,10 +6,16 @@
 #define GUNDAM_ROOTFORMULA_H
 
 #include "DialBase.h"
+#include "FormulaProgram.h"
+
+#include "GenericToolbox.Wrappers.h"
 
 #include "TFormula.h"
 
 #include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
 
 
 class RootFormula : public DialBase {
@@ -24,12 +30,32 @@ public:
 
   void setFormulaStr(const std::string& formulaStr_);
 
-  TFormula& getFormula(){ return _formula_; }
+  /// Set a parameter of the formula (e.g. the bin center of a variable).
+  /// The parameters must be set through here to stay in sync with the
+  /// compiled program.
+  void setParameter(const std::string& name_, double value_);
+
+  [[nodiscard]] const TFormula& getFormula() const { return _formula_; }
+
+  /// The compiled formula (shared by the dials with the same formula), or
+  /// nullptr if the expression couldn't be compiled and the TFormula is
+  /// evaluated instead.
+  [[nodiscard]] const FormulaProgram* getProgram() const { return _program_.get(); }
+
+  /// The parameter values, in the order of the program parameters.
+  [[nodiscard]] const double* getParameterData() const { return _parameterList_.data(); }
 
 
 private:
   TFormula _formula_{};
 
+  std::shared_ptr<const FormulaProgram> _program_{};
+  std::vector<int> _formulaParIndexList_{}; // TFormula index of each program parameter
+  std::vector<double> _parameterList_{};
+
+  // TFormula::EvalPar isn't guaranteed to be thread safe
+  mutable GenericToolbox::NoCopyWrapper<std::mutex> _formulaLock_{};
+
 };
 
 
@@ -19,6 +19,9 @@ public:
   [[nodiscard]] double evalResponse(const DialInputBuffer& input_) const override;
 
   void setAllowExtrapolation(bool allowExtrapolation) override;
+  [[nodiscard]] bool getAllowExtrapolation() const override;
+
+  [[nodiscard]] const TSpline3 &getSpline() const;
 
   /// Pass information to the dial so that it can build it's
   /// internal information.  New build overloads should be
@@ -33,7 +36,6 @@ public:
 
 protected:
   void setSpline(const TSpline3 &spline);
-  [[nodiscard]] const TSpline3 &getSpline() const;
 
   void copySpline(const TSpline3* splinePtr_);
   void createSpline(TGraph* grPtr_);
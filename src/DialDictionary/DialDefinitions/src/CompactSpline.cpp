@@ -113,6 +113,9 @@ void CompactSpline::buildDial(const std::vector<double>& v1,
 }
 
 double CompactSpline::evalResponse(const DialInputBuffer& input_) const {
+  return CalculateCompactSpline( this->getKernelInput(input_), -1E20, 1E20, _splineData_.data(), this->getKernelDim() );
+}
+double CompactSpline::getKernelInput(const DialInputBuffer& input_) const {
   double dialInput{input_.getInputBuffer()[0]};
 
 #ifndef NDEBUG
@@ -124,7 +127,7 @@ double CompactSpline::evalResponse(const DialInputBuffer& input_) const {
     else if(dialInput >= _splineBounds_.max){ dialInput = _splineBounds_.max; }
   }
 
-  return CalculateCompactSpline( dialInput, -1E20, 1E20, _splineData_.data(), int(_splineData_.size()-2) );
+  return dialInput;
 }
 
 
@@ -72,6 +72,12 @@ void GeneralSpline::buildDial(const std::vector<double>& xPoints,
 }
 
 double GeneralSpline::evalResponse(const DialInputBuffer& input_) const {
+  return CalculateGeneralSpline( this->getKernelInput(input_), -1E20, 1E20, _splineData_.data(), this->getKernelDim() );
+}
+double GeneralSpline::evalResponse(const DialInputBuffer& input_, SegmentHint& segmentHint_) const {
+  return CalculateGeneralSplineHinted( this->getKernelInput(input_), -1E20, 1E20, _splineData_.data(), this->getKernelDim(), segmentHint_ );
+}
+double GeneralSpline::getKernelInput(const DialInputBuffer& input_) const {
   double dialInput{input_.getInputBuffer()[0]};
 
   if( not _allowExtrapolation_ ){
@@ -79,5 +85,5 @@ double GeneralSpline::evalResponse(const DialInputBuffer& input_) const {
     else if(dialInput >= _splineBounds_.max){ dialInput = _splineBounds_.max; }
   }
 
-  return CalculateGeneralSpline( dialInput, -1E20, 1E20, _splineData_.data(), int(_splineData_.size()) );
+  return dialInput;
 }
@@ -48,3 +48,17 @@ double LightGraph::evalResponse(const DialInputBuffer& input_) const {
 
   return CalculateGraph(dialInput,-1E20,1E20,_Data_.data(),_Data_.size());
 }
+double LightGraph::evalResponse(const DialInputBuffer& input_, SegmentHint& segmentHint_) const {
+  double dialInput{input_.getInputBuffer()[0]};
+
+#ifndef NDEBUG
+  LogThrowIf(not std::isfinite(dialInput), "Invalid input for LightGraph");
+#endif
+
+  if( not _allowExtrapolation_ ){
+    if     (dialInput <= _Data_[1])     { return _Data_[0]; }
+    else if(dialInput >= _Data_.back()) { return _Data_[_Data_.size()-2]; }
+  }
+
+  return CalculateGraphHinted(dialInput,-1E20,1E20,_Data_.data(),_Data_.size(),segmentHint_);
+}
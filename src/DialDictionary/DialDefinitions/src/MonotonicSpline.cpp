@@ -113,6 +113,9 @@ void MonotonicSpline::buildDial(const std::vector<double>& v1,
 }
 
 double MonotonicSpline::evalResponse(const DialInputBuffer& input_) const {
+  return CalculateMonotonicSpline( this->getKernelInput(input_), -1E20, 1E20, _splineData_.data(), this->getKernelDim() );
+}
+double MonotonicSpline::getKernelInput(const DialInputBuffer& input_) const {
   double dialInput{input_.getInputBuffer()[0]};
 
 #ifndef NDEBUG
@@ -124,5 +127,5 @@ double MonotonicSpline::evalResponse(const DialInputBuffer& input_) const {
     else if(dialInput >= _splineBounds_.max){ dialInput = _splineBounds_.max; }
   }
 
-  return CalculateMonotonicSpline( dialInput, -1E20, 1E20, _splineData_.data(), int(_splineData_.size()-2) );
+  return dialInput;
 }
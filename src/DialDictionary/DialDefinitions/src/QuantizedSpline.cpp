@@ -0,0 +1,98 @@
+#include "QuantizedSpline.h"
+#include "CalculateQuantizedSpline.h"
+
+#include "GenericToolbox.Root.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+
+#ifndef DISABLE_USER_HEADER
+LoggerInit([]{ Logger::setUserHeaderStr("[QuantizedSpline]"); });
+#endif
+
+void QuantizedSpline::setAllowExtrapolation(bool allowExtrapolation) {
+  _allowExtrapolation_ = allowExtrapolation;
+}
+
+bool QuantizedSpline::getAllowExtrapolation() const {
+  return _allowExtrapolation_;
+}
+
+void QuantizedSpline::buildDial(const std::vector<double>& xPoints,
+                                const std::vector<double>& yPoints,
+                                const std::vector<double>& deriv,
+                                const std::string& option_){
+  LogThrowIf(not _knotCodes_.empty(), "Spline data already set.");
+  LogThrowIf(xPoints.size() < 2, "QuantizedSplines require at least two knots");
+  LogThrowIf(yPoints.size() != xPoints.size() or deriv.size() != xPoints.size(),
+             "Inconsistent number of knot values and slopes");
+
+  _splineBounds_.min = xPoints.front();
+  _splineBounds_.max = xPoints.back();
+
+  _splineHeader_[0] = xPoints.front();
+  _splineHeader_[1] = (xPoints.back()-xPoints.front())/(xPoints.size()-1.0);
+
+  // Same check as UniformSpline::buildDial()
+  const double tolerance{std::sqrt(std::numeric_limits<float>::epsilon())};
+  for (int i=0; i<xPoints.size()-1; ++i) {
+    double d = std::abs(xPoints[i] - _splineHeader_[0] - i*_splineHeader_[1]);
+    LogThrowIf((d/_splineHeader_[1])>tolerance,
+               "QuantizedSplines require uniformly spaced knots");
+  }
+
+  // The offset is the smallest value, and the scale maps the largest one to
+  // the largest code.
+  auto setRange = [](const std::vector<double>& values_, double& offset_, double& scale_){
+    auto range = std::minmax_element(values_.begin(), values_.end());
+    offset_ = *range.first;
+    scale_ = (*range.second - *range.first)/QuantizedSplineMaxCode;
+  };
+  setRange(yPoints, _splineHeader_[2], _splineHeader_[3]);
+  setRange(deriv, _splineHeader_[4], _splineHeader_[5]);
+
+  _knotCodes_.resize(2*xPoints.size());
+  for (int i = 0; i < xPoints.size(); ++i) {
+    _knotCodes_[2*i + 0] = EncodeQuantizedSplineValue(yPoints[i], _splineHeader_[2], _splineHeader_[3]);
+    _knotCodes_[2*i + 1] = EncodeQuantizedSplineValue(deriv[i], _splineHeader_[4], _splineHeader_[5]);
+  }
+}
+
+std::vector<double> QuantizedSpline::getDecodedData() const {
+  std::vector<double> out(2 + _knotCodes_.size());
+  out[0] = _splineHeader_[0];
+  out[1] = _splineHeader_[1];
+  for (int i = 0; i < this->getNbKnots(); ++i) {
+    out[2 + 2*i + 0] = DecodeQuantizedSplineValue(_knotCodes_[2*i + 0], _splineHeader_[2], _splineHeader_[3]);
+    out[2 + 2*i + 1] = DecodeQuantizedSplineValue(_knotCodes_[2*i + 1], _splineHeader_[4], _splineHeader_[5]);
+  }
+  return out;
+}
+
+double QuantizedSpline::evalResponse(const DialInputBuffer& input_) const {
+  return CalculateQuantizedSpline( this->getKernelInput(input_), -1E20, 1E20, _splineHeader_, _knotCodes_.data(), this->getNbKnots() );
+}
+double QuantizedSpline::getKernelInput(const DialInputBuffer& input_) const {
+  double dialInput{input_.getInputBuffer()[0]};
+
+#ifndef NDEBUG
+  LogThrowIf(not std::isfinite(dialInput), "Invalid input for QuantizedSpline");
+#endif
+
+  if( not _allowExtrapolation_ ){
+    if     (dialInput <= _splineBounds_.min) { dialInput = _splineBounds_.min; }
+    else if(dialInput >= _splineBounds_.max){ dialInput = _splineBounds_.max; }
+  }
+
+  return dialInput;
+}
+
+std::string QuantizedSpline::getSummary() const {
+  std::stringstream ss;
+  ss << this->getDialTypeName() << ": decoded spline data = " << GenericToolbox::toString(this->getDecodedData());
+  ss << std::endl << this->getDialTypeName() << ": defined bounds = { " << _splineBounds_.min << ", " << _splineBounds_.max << " }";
+  ss << std::endl << this->getDialTypeName() << ": allow extrapolation ? " << _allowExtrapolation_;
+  return ss.str();
+}
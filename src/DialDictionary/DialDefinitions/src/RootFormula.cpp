@@ -4,8 +4,28 @@
 
 #include "RootFormula.h"
 
+#include "Logger.h"
+
+#include <map>
+#include <cmath>
+#include <cctype>
+#include <algorithm>
+
+#ifndef DISABLE_USER_HEADER
+LoggerInit([]{ Logger::setUserHeaderStr("[RootFormula]"); });
+#endif
+
+
+namespace {
+  // The dials built from the same expression share their program
+  std::mutex programCacheLock;
+  std::map<std::string, std::shared_ptr<const FormulaProgram>> programCache;
+}
+
 
 double RootFormula::evalResponse(const DialInputBuffer& input_) const {
+  if( _program_ != nullptr ){ return _program_->eval(input_.getInputBuffer().data(), _parameterList_.data()); }
+  std::lock_guard<std::mutex> lock(_formulaLock_);
   return _formula_.EvalPar(&input_.getInputBuffer()[0]);
 }
 
@@ -13,10 +33,81 @@ double RootFormula::evalResponse(const DialInputBuffer& input_) const {
 void RootFormula::setFormulaStr(const std::string& formulaStr_){
   _formula_ = TFormula(formulaStr_.c_str(), formulaStr_.c_str());
   LogThrowIf(not _formula_.IsValid(), "\"" << formulaStr_ << "\": could not be parsed as formula expression.");
+
+  _program_ = nullptr;
+  _formulaParIndexList_.clear();
+  _parameterList_.clear();
+
+  // only the first dial of an expression reports the problems
+  bool isNewProgram{false};
+  std::shared_ptr<const FormulaProgram> program;
+  {
+    std::lock_guard<std::mutex> lock(programCacheLock);
+    auto& cachedProgram = programCache[formulaStr_];
+    if( cachedProgram == nullptr ){
+      auto newProgram = std::make_shared<FormulaProgram>();
+      newProgram->compile( formulaStr_ );
+      cachedProgram = newProgram;
+      isNewProgram = true;
+    }
+    program = cachedProgram;
+  }
+  if( not program->isCompiled() ){
+    LogAlertIf(isNewProgram) << "\"" << formulaStr_ << "\": " << program->getError()
+               << ", using the (slower) TFormula evaluation." << std::endl;
+    return;
+  }
+
+  // match the program parameters with the TFormula ones
+  std::vector<int> parIndexList;
+  for( auto& parName : program->getParameterNameList() ){
+    bool isNumber{ std::all_of(parName.begin(), parName.end(), [](char c_){ return std::isdigit((unsigned char) c_); }) };
+    int iPar{ isNumber ? std::stoi(parName) : _formula_.GetParNumber(parName.c_str()) };
+    if( iPar < 0 or iPar >= _formula_.GetNpar() ){
+      LogAlertIf(isNewProgram) << "\"" << formulaStr_ << "\": parameter [" << parName << "] not found in the TFormula"
+                 << ", using the (slower) TFormula evaluation." << std::endl;
+      return;
+    }
+    parIndexList.emplace_back( iPar );
+  }
+
+  // check the program reproduces the TFormula on a few points
+  const int nVariables{ std::max(program->getNbVariables(), _formula_.GetNdim()) };
+  std::vector<double> xList(std::max(nVariables, 1));
+  std::vector<double> formulaParList(std::max(_formula_.GetNpar(), 1));
+  std::vector<double> programParList(parIndexList.size());
+  for( int iTrial = 0 ; iTrial < 3 ; iTrial++ ){
+    for( size_t iVar = 0 ; iVar < xList.size() ; iVar++ ){ xList[iVar] = (iVar%2 == 0 ? 1 : -1) * (0.37 + 0.61*double(iVar+iTrial)); }
+    for( size_t iPar = 0 ; iPar < formulaParList.size() ; iPar++ ){ formulaParList[iPar] = 0.83 + 0.29*double(iPar+2*iTrial); }
+    for( size_t iPar = 0 ; iPar < parIndexList.size() ; iPar++ ){ programParList[iPar] = formulaParList[parIndexList[iPar]]; }
+
+    double expected{ _formula_.EvalPar(xList.data(), formulaParList.data()) };
+    double result{ program->eval(xList.data(), programParList.data()) };
+    bool isSame{ (std::isnan(expected) and std::isnan(result)) or expected == result
+                 or std::fabs(result - expected) <= 1E-9 * std::max(1., std::fabs(expected)) };
+    if( not isSame ){
+      LogAlertIf(isNewProgram) << "\"" << formulaStr_ << "\": the compiled formula gives " << result << " instead of " << expected
+                 << ", using the (slower) TFormula evaluation." << std::endl;
+      return;
+    }
+  }
+
+  _program_ = program;
+  _formulaParIndexList_ = parIndexList;
+  _parameterList_.resize( parIndexList.size() );
+  for( size_t iPar = 0 ; iPar < parIndexList.size() ; iPar++ ){ _parameterList_[iPar] = _formula_.GetParameter(parIndexList[iPar]); }
+}
+
+void RootFormula::setParameter(const std::string& name_, double value_){
+  _formula_.SetParameter(name_.c_str(), value_);
+  for( size_t iPar = 0 ; iPar < _formulaParIndexList_.size() ; iPar++ ){
+    _parameterList_[iPar] = _formula_.GetParameter(_formulaParIndexList_[iPar]);
+  }
 }
 
 std::string RootFormula::getSummary() const {
   std::stringstream ss;
   ss << this->getDialTypeName() << ": formula: " << _formula_.GetExpFormula();
+  if( _program_ != nullptr ){ ss << " (compiled, " << _program_->getNbInstructions() << " instructions)"; }
   return ss.str();
 };
@@ -12,6 +12,10 @@ void Spline::setAllowExtrapolation(bool allowExtrapolation) {
   _allowExtrapolation_ = allowExtrapolation;
 }
 
+bool Spline::getAllowExtrapolation() const {
+  return _allowExtrapolation_;
+}
+
 void Spline::buildDial(const TSpline3& spline, const std::string& option_) {
   std::vector<double> xPoint(spline.GetNp());
   std::vector<double> yPoint(spline.GetNp());
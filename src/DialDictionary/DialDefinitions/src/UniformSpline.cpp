@@ -83,6 +83,9 @@ void UniformSpline::buildDial(const std::vector<double>& xPoints,
 }
 
 double UniformSpline::evalResponse(const DialInputBuffer& input_) const {
+  return CalculateUniformSpline( this->getKernelInput(input_), -1E20, 1E20, _splineData_.data(), this->getKernelDim() );
+}
+double UniformSpline::getKernelInput(const DialInputBuffer& input_) const {
   double dialInput{input_.getInputBuffer()[0]};
 
 #ifndef NDEBUG
@@ -94,5 +97,5 @@ double UniformSpline::evalResponse(const DialInputBuffer& input_) const {
     else if(dialInput >= _splineBounds_.max){ dialInput = _splineBounds_.max; }
   }
 
-  return CalculateUniformSpline( dialInput, -1E20, 1E20, _splineData_.data(), int(_splineData_.size()) );
+  return dialInput;
 }
@@ -9,6 +9,7 @@
 #include "DialInterface.h"
 #include "DialInputBuffer.h"
 #include "DialResponseSupervisor.h"
+#include "CalculateSegmentHint.h"
 #include "SampleSet.h"
 
 #include "GenericToolbox.Wrappers.h"
@@ -17,6 +18,8 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 
 class DialCollection : public JsonBaseClass {
 public:
@@ -137,12 +140,33 @@ public:
   // to doing the event reweighting.  An example of that would be the
   // Tabulated dials (which can be used in implement things like oscillation
   // weights).  Update callbacks are std::function<void(void)>, and can be
-  // added with addUpdate();
+  // added with addUpdate();  The callbacks are only called if the input
+  // buffers have changed since the last update (see isUpdateRequested()).
   void update();
 
+  // Run the update callbacks from the thread iThread_ of nThreads_ (-1 for
+  // a single thread).  This is called by every thread, and doesn't check if
+  // the update is requested: see isUpdateRequested() and flagUpdateDone().
+  void update(int iThread_, int nThreads_);
+
   // Add a dial collection update callback.  These are called in the order
-  // that they are added.  They are activated by the "update()" method.
+  // that they are added.  They are activated by the "update()" method.  The
+  // callbacks added with addUpdate() only run in a single thread, the
+  // parallel ones are called by every thread with (iThread_, nThreads_) and
+  // split the work themselves.
   void addUpdate(std::function<void(void)> callback);
+  void addParallelUpdate(std::function<void(int iThread_, int nThreads_)> callback);
+
+  // Check if the input buffers have changed since the last update.
+  [[nodiscard]] bool isUpdateRequested() const;
+
+  // Record the input buffers used by the last update.
+  void flagUpdateDone();
+
+  // Check if the collection relies on update callbacks.  The response of
+  // those dials depends on a state shared by the collection (e.g. a table),
+  // so they can only be evaluated for one parameter point at a time.
+  [[nodiscard]] bool hasUpdateCallbacks() const { return not _dialCollectionCallbacks_.empty(); }
 
   // Check if the dial will need to be recalculated.  A recalculation
   // happens when a parameter value has changed since the last calculation.
@@ -156,6 +180,13 @@ public:
   size_t getNextDialFreeSlot(){ return _dialFreeSlot_++; }
   size_t getDialFreeSlotIndex() const { return _dialFreeSlot_.getValue(); }
 
+  // Store the dial of an event (for event-by-event collections) and return
+  // its slot.  When the identical dials are shared, a dial with the same
+  // type and data as a dial already stored is deleted, and the slot of the
+  // stored dial is returned: the events then share the dial interface, and
+  // the response is only evaluated once.  Thread safe.
+  size_t storeEventDial(std::unique_ptr<DialBase> dialBase_);
+
   // Provide access to a the collection data.  The ownership is retained by
   // the collection.
   template <typename T>
@@ -166,6 +197,19 @@ public:
 
   std::vector<std::string>& getExtraLeafNames() {return _globalDialExtraLeafNames_;}
 
+  // Evaluate the responses of the dials whose inputs have changed.  The
+  // dials are grouped by concrete type, and each group is evaluated by a
+  // loop specialised for that type (no virtual call per dial).  The dials
+  // are split between the nThreads_ threads.
+  void updateDialResponses(int iThread_ = -1, int nThreads_ = 1);
+
+  // The responses computed by updateDialResponses(), one per interface.
+  std::vector<double> &getDialResponseList(){ return _dialResponseList_; }
+
+  // The knot search counters of the dials using a segment hint (summed over
+  // the threads).
+  [[nodiscard]] SegmentHint getSegmentHintTotal() const;
+
   void invalidateCachedInputBuffers(){ for( auto& inputBuffer : _dialInputBufferList_ ){ inputBuffer.invalidateBuffers(); }}
 
   void printConfiguration() const;
@@ -180,6 +224,20 @@ protected:
   bool initializeDialsWithTabulation(const JsonType& dialsDefinition);
 
   void readGlobals(const JsonType &config_);
+  void buildDialTypeGroups();
+
+  // Replace the dials which have a cheaper equivalent (within
+  // _simplifyDialsTolerance_): the dials flat at one are dropped, the
+  // constant and linear ones become Shift and LightGraph dials, the ROOT
+  // graphs and splines become LightGraph, UniformSpline or GeneralSpline
+  // dials.  Called once the event-by-event dials are loaded.
+  void simplifyDials();
+
+  // Replace the splines with uniformly spaced knots by QuantizedSpline
+  // dials, which store the knots as 16 bit numbers.  The dials whose
+  // response changes by more than _quantizeDialsTolerance_ are kept, and
+  // the largest response error is reported.  Called after simplifyDials().
+  void quantizeDials();
   JsonType fetchDialsDefinition(const JsonType &definitionsList_);
 
 private:
@@ -189,7 +247,13 @@ private:
   bool _useMirrorDial_{false};
   bool _enableDialsSummary_{false};
   bool _allowDialExtrapolation_{true};
+  bool _useSharedKnotBasis_{true};
+  bool _simplifyDials_{false};
+  bool _shareIdenticalDials_{true};
+  bool _quantizeDials_{false};
   int _index_{-1};
+  double _simplifyDialsTolerance_{1E-6};
+  double _quantizeDialsTolerance_{1E-4};
   double _minDialResponse_{std::nan("unset")};
   double _maxDialResponse_{std::nan("unset")};
   double _mirrorLowEdge_{std::nan("unset")};
@@ -228,15 +292,41 @@ private:
   // event, or one DialBase per bin (for binned dials), or a single DialBase.
   std::vector<DialBaseObject> _dialBaseList_{};
 
+  // The dials of the collection grouped by their concrete type.  The
+  // evaluation function is specialised for the type (see
+  // DialCollection.cpp), and the responses are stored by interface index.
+  typedef void (*DialResponsesEvalFct)(DialCollection& collection_, const size_t* begin_, const size_t* end_, SegmentHint& segmentHint_);
+  struct DialTypeGroup{
+    DialResponsesEvalFct evalFct{nullptr};
+    std::vector<size_t> dialIndexList{};
+    std::vector<SegmentHint> segmentHintList{}; // one per thread
+  };
+  std::vector<DialTypeGroup> _dialTypeGroupList_{};
+  std::vector<double> _dialResponseList_{};
+
+  template<typename T> static void evalDialResponses(DialCollection& collection_, const size_t* begin_, const size_t* end_, SegmentHint& segmentHint_);
+  template<typename T> static void evalSharedKnotResponses(DialCollection& collection_, const size_t* begin_, const size_t* end_, SegmentHint& segmentHint_);
+
   // A formula to decide if the dial should be applied to an event.
   std::shared_ptr<TFormula> _applyConditionFormula_{nullptr};
   GenericToolbox::Atomic<size_t> _dialFreeSlot_{0};
 
+  // The slots of the stored event-by-event dials by content hash (see
+  // storeEventDial), and the number of event dials given to the collection.
+  // Only needed while the dials are loaded.
+  GenericToolbox::NoCopyWrapper<std::mutex> _dialContentLock_{};
+  std::unordered_multimap<size_t, size_t> _dialContentSlotMap_{};
+  GenericToolbox::Atomic<size_t> _nEventDials_{0};
+
   // A pointer to dial specific data
   std::vector<std::shared_ptr<DialCollection::CollectionData>>  _dialCollectionData_;
 
   // The callbacks for this dial collection
-  std::vector<std::function<void(void)>> _dialCollectionCallbacks_;
+  std::vector<std::function<void(int, int)>> _dialCollectionCallbacks_;
+
+  // The version of each input buffer at the last update (see
+  // DialInputBuffer::getVersion()).
+  std::vector<uint64_t> _updateInputVersionList_{};
 
   // external refs
   std::vector<ParameterSet>* _parameterSetListPtr_{nullptr};
@@ -8,7 +8,9 @@
 #include "ParameterSet.h"
 
 #include <vector>
+#include <atomic>
 #include <utility>
+#include <cstdint>
 
 
 class DialInputBuffer {
@@ -27,6 +29,9 @@ public:
     int parIndex{-1};
     int bufferIndex{-1};
 
+    // index in the flattened parameter value list (see update(valueList_, changedList_))
+    int valueIndex{-1};
+
     // it costs less memory to have only one vector with two potentially useless double (2*8bytes)
     // than an empty vector (24 bytes)
     struct MirrorEdges{
@@ -59,11 +64,18 @@ public:
   [[nodiscard]] const std::vector<double>& getInputBuffer() const { return _inputBuffer_; }
   [[nodiscard]] const std::vector<ParameterReference> &getInputParameterIndicesList() const{ return _inputParameterReferenceList_; }
 
+  /// A number identifying the values of the buffer.  It changes each time
+  /// the values change, and two buffers only share it if one is a copy of
+  /// the other (with the same values).  It is never zero.  Used by
+  /// CachedDial to check its cache without looking at the values.
+  [[nodiscard]] uint64_t getVersion() const{ return _version_; }
+
   // mutable getters
 
   /// Function that allow to tweak the buffer from the inside. Used for
-  /// individual spline evaluation.
-  std::vector<double>& getInputBuffer(){ return _inputBuffer_; }
+  /// individual spline evaluation.  The buffer is considered as changed:
+  /// write the values before evaluating the dials, not after.
+  std::vector<double>& getInputBuffer(){ _version_ = makeVersion(); return _inputBuffer_; }
   std::vector<ParameterReference> &getInputParameterIndicesList(){ return _inputParameterReferenceList_; }
 
   // core
@@ -76,6 +88,12 @@ public:
   /// mirroring to the parameter values.
   void update();
 
+  /// Same as update(), but the parameter values are read from a contiguous
+  /// list: the parameters of all the sets, concatenated in order (see
+  /// ParameterReference::valueIndex).  If none of the input parameters is
+  /// flagged in changedList_, the buffer is left untouched.
+  void update(const double* valueList_, const char* changedList_);
+
   // nested getters
   [[nodiscard]] const ParameterSet& getParameterSet(int iInput_) const{ return _inputParameterReferenceList_[iInput_].getParameterSet(_parSetListPtr_); }
   [[nodiscard]] const Parameter& getParameter(int iInput_) const { return _inputParameterReferenceList_[iInput_].getParameter(_parSetListPtr_); }
@@ -94,6 +112,16 @@ public:
   [[deprecated("use getParameterSet()")]] [[nodiscard]] const ParameterSet& getFitParameterSet(int i=0) const { return getParameterSet(i); }
 
 private:
+  /// Apply the mirroring to the value, and store it in the buffer.
+  void setInput(const ParameterReference& inputRef_, double value_);
+
+  /// A new version number, unique among all the buffers.
+  static uint64_t makeVersion(){ return ++_versionSource_; }
+  static std::atomic<uint64_t> _versionSource_;
+
+  /// The version of the buffer values (see getVersion()).
+  uint64_t _version_{makeVersion()};
+
   /// Flag if the member can be still edited.
   bool _isInitialized_{false};
 
@@ -101,6 +129,10 @@ private:
   /// be recalculated if the parameter values have not changed.
   bool _isDialUpdateRequested_{true};
 
+  /// Flag if the buffer holds the values of the last contiguous value list.
+  /// Otherwise, the next update from the value list can't be skipped.
+  bool _isValueListSynced_{false};
+
   /// How many inputs are handled
   int _inputArraySize_{0};
 
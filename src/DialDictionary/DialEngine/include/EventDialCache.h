@@ -18,6 +18,7 @@
 
 #include <vector>
 #include <utility>
+#include <functional>
 
 
 class EventDialCache{
@@ -49,6 +50,9 @@ public:
     double response{std::nan("unset")};
     // A cached boolean to check if the dial needs to be updated.
     bool *updateRequested{nullptr};
+    // The response evaluated by the dial collection (see
+    // DialCollection::updateDialResponses), if any.
+    const double *collectionResponse{nullptr};
     void update(){
       // Reevaluate the dial if an update has been requested
 #ifdef EVENT_DIAL_CACHE_SAFE_SLOW_INTERFACE
@@ -56,7 +60,8 @@ public:
 #else
       if( *(this->updateRequested) ) {
 #endif
-        response = dialInterface->evalResponse();
+        if( collectionResponse != nullptr ){ response = *collectionResponse; }
+        else{ response = dialInterface->evalResponse(); }
       }
     }
     double getResponse(){
@@ -71,6 +76,15 @@ public:
     Event* event;
     std::vector<DialResponseCache> dialResponseCacheList{};
 
+    // The dials which don't need to be evaluated anymore (see freezeDials),
+    // and the product of their responses.
+    double frozenReweight{1};
+    std::vector<DialResponseCache> frozenDialResponseCacheList{};
+
+    // The dials applied on the histogram bin of the event instead (see
+    // Propagator::hoistBinConstantDials).
+    std::vector<DialResponseCache> hoistedDialResponseCacheList{};
+
     [[nodiscard]] std::string getSummary() const {
       std::stringstream ss;
       ss << *event << std::endl;
@@ -166,6 +180,10 @@ public:
 
   GlobalEventReweightCap& getGlobalEventReweightCap(){ return _globalEventReweightCap_; }
 
+  /// Merge the events of a sample which are in the same histogram bin and
+  /// use the same dial interfaces (see compressEvents).
+  bool& getEventCompression(){ return _isEventCompressionEnabled_; }
+
   /// Allocate entries for events in the indexed cache.  The first parameter
   /// arethe number of events to allocate space for, and the second number is
   /// the total number of dials that might exist for each event.
@@ -191,8 +209,26 @@ public:
 
   void reweightEntry( CacheEntry& entry_);
 
+  /// Move the dials for which isFrozen_ is true out of the dial lists of the
+  /// events.  Their current response is multiplied into the frozen reweight
+  /// of the cache entries, so they are not evaluated anymore while
+  /// reweighting.  The caller is responsible for the input buffers being up
+  /// to date.  Returns the number of dials that have been frozen.
+  size_t freezeDials( const std::function<bool(const DialInterface&)>& isFrozen_ );
+
+  /// Put back all the frozen dials in the dial lists of the events.
+  void unfreezeDials();
+
 
 private:
+  /// Events that land in the same histogram bin and use exactly the same
+  /// dial interfaces get the same reweight factor: they are merged into one
+  /// event with the summed base weight.  The sum of the squared weights is
+  /// kept with Weights::sqScale.  Event-by-event dials have one interface
+  /// per event, so such events are never merged.  Called while building
+  /// the reference cache, once the events are sorted.
+  void compressEvents(SampleSet& sampleSet_, std::vector<std::vector<IndexedCacheEntry>>& sampleIndexCacheList_);
+
   // The next available entry in the indexed cache.
   size_t _fillIndex_{0};
 
@@ -209,6 +245,8 @@ private:
 
   /// Global cap
   GlobalEventReweightCap _globalEventReweightCap_{};
+
+  bool _isEventCompressionEnabled_{false};
 };
 
 
@@ -7,11 +7,34 @@
 #include "DialBaseFactory.h"
 #include "TabulatedDialFactory.h"
 #include "RootFormula.h"
-
-
+#include "Norm.h"
+#include "Shift.h"
+#include "Tabulated.h"
+#include "Polynomial.h"
+#include "CompiledLibDial.h"
+#include "Graph.h"
+#include "LightGraph.h"
+#include "Spline.h"
+#include "SimpleSpline.h"
+#include "GeneralSpline.h"
+#include "CompactSpline.h"
+#include "UniformSpline.h"
+#include "MonotonicSpline.h"
+#include "QuantizedSpline.h"
+#include "Bilinear.h"
+#include "Bicubic.h"
+#include "CalculateSplineBatch.h"
+#include "CalculateSplineBasis.h"
+
+#include "GenericToolbox.Thread.h"
 #include "Logger.h"
 
 #include <sstream>
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <typeindex>
+#include <unordered_map>
 
 #ifndef DISABLE_USER_HEADER
 LoggerInit([]{ Logger::setUserHeaderStr("[DialCollection]"); });
@@ -136,7 +159,12 @@ void DialCollection::clear(){
   _dialInterfaceList_.clear();
   _dialInterfaceList_.shrink_to_fit();
 
+  _dialTypeGroupList_.clear();
+  _dialResponseList_.clear();
+
   _dialFreeSlot_.setValue(0);
+  _dialContentSlotMap_.clear();
+  _nEventDials_.setValue(0);
 }
 
 void DialCollection::resizeContainers(){
@@ -149,9 +177,52 @@ void DialCollection::resizeContainers(){
   _dialInterfaceList_.resize(_dialFreeSlot_.getValue());
   _dialInterfaceList_.shrink_to_fit();
 
+  if( _nEventDials_.getValue() != 0 ){
+    LogInfo << "\"" << this->getTitle() << "\": " << _dialFreeSlot_.getValue()
+            << " unique dials for " << _nEventDials_.getValue() << " event dials." << std::endl;
+  }
+  std::unordered_multimap<size_t, size_t>().swap(_dialContentSlotMap_);
+
+  // all the dials are loaded
+  if( _simplifyDials_ ){ this->simplifyDials(); }
+  if( _quantizeDials_ ){ this->quantizeDials(); }
+
   this->setupDialInterfaceReferences();
 }
 
+void DialCollection::updateDialResponses(int iThread_, int nThreads_){
+  // a single input buffer: nothing to do if it hasn't changed
+  if( _dialInputBufferList_.size() == 1 and not _dialInputBufferList_[0].isDialUpdateRequested() ){ return; }
+
+  for( auto& dialTypeGroup : _dialTypeGroupList_ ){
+    auto bounds = GenericToolbox::ParallelWorker::getThreadBoundIndices(
+        iThread_, nThreads_, int(dialTypeGroup.dialIndexList.size())
+    );
+    if( bounds.beginIndex >= bounds.endIndex ){ continue; }
+
+    // each thread keeps its own segment hint, no need to synchronise
+    SegmentHint threadSegmentHint{};
+    const size_t iHint{size_t( std::max(iThread_, 0) )};
+    dialTypeGroup.evalFct(
+        *this,
+        dialTypeGroup.dialIndexList.data() + bounds.beginIndex,
+        dialTypeGroup.dialIndexList.data() + bounds.endIndex,
+        iHint < dialTypeGroup.segmentHintList.size() ? dialTypeGroup.segmentHintList[iHint] : threadSegmentHint
+    );
+  }
+}
+
+SegmentHint DialCollection::getSegmentHintTotal() const{
+  SegmentHint out{};
+  for( auto& dialTypeGroup : _dialTypeGroupList_ ){
+    for( auto& segmentHint : dialTypeGroup.segmentHintList ){
+      out.nHits += segmentHint.nHits;
+      out.nCalls += segmentHint.nCalls;
+    }
+  }
+  return out;
+}
+
 void DialCollection::updateInputBuffers(){
   std::for_each(_dialInputBufferList_.begin(), _dialInputBufferList_.end(), [](DialInputBuffer& i_){
     i_.update();
@@ -257,6 +328,711 @@ void DialCollection::setupDialInterfaceReferences(){
       );
     }
   }
+
+  this->buildDialTypeGroups();
+}
+
+namespace {
+  // Evaluate a dial knowing its concrete type: the qualified call bypasses
+  // the virtual table.  The types which aren't listed in
+  // buildDialTypeGroups() use the virtual call.
+  template<typename T> struct DialEvaluator{
+    static double eval(const DialBase* dialBase_, const DialInputBuffer& input_){
+      return static_cast<const T*>(dialBase_)->T::evalResponse(input_);
+    }
+  };
+  template<> struct DialEvaluator<DialBase>{
+    static double eval(const DialBase* dialBase_, const DialInputBuffer& input_){
+      return dialBase_->evalResponse(input_);
+    }
+  };
+
+  //! This replaces DialInterface::evalResponse() in the reweight loop, the
+  //! result must be exactly the same.
+  template<typename T> void evalDialRange(
+      const DialInterface* interfaceList_, double* responseList_,
+      const size_t* begin_, const size_t* end_, SegmentHint& /* segmentHint_ */){
+    for( auto* dialIndexPtr = begin_ ; dialIndexPtr != end_ ; ++dialIndexPtr ){
+      auto& dialInterface = interfaceList_[*dialIndexPtr];
+      const DialInputBuffer& inputBuffer = *dialInterface.getInputBufferRef();
+      if( not inputBuffer.isDialUpdateRequested() ){ continue; }
+      responseList_[*dialIndexPtr] = dialInterface.getResponseSupervisorRef()->process(
+          DialEvaluator<T>::eval( dialInterface.getDialBaseRef(), inputBuffer )
+      );
+    }
+  }
+
+  // The splines go through the batch kernels, by chunks.  The kernel
+  // arguments are the ones of T::evalResponse().
+  template<typename T> void evalSplineDialRange(
+      const DialInterface* interfaceList_, double* responseList_,
+      const size_t* begin_, const size_t* end_, SplineBatch::BatchFct batchFct_){
+    constexpr int chunkSize{64};
+    double x[chunkSize]; double lowerBound[chunkSize]; double upperBound[chunkSize];
+    const double* data[chunkSize]; int dim[chunkSize]; double result[chunkSize];
+    size_t dialIndex[chunkSize];
+    std::fill(lowerBound, lowerBound + chunkSize, -1E20);
+    std::fill(upperBound, upperBound + chunkSize, 1E20);
+
+    SplineBatch::Batch batch;
+    batch.x = x; batch.lowerBound = lowerBound; batch.upperBound = upperBound;
+    batch.data = data; batch.dim = dim; batch.result = result;
+
+    auto flush = [&]{
+      batchFct_( batch );
+      for( int iEntry = 0 ; iEntry < batch.size ; iEntry++ ){
+        responseList_[dialIndex[iEntry]] = interfaceList_[dialIndex[iEntry]].getResponseSupervisorRef()->process( result[iEntry] );
+      }
+      batch.size = 0;
+    };
+
+    for( auto* dialIndexPtr = begin_ ; dialIndexPtr != end_ ; ++dialIndexPtr ){
+      auto& dialInterface = interfaceList_[*dialIndexPtr];
+      const DialInputBuffer& inputBuffer = *dialInterface.getInputBufferRef();
+      if( not inputBuffer.isDialUpdateRequested() ){ continue; }
+
+      auto* dial = static_cast<const T*>( dialInterface.getDialBaseRef() );
+      x[batch.size] = dial->getKernelInput( inputBuffer );
+      data[batch.size] = dial->T::getDialData().data();
+      dim[batch.size] = dial->getKernelDim();
+      dialIndex[batch.size] = *dialIndexPtr;
+      if( ++batch.size == chunkSize ){ flush(); }
+    }
+    if( batch.size != 0 ){ flush(); }
+  }
+
+  template<> void evalDialRange<CompactSpline>(const DialInterface* i_, double* r_, const size_t* b_, const size_t* e_, SegmentHint&){
+    evalSplineDialRange<CompactSpline>(i_, r_, b_, e_, &SplineBatch::evalCompactSpline);
+  }
+  template<> void evalDialRange<UniformSpline>(const DialInterface* i_, double* r_, const size_t* b_, const size_t* e_, SegmentHint&){
+    evalSplineDialRange<UniformSpline>(i_, r_, b_, e_, &SplineBatch::evalUniformSpline);
+  }
+  template<> void evalDialRange<MonotonicSpline>(const DialInterface* i_, double* r_, const size_t* b_, const size_t* e_, SegmentHint&){
+    evalSplineDialRange<MonotonicSpline>(i_, r_, b_, e_, &SplineBatch::evalMonotonicSpline);
+  }
+
+  // The knot search of the general splines and of the light graphs starts
+  // from the segment of the previous evaluation (see CalculateSegmentHint.h).
+  // The hint is kept by each thread, for the whole collection.
+  template<typename T> void evalHintedDialRange(
+      const DialInterface* interfaceList_, double* responseList_,
+      const size_t* begin_, const size_t* end_, SegmentHint& segmentHint_){
+    SegmentHint segmentHint{segmentHint_};
+    for( auto* dialIndexPtr = begin_ ; dialIndexPtr != end_ ; ++dialIndexPtr ){
+      auto& dialInterface = interfaceList_[*dialIndexPtr];
+      const DialInputBuffer& inputBuffer = *dialInterface.getInputBufferRef();
+      if( not inputBuffer.isDialUpdateRequested() ){ continue; }
+      responseList_[*dialIndexPtr] = dialInterface.getResponseSupervisorRef()->process(
+          static_cast<const T*>( dialInterface.getDialBaseRef() )->evalResponse( inputBuffer, segmentHint )
+      );
+    }
+    segmentHint_ = segmentHint;
+  }
+
+  template<> void evalDialRange<GeneralSpline>(const DialInterface* i_, double* r_, const size_t* b_, const size_t* e_, SegmentHint& h_){
+    evalHintedDialRange<GeneralSpline>(i_, r_, b_, e_, h_);
+  }
+  template<> void evalDialRange<LightGraph>(const DialInterface* i_, double* r_, const size_t* b_, const size_t* e_, SegmentHint& h_){
+    evalHintedDialRange<LightGraph>(i_, r_, b_, e_, h_);
+  }
+
+  // The compiled formulas are evaluated by chunks of dials sharing the same
+  // program (e.g. all the bins of a binned formula), see FormulaProgram.
+  template<> void evalDialRange<RootFormula>(
+      const DialInterface* interfaceList_, double* responseList_,
+      const size_t* begin_, const size_t* end_, SegmentHint& /* segmentHint_ */){
+    constexpr int chunkSize{64};
+    const double* x[chunkSize]; const double* par[chunkSize]; double result[chunkSize];
+    size_t dialIndex[chunkSize];
+    const FormulaProgram* program{nullptr};
+    int size{0};
+
+    auto flush = [&]{
+      program->evalBatch( size, x, par, result );
+      for( int iEntry = 0 ; iEntry < size ; iEntry++ ){
+        responseList_[dialIndex[iEntry]] = interfaceList_[dialIndex[iEntry]].getResponseSupervisorRef()->process( result[iEntry] );
+      }
+      size = 0;
+    };
+
+    for( auto* dialIndexPtr = begin_ ; dialIndexPtr != end_ ; ++dialIndexPtr ){
+      auto& dialInterface = interfaceList_[*dialIndexPtr];
+      const DialInputBuffer& inputBuffer = *dialInterface.getInputBufferRef();
+      if( not inputBuffer.isDialUpdateRequested() ){ continue; }
+
+      auto* dial = static_cast<const RootFormula*>( dialInterface.getDialBaseRef() );
+      if( dial->getProgram() == nullptr ){
+        responseList_[*dialIndexPtr] = dialInterface.getResponseSupervisorRef()->process( dial->RootFormula::evalResponse( inputBuffer ) );
+        continue;
+      }
+      if( size != 0 and dial->getProgram() != program ){ flush(); }
+      program = dial->getProgram();
+      x[size] = inputBuffer.getInputBuffer().data();
+      par[size] = dial->getParameterData();
+      dialIndex[size] = *dialIndexPtr;
+      if( ++size == chunkSize ){ flush(); }
+    }
+    if( size != 0 ){ flush(); }
+  }
+
+  // The splines which have a basis (see CalculateSplineBasis.h)
+  template<typename T> struct SplineBasisFcts;
+  template<> struct SplineBasisFcts<CompactSpline>{
+    static void fillBasis(double x_, const double* data_, int dim_, SplineBasis& basis_){ CalculateCompactSplineBasis(x_, data_, dim_, basis_); }
+    static void getGrid(const double* data_, int dim_, std::vector<double>& grid_){ GetCompactSplineGrid(data_, dim_, grid_); }
+  };
+  template<> struct SplineBasisFcts<UniformSpline>{
+    static void fillBasis(double x_, const double* data_, int dim_, SplineBasis& basis_){ CalculateUniformSplineBasis(x_, data_, dim_, basis_); }
+    static void getGrid(const double* data_, int dim_, std::vector<double>& grid_){ GetUniformSplineGrid(data_, dim_, grid_); }
+  };
+  template<> struct SplineBasisFcts<GeneralSpline>{
+    static void fillBasis(double x_, const double* data_, int dim_, SplineBasis& basis_){ CalculateGeneralSplineBasis(x_, data_, dim_, basis_); }
+    static void getGrid(const double* data_, int dim_, std::vector<double>& grid_){ GetGeneralSplineGrid(data_, dim_, grid_); }
+  };
+
+  // Two dials can share their basis if they have the same key: the knot
+  // grid and the clamping of the input.  Returns false if the dial can't
+  // share its basis.
+  template<typename T> bool getSharedKnotKey(const DialBase* dialBase_, std::vector<double>& key_){
+    auto* dial = static_cast<const T*>( dialBase_ );
+    SplineBasisFcts<T>::getGrid( dial->T::getDialData().data(), dial->getKernelDim(), key_ );
+    key_.emplace_back( dial->getAllowExtrapolation() ? 1 : 0 );
+    if( not dial->getAllowExtrapolation() ){
+      key_.emplace_back( dial->getSplineBounds().min );
+      key_.emplace_back( dial->getSplineBounds().max );
+    }
+    return std::none_of( key_.begin(), key_.end(), [](double v_){ return std::isnan(v_); } );
+  }
+
+  // All the dials of the range have the same key and the same input buffer,
+  // so the basis of the first one is used for all of them.
+  template<typename T> void evalSharedKnotRange(
+      const DialInterface* interfaceList_, double* responseList_,
+      const size_t* begin_, const size_t* end_, SegmentHint& /* segmentHint_ */){
+    const DialInputBuffer& inputBuffer = *interfaceList_[*begin_].getInputBufferRef();
+    if( not inputBuffer.isDialUpdateRequested() ){ return; }
+
+    SplineBasis basis;
+    auto* firstDial = static_cast<const T*>( interfaceList_[*begin_].getDialBaseRef() );
+    SplineBasisFcts<T>::fillBasis(
+        firstDial->getKernelInput( inputBuffer ), firstDial->T::getDialData().data(), firstDial->getKernelDim(), basis
+    );
+
+    for( auto* dialIndexPtr = begin_ ; dialIndexPtr != end_ ; ++dialIndexPtr ){
+      auto& dialInterface = interfaceList_[*dialIndexPtr];
+      auto* dial = static_cast<const T*>( dialInterface.getDialBaseRef() );
+      responseList_[*dialIndexPtr] = dialInterface.getResponseSupervisorRef()->process(
+          CalculateSplineFromBasis( basis, -1E20, 1E20, dial->T::getDialData().data() )
+      );
+    }
+  }
+}
+
+template<typename T> void DialCollection::evalDialResponses(DialCollection& collection_, const size_t* begin_, const size_t* end_, SegmentHint& segmentHint_){
+  evalDialRange<T>( collection_._dialInterfaceList_.data(), collection_._dialResponseList_.data(), begin_, end_, segmentHint_ );
+}
+template<typename T> void DialCollection::evalSharedKnotResponses(DialCollection& collection_, const size_t* begin_, const size_t* end_, SegmentHint& segmentHint_){
+  evalSharedKnotRange<T>( collection_._dialInterfaceList_.data(), collection_._dialResponseList_.data(), begin_, end_, segmentHint_ );
+}
+
+void DialCollection::buildDialTypeGroups(){
+  static const std::unordered_map<std::type_index, DialResponsesEvalFct> evalFctMap{
+      {typeid(Norm),                 &DialCollection::evalDialResponses<Norm>},
+      {typeid(Shift),                &DialCollection::evalDialResponses<Shift>},
+      {typeid(Tabulated),            &DialCollection::evalDialResponses<Tabulated>},
+      {typeid(Polynomial),           &DialCollection::evalDialResponses<Polynomial>},
+      {typeid(RootFormula),          &DialCollection::evalDialResponses<RootFormula>},
+      {typeid(CompiledLibDial),      &DialCollection::evalDialResponses<CompiledLibDial>},
+      {typeid(Graph),                &DialCollection::evalDialResponses<Graph>},
+      {typeid(GraphCache),           &DialCollection::evalDialResponses<GraphCache>},
+      {typeid(LightGraph),           &DialCollection::evalDialResponses<LightGraph>},
+      {typeid(LightGraphCache),      &DialCollection::evalDialResponses<LightGraphCache>},
+      {typeid(Spline),               &DialCollection::evalDialResponses<Spline>},
+      {typeid(SplineCache),          &DialCollection::evalDialResponses<SplineCache>},
+      {typeid(SimpleSpline),         &DialCollection::evalDialResponses<SimpleSpline>},
+      {typeid(SimpleSplineCache),    &DialCollection::evalDialResponses<SimpleSplineCache>},
+      {typeid(GeneralSpline),        &DialCollection::evalDialResponses<GeneralSpline>},
+      {typeid(GeneralSplineCache),   &DialCollection::evalDialResponses<GeneralSplineCache>},
+      {typeid(CompactSpline),        &DialCollection::evalDialResponses<CompactSpline>},
+      {typeid(CompactSplineCache),   &DialCollection::evalDialResponses<CompactSplineCache>},
+      {typeid(UniformSpline),        &DialCollection::evalDialResponses<UniformSpline>},
+      {typeid(UniformSplineCache),   &DialCollection::evalDialResponses<UniformSplineCache>},
+      {typeid(MonotonicSpline),      &DialCollection::evalDialResponses<MonotonicSpline>},
+      {typeid(MonotonicSplineCache), &DialCollection::evalDialResponses<MonotonicSplineCache>},
+      {typeid(QuantizedSpline),      &DialCollection::evalDialResponses<QuantizedSpline>},
+      {typeid(Bilinear),             &DialCollection::evalDialResponses<Bilinear>},
+      {typeid(BilinearCache),        &DialCollection::evalDialResponses<BilinearCache>},
+      {typeid(Bicubic),              &DialCollection::evalDialResponses<Bicubic>},
+      {typeid(BicubicCache),         &DialCollection::evalDialResponses<BicubicCache>},
+  };
+
+  _dialTypeGroupList_.clear();
+  _dialResponseList_.assign( _dialInterfaceList_.size(), std::nan("unset") );
+
+  // one segment hint per thread (see updateDialResponses)
+  const size_t nSegmentHints{size_t( std::max(1, GundamGlobals::getNbCpuThreads()) )};
+
+  std::unordered_map<std::type_index, size_t> groupIndexMap{};
+  for( size_t iDial = 0 ; iDial < _dialInterfaceList_.size() ; iDial++ ){
+    auto* dialBasePtr = _dialInterfaceList_[iDial].getDialBaseRef();
+    if( dialBasePtr == nullptr ){ continue; }
+
+    std::type_index dialType{typeid(*dialBasePtr)};
+    auto groupIndex = groupIndexMap.find( dialType );
+    if( groupIndex == groupIndexMap.end() ){
+      groupIndex = groupIndexMap.emplace( dialType, _dialTypeGroupList_.size() ).first;
+      _dialTypeGroupList_.emplace_back();
+      _dialTypeGroupList_.back().segmentHintList.resize( nSegmentHints );
+
+      auto evalFct = evalFctMap.find( dialType );
+      if( evalFct != evalFctMap.end() ){ _dialTypeGroupList_.back().evalFct = evalFct->second; }
+      else{ _dialTypeGroupList_.back().evalFct = &DialCollection::evalDialResponses<DialBase>; }
+    }
+    _dialTypeGroupList_[groupIndex->second].dialIndexList.emplace_back( iDial );
+  }
+
+  // The splines sharing their knot grid are evaluated with a common basis,
+  // computed once per update: the response of each dial is then a short
+  // dot product with its knot values (see CalculateSplineBasis.h).  This
+  // needs all the dials to see the same input.  The dials whose grid isn't
+  // shared stay in the group of their type.
+  if( not _useSharedKnotBasis_ or _dialInputBufferList_.size() != 1 ){ return; }
+
+  typedef bool (*SharedKnotKeyFct)(const DialBase* dialBase_, std::vector<double>& key_);
+  struct SharedKnotDef{
+    SharedKnotKeyFct getKeyFct{nullptr};
+    DialResponsesEvalFct evalFct{nullptr};
+  };
+  static const std::unordered_map<std::type_index, SharedKnotDef> sharedKnotDefMap{
+      {typeid(CompactSpline), {&getSharedKnotKey<CompactSpline>, &DialCollection::evalSharedKnotResponses<CompactSpline>}},
+      {typeid(UniformSpline), {&getSharedKnotKey<UniformSpline>, &DialCollection::evalSharedKnotResponses<UniformSpline>}},
+      {typeid(GeneralSpline), {&getSharedKnotKey<GeneralSpline>, &DialCollection::evalSharedKnotResponses<GeneralSpline>}},
+  };
+  constexpr size_t minSharedKnotDials{16}; // not worth a group below
+
+  for( auto& groupIndex : groupIndexMap ){
+    auto sharedKnotDef = sharedKnotDefMap.find( groupIndex.first );
+    if( sharedKnotDef == sharedKnotDefMap.end() ){ continue; }
+
+    std::map<std::vector<double>, std::vector<size_t>> knotGridMap{};
+    std::vector<size_t> otherDialIndexList{};
+    std::vector<double> key{};
+    for( auto iDial : _dialTypeGroupList_[groupIndex.second].dialIndexList ){
+      if( sharedKnotDef->second.getKeyFct( _dialInterfaceList_[iDial].getDialBaseRef(), key ) ){
+        knotGridMap[key].emplace_back( iDial );
+      }
+      else{ otherDialIndexList.emplace_back( iDial ); }
+    }
+
+    for( auto& knotGrid : knotGridMap ){
+      if( knotGrid.second.size() < minSharedKnotDials ){
+        otherDialIndexList.insert( otherDialIndexList.end(), knotGrid.second.begin(), knotGrid.second.end() );
+        continue;
+      }
+      LogDebugIf(GundamGlobals::isDebug()) << "\"" << this->getTitle() << "\": " << knotGrid.second.size()
+                                           << " dials share the same knot grid." << std::endl;
+      _dialTypeGroupList_.emplace_back();
+      _dialTypeGroupList_.back().segmentHintList.resize( nSegmentHints );
+      _dialTypeGroupList_.back().evalFct = sharedKnotDef->second.evalFct;
+      _dialTypeGroupList_.back().dialIndexList = std::move( knotGrid.second );
+    }
+
+    std::sort( otherDialIndexList.begin(), otherDialIndexList.end() );
+    _dialTypeGroupList_[groupIndex.second].dialIndexList = std::move( otherDialIndexList );
+  }
+}
+
+namespace {
+  // The knots of the 1D dials handled by DialCollection::simplifyDials().
+  // The slopes are only filled by the types which store them.  Returns false
+  // for the other types (the cached versions included).
+  bool getDialKnots(const DialBase* dialBase_, std::vector<double>& xList_,
+                    std::vector<double>& yList_, std::vector<double>& slopeList_){
+    xList_.clear(); yList_.clear(); slopeList_.clear();
+
+    // getDialData() isn't implemented by the ROOT based types
+    const std::type_index dialType{typeid(*dialBase_)};
+    if( dialType == typeid(Graph) ){
+      auto& graph = static_cast<const Graph*>(dialBase_)->getGraph();
+      xList_.assign( graph.GetX(), graph.GetX() + graph.GetN() );
+      yList_.assign( graph.GetY(), graph.GetY() + graph.GetN() );
+    }
+    else if( dialType == typeid(Spline) ){
+      auto& spline = static_cast<const Spline*>(dialBase_)->getSpline();
+      for( int iKnot = 0 ; iKnot < spline.GetNp() ; iKnot++ ){
+        double x, y;
+        spline.GetKnot(iKnot, x, y);
+        xList_.emplace_back( x );
+        yList_.emplace_back( y );
+        slopeList_.emplace_back( spline.Derivative(x) );
+      }
+    }
+    else if( dialType == typeid(LightGraph) ){
+      auto& data = dialBase_->getDialData();
+      // {y0,x0,y1,x1,...}
+      for( size_t iKnot = 0 ; 2*iKnot+1 < data.size() ; iKnot++ ){
+        yList_.emplace_back( data[2*iKnot] );
+        xList_.emplace_back( data[2*iKnot+1] );
+      }
+    }
+    else if( dialType == typeid(CompactSpline) or dialType == typeid(MonotonicSpline) ){
+      auto& data = dialBase_->getDialData();
+      // {x0,step,y0,y1,...}
+      for( size_t iKnot = 0 ; 2+iKnot < data.size() ; iKnot++ ){
+        xList_.emplace_back( data[0] + double(iKnot)*data[1] );
+        yList_.emplace_back( data[2+iKnot] );
+      }
+    }
+    else if( dialType == typeid(UniformSpline) ){
+      auto& data = dialBase_->getDialData();
+      // {x0,step,y0,dy0,y1,dy1,...}
+      for( size_t iKnot = 0 ; 2+2*iKnot+1 < data.size() ; iKnot++ ){
+        xList_.emplace_back( data[0] + double(iKnot)*data[1] );
+        yList_.emplace_back( data[2+2*iKnot] );
+        slopeList_.emplace_back( data[2+2*iKnot+1] );
+      }
+    }
+    else if( dialType == typeid(GeneralSpline) ){
+      auto& data = dialBase_->getDialData();
+      // {x0,step,y0,dy0,x0,y1,dy1,x1,...}
+      for( size_t iKnot = 0 ; 2+3*iKnot+2 < data.size() ; iKnot++ ){
+        yList_.emplace_back( data[2+3*iKnot] );
+        slopeList_.emplace_back( data[2+3*iKnot+1] );
+        xList_.emplace_back( data[2+3*iKnot+2] );
+      }
+    }
+    else{ return false; }
+
+    return not xList_.empty();
+  }
+
+  // Compare a dial with a replacement candidate.  Between two knots, the
+  // response of all the handled types is a polynomial of degree three at
+  // most: the knots and two points in between are enough to tell if two
+  // dials are the same (more points are used to measure the largest
+  // difference).  The extrapolation is also a polynomial, so three more
+  // points are checked on each side when it is allowed.
+  struct DialProbe{
+    DialInputBuffer input{};
+    std::vector<double> inputList{};
+
+    DialProbe(){ input.getInputBuffer().resize(1); }
+
+    void setKnots(const std::vector<double>& xList_, bool allowExtrapolation_, int nStepsPerSegment_=3){
+      inputList.clear();
+      for( size_t iKnot = 0 ; iKnot < xList_.size() ; iKnot++ ){
+        inputList.emplace_back( xList_[iKnot] );
+        if( iKnot+1 == xList_.size() ){ break; }
+        const double step{xList_[iKnot+1] - xList_[iKnot]};
+        for( int iStep = 1 ; iStep < nStepsPerSegment_ ; iStep++ ){
+          inputList.emplace_back( xList_[iKnot] + double(iStep)*step/double(nStepsPerSegment_) );
+        }
+      }
+      if( allowExtrapolation_ and xList_.size() > 1 ){
+        const double firstStep{xList_[1] - xList_[0]};
+        const double lastStep{xList_.back() - xList_[xList_.size()-2]};
+        for( int iStep = 1 ; iStep <= 3 ; iStep++ ){
+          inputList.emplace_back( xList_.front() - iStep*firstStep );
+          inputList.emplace_back( xList_.back() + iStep*lastStep );
+        }
+      }
+    }
+
+    double eval(const DialBase* dialBase_, double input_){
+      input.getInputBuffer()[0] = input_;
+      return dialBase_->evalResponse( input );
+    }
+
+    template<typename F> bool isEquivalent(const DialBase* dialBase_, double tolerance_, const F& replacement_){
+      for( auto x : inputList ){
+        // written to be false with NaNs
+        if( not ( std::abs( eval(dialBase_, x) - replacement_(x) ) <= tolerance_ ) ){ return false; }
+      }
+      return true;
+    }
+    bool isEquivalentDial(const DialBase* dialBase_, double tolerance_, const DialBase* replacement_){
+      DialProbe replacementProbe{};
+      return isEquivalent(dialBase_, tolerance_, [&](double x_){ return replacementProbe.eval(replacement_, x_); });
+    }
+    double getMaxDifference(const DialBase* dialBase_, const DialBase* replacement_){
+      double out{0};
+      for( auto x : inputList ){
+        const double difference{std::abs( eval(dialBase_, x) - eval(replacement_, x) )};
+        if( not ( difference <= out ) ){ out = difference; } // NaNs propagate
+      }
+      return out;
+    }
+  };
+
+  // Same check as UniformSpline::buildDial()
+  bool isUniformGrid(const std::vector<double>& xList_){
+    if( xList_.size() < 2 ){ return false; }
+    const double tolerance{std::sqrt(std::numeric_limits<float>::epsilon())};
+    const double step{(xList_.back() - xList_.front())/(double(xList_.size()) - 1.)};
+    for( size_t iKnot = 0 ; iKnot < xList_.size() ; iKnot++ ){
+      if( std::abs(xList_[iKnot] - xList_.front() - double(iKnot)*step)/step > tolerance ){ return false; }
+    }
+    return true;
+  }
+
+  // The slopes at the knots of the compact (Catmull-Rom) and monotonic
+  // splines, as their kernels compute them, per unit of input.
+  void fillCatmullRomSlopes(const std::vector<double>& xList_, const std::vector<double>& yList_,
+                            bool isMonotonic_, std::vector<double>& slopeList_){
+    const int nKnots{int(yList_.size())};
+    const double step{(xList_.back() - xList_.front())/(nKnots - 1.)};
+    auto delta = [&](int i_){
+      i_ = std::min(std::max(i_, 0), nKnots-2);
+      return yList_[i_+1] - yList_[i_];
+    };
+
+    slopeList_.clear();
+    for( int iKnot = 0 ; iKnot < nKnots ; iKnot++ ){
+      const double previousDelta{delta(iKnot-1)};
+      const double nextDelta{delta(iKnot)};
+      double slope{0.5*(previousDelta + nextDelta)};
+      if( isMonotonic_ ){
+        // Fritsch-Carlson conditions
+        if( previousDelta*nextDelta <= 0.0 ){ slope = 0.0; }
+        const double limit{3.0*std::min(std::abs(previousDelta), std::abs(nextDelta))};
+        slope = std::min(std::max(slope, -limit), limit);
+      }
+      slopeList_.emplace_back( slope/step );
+    }
+  }
+
+  // The values defining the response of an event-by-event dial, for the 1D
+  // types which can be shared by DialCollection::storeEventDial().  Two dials
+  // of the same type with the same content have the same response.
+  bool getDialContent(const DialBase* dialBase_, std::vector<double>& content_){
+    content_.clear();
+
+    const std::type_index dialType{typeid(*dialBase_)};
+    if( dialType == typeid(Graph) or dialType == typeid(Spline) ){
+      // a cubic segment is defined by the values and the slopes at its ends
+      std::vector<double> xList, yList, slopeList;
+      if( not getDialKnots(dialBase_, xList, yList, slopeList) ){ return false; }
+      content_.insert( content_.end(), xList.begin(), xList.end() );
+      content_.insert( content_.end(), yList.begin(), yList.end() );
+      content_.insert( content_.end(), slopeList.begin(), slopeList.end() );
+    }
+    else if( dialType == typeid(LightGraph)
+             or dialType == typeid(CompactSpline) or dialType == typeid(MonotonicSpline)
+             or dialType == typeid(UniformSpline) or dialType == typeid(GeneralSpline) ){
+      content_ = dialBase_->getDialData();
+    }
+    else{ return false; }
+
+    content_.emplace_back( dialBase_->getAllowExtrapolation() ? 1. : 0. );
+    return true;
+  }
+
+  size_t hashDialContent(const std::type_index& dialType_, const std::vector<double>& content_){
+    size_t out{std::hash<std::type_index>()(dialType_)};
+    for( auto& value : content_ ){
+      out ^= std::hash<double>()(value) + 0x9e3779b97f4a7c15ULL + (out << 6) + (out >> 2);
+    }
+    return out;
+  }
+}
+
+size_t DialCollection::storeEventDial(std::unique_ptr<DialBase> dialBase_){
+  _nEventDials_++;
+
+  std::vector<double> content;
+  if( not _shareIdenticalDials_ or not getDialContent(dialBase_.get(), content) ){
+    size_t slot = this->getNextDialFreeSlot();
+    _dialBaseList_[slot] = DialBaseObject(dialBase_.release());
+    return slot;
+  }
+
+  const std::type_index dialType{typeid(*dialBase_)};
+  const size_t hash{hashDialContent(dialType, content)};
+
+  std::vector<double> storedContent;
+  std::lock_guard<std::mutex> lock(_dialContentLock_);
+  auto range = _dialContentSlotMap_.equal_range(hash);
+  for( auto it = range.first ; it != range.second ; ++it ){
+    auto* storedDial = _dialBaseList_[it->second].get();
+    if( std::type_index(typeid(*storedDial)) != dialType ){ continue; }
+    getDialContent(storedDial, storedContent);
+    if( storedContent == content ){ return it->second; } // dialBase_ is deleted
+  }
+
+  size_t slot = this->getNextDialFreeSlot();
+  _dialBaseList_[slot] = DialBaseObject(dialBase_.release());
+  _dialContentSlotMap_.emplace(hash, slot);
+  return slot;
+}
+
+void DialCollection::quantizeDials(){
+#ifdef GUNDAM_USING_CACHE_MANAGER
+  if( GundamGlobals::isCacheManagerEnabled() ){
+    // the device buffers hold the knots in double precision: nothing to gain
+    LogAlert << "\"" << this->getTitle() << "\": quantizeDials is disabled with the cache manager." << std::endl;
+    return;
+  }
+#endif
+
+  LogInfo << "Quantizing the spline knots of \"" << this->getTitle() << "\"..." << std::endl;
+
+  std::map<std::string, size_t> quantizedCountMap{};
+  size_t nQuantized{0};
+  size_t nRejected{0};
+  double maxError{0};
+  size_t originalDataSize{0};
+  size_t quantizedDataSize{0};
+
+  DialProbe probe{};
+  std::vector<double> xList{};
+  std::vector<double> yList{};
+  std::vector<double> slopeList{};
+  for( auto& dialBaseObject : _dialBaseList_ ){
+    auto* dialBase = dialBaseObject.get();
+    if( dialBase == nullptr ){ continue; }
+
+    const std::type_index dialType{typeid(*dialBase)};
+    const bool isCatmullRom{ dialType == typeid(CompactSpline) or dialType == typeid(MonotonicSpline) };
+    if( not isCatmullRom and dialType != typeid(UniformSpline) and dialType != typeid(GeneralSpline) ){ continue; }
+    if( not getDialKnots(dialBase, xList, yList, slopeList) ){ continue; }
+    if( xList.size() < 2 or not isUniformGrid(xList) ){ continue; }
+
+    const bool allowExtrapolation{dialBase->getAllowExtrapolation()};
+    if( isCatmullRom ){
+      // out of the knots, the compact and monotonic kernels don't continue
+      // the end segments: only the clamped ones have an equivalent
+      if( allowExtrapolation ){ continue; }
+      fillCatmullRomSlopes( xList, yList, dialType == typeid(MonotonicSpline), slopeList );
+    }
+
+    auto quantized = std::make_shared<QuantizedSpline>();
+    quantized->setAllowExtrapolation( allowExtrapolation );
+    quantized->buildDial( xList, yList, slopeList );
+
+    probe.setKnots( xList, allowExtrapolation, 16 );
+    const double error{probe.getMaxDifference(dialBase, quantized.get())};
+    if( not ( error <= _quantizeDialsTolerance_ ) ){ nRejected++; continue; }
+
+    nQuantized++;
+    maxError = std::max(maxError, error);
+    originalDataSize += dialBase->getDialData().size()*sizeof(double);
+    quantizedDataSize += quantized->getKnotDataSize();
+    quantizedCountMap[dialBase->getDialTypeName()]++;
+    dialBaseObject = quantized;
+  }
+
+  LogInfo << "Quantized dials: " << nQuantized << " out of " << _dialBaseList_.size()
+          << ", " << nRejected << " kept for an error above " << _quantizeDialsTolerance_ << std::endl;
+  if( nQuantized == 0 ){ return; }
+  LogScopeIndent;
+  std::vector<std::string> countList{};
+  for( auto& quantizedCount : quantizedCountMap ){
+    countList.emplace_back( quantizedCount.first + ": " + std::to_string(quantizedCount.second) );
+  }
+  LogInfo << GenericToolbox::joinVectorString(countList, ", ") << std::endl;
+  LogInfo << "Largest response error: " << maxError << std::endl;
+  LogInfo << "Knot data: " << double(originalDataSize)/1024./1024. << " MB -> "
+          << double(quantizedDataSize)/1024./1024. << " MB" << std::endl;
+}
+
+void DialCollection::simplifyDials(){
+  LogInfo << "Simplifying the dials of \"" << this->getTitle() << "\"..." << std::endl;
+
+  // The dials flat at one can only be dropped if the response supervisor
+  // keeps a response of one.
+  auto isOneKept = [&](size_t iDial_){
+    if( _dialResponseSupervisorList_.empty() ){ return true; }
+    auto& supervisor = ( _dialResponseSupervisorList_.size() == _dialBaseList_.size() ) ?
+        _dialResponseSupervisorList_[iDial_] : _dialResponseSupervisorList_[0];
+    return supervisor.process(1.) == 1.;
+  };
+
+  auto makeLightGraph = [](const std::vector<double>& xList_, const std::vector<double>& yList_, bool allowExtrapolation_){
+    auto out = std::make_shared<LightGraph>();
+    out->setAllowExtrapolation( allowExtrapolation_ );
+    out->buildDial( TGraph(int(xList_.size()), xList_.data(), yList_.data()) );
+    return out;
+  };
+
+  // original type -> replacement type -> count
+  std::map<std::string, std::map<std::string, size_t>> replacementCountMap{};
+  size_t nDropped{0};
+  size_t nConverted{0};
+
+  DialProbe probe{};
+  std::vector<double> xList{};
+  std::vector<double> yList{};
+  std::vector<double> slopeList{};
+  for( size_t iDial = 0 ; iDial < _dialBaseList_.size() ; iDial++ ){
+    auto* dialBase = _dialBaseList_[iDial].get();
+    if( dialBase == nullptr ){ continue; }
+    if( not getDialKnots(dialBase, xList, yList, slopeList) ){ continue; }
+
+    const std::type_index dialType{typeid(*dialBase)};
+    const bool allowExtrapolation{dialBase->getAllowExtrapolation()};
+    probe.setKnots( xList, allowExtrapolation );
+
+    // the candidates are tried from the cheapest one
+    DialBaseObject replacement{nullptr};
+    if( probe.isEquivalent(dialBase, _simplifyDialsTolerance_, [](double){ return 1.; }) and isOneKept(iDial) ){
+      nDropped++;
+      replacementCountMap[dialBase->getDialTypeName()]["dropped"]++;
+      _dialBaseList_[iDial].reset();
+      continue;
+    }
+    else if( probe.isEquivalent(dialBase, _simplifyDialsTolerance_, [&](double){ return yList.front(); }) ){
+      replacement = std::make_shared<Shift>();
+      replacement->buildDial( yList.front() );
+    }
+    else if( xList.size() > 2 or dialType != typeid(LightGraph) ){
+      // the straight line between the end knots, as LightGraph computes it
+      auto line = [&](double x_){
+        if( not allowExtrapolation ){
+          if     ( x_ <= xList.front() ){ return yList.front(); }
+          else if( x_ >= xList.back() ){ return yList.back(); }
+        }
+        return yList.front() + (x_ - xList.front())/(xList.back() - xList.front())*(yList.back() - yList.front());
+      };
+      if( probe.isEquivalent(dialBase, _simplifyDialsTolerance_, line) ){
+        replacement = makeLightGraph( {xList.front(), xList.back()}, {yList.front(), yList.back()}, allowExtrapolation );
+      }
+    }
+
+    if( replacement == nullptr and dialType == typeid(Graph) and xList.size() <= 15 ){
+      replacement = makeLightGraph( xList, yList, allowExtrapolation );
+    }
+    if( replacement == nullptr and ( dialType == typeid(Spline) or dialType == typeid(GeneralSpline) ) ){
+      if( isUniformGrid(xList) ){
+        replacement = std::make_shared<UniformSpline>();
+      }
+      else if( dialType == typeid(Spline) and xList.size() <= 16 ){
+        replacement = std::make_shared<GeneralSpline>();
+      }
+      if( replacement != nullptr ){
+        replacement->setAllowExtrapolation( allowExtrapolation );
+        replacement->buildDial( xList, yList, slopeList );
+      }
+    }
+
+    // the conversions of the types are checked as well
+    if( replacement == nullptr ){ continue; }
+    if( not probe.isEquivalentDial(dialBase, _simplifyDialsTolerance_, replacement.get()) ){ continue; }
+
+    nConverted++;
+    replacementCountMap[dialBase->getDialTypeName()][replacement->getDialTypeName()]++;
+    _dialBaseList_[iDial] = replacement;
+  }
+
+  LogInfo << "Simplified dials: " << nDropped << " dropped and " << nConverted << " converted out of "
+          << _dialBaseList_.size() << " (tolerance: " << _simplifyDialsTolerance_ << ")" << std::endl;
+  LogScopeIndent;
+  for( auto& replacementCount : replacementCountMap ){
+    std::vector<std::string> countList{};
+    for( auto& count : replacementCount.second ){
+      countList.emplace_back( ( count.first == "dropped" ? count.first : "-> " + count.first ) + ": " + std::to_string(count.second) );
+    }
+    LogInfo << replacementCount.first << ": " << GenericToolbox::joinVectorString(countList, ", ") << std::endl;
+  }
 }
 
 // init protected
@@ -388,6 +1164,14 @@ void DialCollection::readGlobals(const JsonType &config_) {
   }
 
   _allowDialExtrapolation_ = GenericToolbox::Json::fetchValue(config_, "allowDialExtrapolation", _allowDialExtrapolation_);
+  _useSharedKnotBasis_ = GenericToolbox::Json::fetchValue(config_, "useSharedKnotBasis", _useSharedKnotBasis_);
+  _shareIdenticalDials_ = GenericToolbox::Json::fetchValue(config_, "shareIdenticalDials", _shareIdenticalDials_);
+  _simplifyDials_ = GenericToolbox::Json::fetchValue(config_, "simplifyDials", _simplifyDials_);
+  _simplifyDialsTolerance_ = GenericToolbox::Json::fetchValue(config_, "simplifyDialsTolerance", _simplifyDialsTolerance_);
+  LogThrowIf(_simplifyDialsTolerance_ < 0, "Invalid simplifyDialsTolerance: " << _simplifyDialsTolerance_);
+  _quantizeDials_ = GenericToolbox::Json::fetchValue(config_, "quantizeDials", _quantizeDials_);
+  _quantizeDialsTolerance_ = GenericToolbox::Json::fetchValue(config_, "quantizeDialsTolerance", _quantizeDialsTolerance_);
+  LogThrowIf(_quantizeDialsTolerance_ < 0, "Invalid quantizeDialsTolerance: " << _quantizeDialsTolerance_);
 }
 bool DialCollection::initializeNormDialsWithParBinning() {
   auto binning = GenericToolbox::Json::fetchValue(_config_, "parametersBinningPath", JsonType());
@@ -422,6 +1206,9 @@ bool DialCollection::initializeDialsWithTabulation(const JsonType& dialsDefiniti
   //      libraryPath: <path-to-library>    Location of the library
   //      initFunction: <init-func-name>    Function called for initialization
   //      updateFunction: <update-func-name>    Function called to update table
+  //      updateRangeFunction: <func-name>   (Optional) Function called to
+  //                                           update a range of the table
+  //                                           (see TabulatedDialFactory.h)
   //      binningFunction: <bin-func-name>  Function to find bin index
   //      initArguments: [<arg1>, ...]      List of argument strings (e.g.
   //                                           input file names)
@@ -493,6 +1280,9 @@ bool DialCollection::initializeDialsWithTabulation(const JsonType& dialsDefiniti
   std::unique_ptr<TabulatedDialFactory> tabulated
       = std::make_unique<TabulatedDialFactory>(dialsDefinition_);
 
+  // The tables which can't be split are given to the threads in turn.
+  tabulated->setUpdateSlot(_index_);
+
   // Save the new object.
   _dialCollectionData_.emplace_back(std::move(tabulated));
 
@@ -501,9 +1291,13 @@ bool DialCollection::initializeDialsWithTabulation(const JsonType& dialsDefiniti
     addExtraLeafName(var);
   }
 
-  addUpdate(
-      [this]{getCollectionData<TabulatedDialFactory>()->updateTable(
-          getDialInputBufferList().front());
+  // The table is only filled when its parameters changed (see update()),
+  // and the factory splits the filling between the threads if it can.
+  addParallelUpdate(
+      [this](int iThread_, int nThreads_){
+        const auto& inputBufferList = getDialInputBufferList();
+        getCollectionData<TabulatedDialFactory>()->updateTable(
+            inputBufferList.front(), iThread_, nThreads_);
       });
 
   return true;
@@ -693,8 +1487,8 @@ bool DialCollection::initializeDialsWithDefinition() {
         _dialBaseList_.emplace_back( DialBaseObject( f.makeDial( dialsDefinition ) ) );
 
         for( auto& var : bin.getEdgesList() ){
-          ((RootFormula*) _dialBaseList_.back().get())->getFormula().SetParameter(
-              var.varName.c_str(), var.getCenterValue()
+          ((RootFormula*) _dialBaseList_.back().get())->setParameter(
+              var.varName, var.getCenterValue()
           );
         }
       }
@@ -771,13 +1565,40 @@ JsonType DialCollection::fetchDialsDefinition(const JsonType &definitionsList_)
 }
 
 void DialCollection::update() {
-  for (std::function<void(void)>& func : _dialCollectionCallbacks_) {
-    func();
+  if( not isUpdateRequested() ){ return; }
+  this->update(-1, 1);
+  this->flagUpdateDone();
+}
+
+void DialCollection::update(int iThread_, int nThreads_) {
+  for (std::function<void(int, int)>& func : _dialCollectionCallbacks_) {
+    func(iThread_, nThreads_);
   }
 }
 
 void DialCollection::addUpdate(std::function<void(void)> callback) {
-  _dialCollectionCallbacks_.emplace_back(callback);
+  _dialCollectionCallbacks_.emplace_back(
+      [callback](int iThread_, int /* nThreads_ */){ if( iThread_ <= 0 ){ callback(); } }
+  );
+}
+
+void DialCollection::addParallelUpdate(std::function<void(int iThread_, int nThreads_)> callback) {
+  _dialCollectionCallbacks_.emplace_back(std::move(callback));
+}
+
+bool DialCollection::isUpdateRequested() const {
+  if( _updateInputVersionList_.size() != _dialInputBufferList_.size() ){ return true; }
+  for( size_t iBuffer = 0 ; iBuffer < _dialInputBufferList_.size() ; iBuffer++ ){
+    if( _dialInputBufferList_[iBuffer].getVersion() != _updateInputVersionList_[iBuffer] ){ return true; }
+  }
+  return false;
+}
+
+void DialCollection::flagUpdateDone() {
+  _updateInputVersionList_.resize( _dialInputBufferList_.size() );
+  for( size_t iBuffer = 0 ; iBuffer < _dialInputBufferList_.size() ; iBuffer++ ){
+    _updateInputVersionList_[iBuffer] = _dialInputBufferList_[iBuffer].getVersion();
+  }
 }
 
 void DialCollection::printConfiguration() const {
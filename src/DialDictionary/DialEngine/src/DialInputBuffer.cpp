@@ -12,9 +12,13 @@
 LoggerInit([]{ Logger::setUserHeaderStr("[DialInputBuffer]"); });
 #endif
 
+std::atomic<uint64_t> DialInputBuffer::_versionSource_{0};
+
 void DialInputBuffer::invalidateBuffers(){
   // invalidate buffer
   for( auto& buf : _inputBuffer_ ){ buf = std::nan("unset"); }
+  _isValueListSynced_ = false;
+  _version_ = makeVersion();
 }
 
 void DialInputBuffer::initialise(){
@@ -28,6 +32,13 @@ void DialInputBuffer::initialise(){
 
   // set the buffer to the proper size
   _inputBuffer_.resize(_inputArraySize_, std::nan("unset"));
+  _version_ = makeVersion();
+
+  // the offset of each parameter set in the flattened value list
+  std::vector<int> parSetOffsetList(_parSetListPtr_->size(), 0);
+  for( size_t iParSet = 1 ; iParSet < _parSetListPtr_->size() ; iParSet++ ){
+    parSetOffsetList[iParSet] = parSetOffsetList[iParSet-1] + int((*_parSetListPtr_)[iParSet-1].getParameterList().size());
+  }
 
   // sanity checks
   for( int iInput = 0 ; iInput < _inputArraySize_ ; iInput++ ){
@@ -40,6 +51,9 @@ void DialInputBuffer::initialise(){
                "Parameter index invalid: " << _inputParameterReferenceList_[iInput].parIndex);
     LogThrowIf(_inputParameterReferenceList_[iInput].parIndex >= getParameterSet(iInput).getParameterList().size(),
                "Parameter index invalid: " << _inputParameterReferenceList_[iInput].parIndex);
+
+    _inputParameterReferenceList_[iInput].valueIndex =
+        parSetOffsetList[_inputParameterReferenceList_[iInput].parSetIndex] + _inputParameterReferenceList_[iInput].parIndex;
   }
 
   _isInitialized_ = true;
@@ -49,45 +63,70 @@ void DialInputBuffer::update(){
   // by default consider we have to update
   _isDialUpdateRequested_ = true;
 
+  // the buffer isn't following the value list anymore
+  _isValueListSynced_ = false;
+
   // look for the parameter values
   double tempBuffer;
   _isDialUpdateRequested_ = false; // if ANY is different, request the update
   for( auto& inputRef : _inputParameterReferenceList_ ){
     // grab the value of the parameter
     tempBuffer = inputRef.getParameter(_parSetListPtr_).getParameterValue();
-
-    // find the actual parameter value if mirroring is applied
-    if( not std::isnan( inputRef.mirrorEdges.minValue ) ){
-      tempBuffer = std::abs(std::fmod(
-          tempBuffer - inputRef.mirrorEdges.minValue,
-          2 * inputRef.mirrorEdges.range
-      ));
-
-      if( tempBuffer > inputRef.mirrorEdges.range ){
-        // odd pattern  -> mirrored -> decreasing effective X while increasing parameter
-        tempBuffer -= 2 * inputRef.mirrorEdges.range;
-        tempBuffer = -tempBuffer;
-      }
-
-      // re-apply the offset
-      tempBuffer += inputRef.mirrorEdges.minValue;
-    }
-    if( std::isnan(tempBuffer) ){
-        // LogThrowIf is broken, but OK for real error traps, but this is
-        // checking user input it's critical that the error message is
-        // properly formated so print an error, a backtrace, and then exit.
-        LogError << "NaN while evaluating input buffer of "
-                 << inputRef.getParameter(_parSetListPtr_).getTitle()
-                 << std::endl;
-        LogError << GundamUtils::Backtrace << std::endl;
-        std::exit(EXIT_FAILURE);
+    this->setInput( inputRef, tempBuffer );
+  }
+}
+void DialInputBuffer::update(const double* valueList_, const char* changedList_){
+  // the value indices are only set by initialise()
+  if( not _isInitialized_ ){ this->update(); return; }
+
+  if( _isValueListSynced_ ){
+    bool hasChanged{false};
+    for( auto& inputRef : _inputParameterReferenceList_ ){ hasChanged |= bool(changedList_[inputRef.valueIndex]); }
+    if( not hasChanged ){
+      _isDialUpdateRequested_ = false;
+      return;
     }
+  }
 
-    // has it been updated?
-    if( _inputBuffer_[inputRef.bufferIndex] != tempBuffer ){
-      _isDialUpdateRequested_ = true;
-      _inputBuffer_[inputRef.bufferIndex] = tempBuffer;
+  _isDialUpdateRequested_ = false; // if ANY is different, request the update
+  for( auto& inputRef : _inputParameterReferenceList_ ){
+    this->setInput( inputRef, valueList_[inputRef.valueIndex] );
+  }
+  _isValueListSynced_ = true;
+}
+void DialInputBuffer::setInput(const ParameterReference& inputRef_, double value_){
+  // find the actual parameter value if mirroring is applied
+  if( not std::isnan( inputRef_.mirrorEdges.minValue ) ){
+    value_ = std::abs(std::fmod(
+        value_ - inputRef_.mirrorEdges.minValue,
+        2 * inputRef_.mirrorEdges.range
+    ));
+
+    if( value_ > inputRef_.mirrorEdges.range ){
+      // odd pattern  -> mirrored -> decreasing effective X while increasing parameter
+      value_ -= 2 * inputRef_.mirrorEdges.range;
+      value_ = -value_;
     }
+
+    // re-apply the offset
+    value_ += inputRef_.mirrorEdges.minValue;
+  }
+  if( std::isnan(value_) ){
+      // LogThrowIf is broken, but OK for real error traps, but this is
+      // checking user input it's critical that the error message is
+      // properly formated so print an error, a backtrace, and then exit.
+      LogError << "NaN while evaluating input buffer of "
+               << inputRef_.getParameter(_parSetListPtr_).getTitle()
+               << std::endl;
+      LogError << GundamUtils::Backtrace << std::endl;
+      std::exit(EXIT_FAILURE);
+  }
+
+  // has it been updated?
+  if( _inputBuffer_[inputRef_.bufferIndex] != value_ ){
+    _isDialUpdateRequested_ = true;
+    _inputBuffer_[inputRef_.bufferIndex] = value_;
+    _version_ = makeVersion();
   }
 }
 void DialInputBuffer::addParameterReference( const ParameterReference& parReference_){
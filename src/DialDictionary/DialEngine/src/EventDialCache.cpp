@@ -4,8 +4,12 @@
 
 #include "EventDialCache.h"
 
+#include "GundamGlobals.h"
 #include "Logger.h"
 
+#include <algorithm>
+#include <map>
+
 #ifndef DISABLE_USER_HEADER
 LoggerInit([]{ Logger::setUserHeaderStr("[EventDialCache]"); });
 #endif
@@ -69,6 +73,8 @@ void EventDialCache::buildReferenceCache( SampleSet& sampleSet_, std::vector<Dia
 
   }
 
+  if( _isEventCompressionEnabled_ ){ this->compressEvents( sampleSet_, sampleIndexCacheList ); }
+
   auto countValidDials = [](std::vector<DialIndexCacheEntry>& dialIndices_){
     return std::count_if(dialIndices_.begin(), dialIndices_.end(),
       []( DialIndexCacheEntry& dialIndex_){
@@ -115,16 +121,108 @@ void EventDialCache::buildReferenceCache( SampleSet& sampleSet_, std::vector<Dia
           LogThrow("DEV ERROR: Please report this issue to github!! This should not happen");
         }
 
+        auto& dialCollection = dialCollectionList_.at(dialIndex.collectionIndex);
+
+        // dropped by DialCollection::simplifyDials(): the response is one
+        if( dialCollection.getDialInterfaceList()[dialIndex.interfaceIndex].getDialBaseRef() == nullptr ){ continue; }
+
         cacheEntry.dialResponseCacheList.emplace_back(
-            dialCollectionList_.at(dialIndex.collectionIndex)
-            .getDialInterfaceList().at(dialIndex.interfaceIndex)
+            dialCollection.getDialInterfaceList().at(dialIndex.interfaceIndex)
         );
+
+        // the responses are evaluated by the collection (see Propagator::reweightEvents)
+        if( dialCollection.getDialResponseList().size() == dialCollection.getDialInterfaceList().size() ){
+          cacheEntry.dialResponseCacheList.back().collectionResponse = &dialCollection.getDialResponseList()[dialIndex.interfaceIndex];
+        }
       }
     }
   }
 
   LogInfo << "Reference cache has been setup." << std::endl;
 }
+void EventDialCache::compressEvents(SampleSet& sampleSet_, std::vector<std::vector<IndexedCacheEntry>>& sampleIndexCacheList_){
+#ifdef GUNDAM_USING_CACHE_MANAGER
+  if( GundamGlobals::isCacheManagerEnabled() ){
+    // the device doesn't know about the merged squared weights
+    LogAlert << "Event compression is disabled with the cache manager." << std::endl;
+    return;
+  }
+#endif
+
+  LogInfo << "Compressing the events with identical dials..." << std::endl;
+  LogScopeIndent;
+
+  size_t nEventsBefore{0};
+  size_t nEventsAfter{0};
+  for( size_t iSample = 0 ; iSample < sampleSet_.getSampleList().size() ; iSample++ ){
+    auto& eventList = sampleSet_.getSampleList()[iSample].getEventList();
+    auto& indexCacheList = sampleIndexCacheList_[iSample];
+
+    // the bin and the sorted dial indices identify the reweight factor
+    std::map<std::vector<size_t>, size_t> representativeIndexMap{};
+    std::vector<Event> compressedEventList{};
+    std::vector<IndexedCacheEntry> compressedIndexCacheList{};
+    compressedEventList.reserve( eventList.size() );
+    compressedIndexCacheList.reserve( indexCacheList.size() );
+
+    std::vector<size_t> signature{};
+    for( size_t iEvent = 0 ; iEvent < eventList.size() ; iEvent++ ){
+      auto& event = eventList[iEvent];
+
+      if( event.getIndices().bin >= 0 ){
+        signature.clear();
+        signature.emplace_back( size_t(event.getIndices().bin) );
+        for( auto& dial : indexCacheList[iEvent].dials ){
+          signature.emplace_back( dial.collectionIndex );
+          signature.emplace_back( dial.interfaceIndex );
+        }
+        // the order of the dials doesn't change the product
+        std::vector<std::pair<size_t, size_t>> dialPairList{};
+        for( size_t iSlot = 1 ; iSlot + 1 < signature.size() ; iSlot += 2 ){ dialPairList.emplace_back( signature[iSlot], signature[iSlot+1] ); }
+        std::sort( dialPairList.begin(), dialPairList.end() );
+        for( size_t iPair = 0 ; iPair < dialPairList.size() ; iPair++ ){
+          signature[1 + 2*iPair] = dialPairList[iPair].first;
+          signature[2 + 2*iPair] = dialPairList[iPair].second;
+        }
+
+        auto representativeIt = representativeIndexMap.find( signature );
+        if( representativeIt != representativeIndexMap.end() ){
+          auto& weights = compressedEventList[representativeIt->second].getWeights();
+          double mergedBase{weights.base + event.getWeights().base};
+          if( mergedBase != 0 ){
+            double sumSq{
+              weights.sqScale * weights.base * weights.base
+              + event.getWeights().sqScale * event.getWeights().base * event.getWeights().base
+            };
+            weights.base = mergedBase;
+            weights.sqScale = sumSq / (mergedBase * mergedBase);
+            weights.resetCurrentWeight();
+            continue;
+          }
+          // the weights cancel out: keep them separated
+        }
+        else{
+          representativeIndexMap.emplace( signature, compressedEventList.size() );
+        }
+      }
+
+      compressedEventList.emplace_back( std::move(event) );
+      compressedIndexCacheList.emplace_back( std::move(indexCacheList[iEvent]) );
+      compressedIndexCacheList.back().event.eventIndex = compressedEventList.size() - 1;
+    }
+
+    nEventsBefore += eventList.size();
+    nEventsAfter += compressedEventList.size();
+    LogInfo << sampleSet_.getSampleList()[iSample].getName() << ": " << eventList.size() << " -> " << compressedEventList.size() << " events" << std::endl;
+
+    eventList = std::move( compressedEventList );
+    indexCacheList = std::move( compressedIndexCacheList );
+  }
+
+  LogInfo << "Event compression: " << nEventsBefore << " -> " << nEventsAfter << " events";
+  if( nEventsAfter != 0 ){ LogInfo << " (ratio " << double(nEventsBefore) / double(nEventsAfter) << ")"; }
+  LogInfo << std::endl;
+}
 void EventDialCache::allocateCacheEntries( size_t nEvent_, size_t nDialsMaxPerEvent_) {
     _indexedCache_.resize(
         _indexedCache_.size() + nEvent_,
@@ -159,7 +257,7 @@ EventDialCache::IndexedCacheEntry* EventDialCache::fetchNextCacheEntry(){
 void EventDialCache::reweightEntry( EventDialCache::CacheEntry& entry_){
   // storing the reweight factor in a temporary buffer
   // this allows to perform capping of the value
-  double tempReweight{1};
+  double tempReweight{entry_.frozenReweight};
 
   // calculate the dial responses
   for( auto& dialResponseCache : entry_.dialResponseCacheList ){
@@ -172,3 +270,30 @@ void EventDialCache::reweightEntry( EventDialCache::CacheEntry& entry_){
   entry_.event->getWeights().resetCurrentWeight(); // reset to the base weight
   entry_.event->getWeights().current *= tempReweight; // apply the reweight factor
 }
+size_t EventDialCache::freezeDials( const std::function<bool(const DialInterface&)>& isFrozen_ ){
+  size_t nFrozen{0};
+  for( auto& entry : _cache_ ){
+    auto& dialList = entry.dialResponseCacheList;
+    auto firstFrozen = std::stable_partition(dialList.begin(), dialList.end(), [&](const DialResponseCache& dial_){
+      return not isFrozen_( *dial_.dialInterface );
+    });
+    for( auto dialIt = firstFrozen ; dialIt != dialList.end() ; ++dialIt ){
+      entry.frozenReweight *= dialIt->dialInterface->evalResponse();
+      entry.frozenDialResponseCacheList.emplace_back( *dialIt );
+      nFrozen++;
+    }
+    dialList.erase(firstFrozen, dialList.end());
+  }
+  return nFrozen;
+}
+void EventDialCache::unfreezeDials(){
+  for( auto& entry : _cache_ ){
+    for( auto& dial : entry.frozenDialResponseCacheList ){
+      // the cached response might be outdated
+      dial.response = dial.dialInterface->evalResponse();
+      entry.dialResponseCacheList.emplace_back( dial );
+    }
+    entry.frozenDialResponseCacheList.clear();
+    entry.frozenReweight = 1;
+  }
+}
@@ -18,6 +18,8 @@ class DialBase;
 ///      initArguments: [<arg1>, ...]      List of argument strings (e.g.
 ///                                           input file names)
 ///      updateFunction: <update-func-name> Function called to update table
+///      updateRangeFunction: <func-name>  (Optional) Function called to
+///                                           update a range of the table.
 ///      binningFunction: <bin-func-name>  Function to find bin index
 ///      binningVariables: [<var1>, ... ] Variables used for binning the
 ///                                           table "X" coordinate by the
@@ -58,6 +60,26 @@ class DialBase;
 //
 /// The function should return 0 for success, and any other value for failure
 ///
+/// UPDATE TABLE RANGE FUNCTION: If updateRangeFunction is provided, it is
+/// used instead of the updateFunction (which then becomes optional), and the
+/// table is filled by all the threads of the propagator.  The signature is:
+///
+///    extern "C"
+///    int updateRangeFunc(const char* name,
+///                        double table[], int bins,
+///                        const double par[], int npar,
+///                        int begin, int end)
+///
+///        begin, end -- Only table[begin] to table[end-1] must be filled.
+///        The other arguments are the ones of the updateFunction.
+///
+/// The function is called at the same time by several threads, with the
+/// same parameters and different ranges, so it must be thread safe.
+///
+/// In any case, the table is only updated when the parameters have changed
+/// since the previous update.  The tables which can't be split are updated
+/// at the same time as the other tables.
+///
 /// The table will be filled with "bins" values calculated with uniform
 /// spacing between "low" and "high".  If bins is one, there must be one
 /// value calculated for "low", if bins is two or more, then the first point
@@ -99,8 +121,14 @@ public:
     /// Create an event-by-event weighting dial for this table.
     [[nodiscard]] DialBase* makeDial(const Event& event);
 
-    /// Update the tabulated buffer.
-    void updateTable(DialInputBuffer& inputBuffer);
+    /// Update the tabulated buffer.  The part of the table filled by the
+    /// thread iThread_ of nThreads_ (all of it for iThread_ = -1).  Without
+    /// an update range function, the table is filled by a single thread.
+    void updateTable(const DialInputBuffer& inputBuffer, int iThread_ = -1, int nThreads_ = 1);
+
+    /// Set the slot of the table when it can't be split: it is filled by
+    /// the thread slot_ % nThreads_ (see updateTable).
+    void setUpdateSlot(int slot_) {_updateSlot_ = slot_;}
 
     /// Get the table name
     const std::string& getName() {return _name_;}
@@ -122,6 +150,10 @@ public:
     /// Get the name of the function to update the table.
     const std::string& getUpdateFunction() {return _updateFuncName_;}
 
+    /// Get the name of the function to update a range of the table (empty if
+    /// the whole table is updated by the update function).
+    const std::string& getUpdateRangeFunction() {return _updateRangeFuncName_;}
+
     /// Get a vector of event variable names that are used to find the bin
     /// in the table for the event.
     const std::vector<std::string>& getBinningVariables() {return _binningVariableNames_;}
@@ -154,6 +186,21 @@ private:
                         double table[], int bins,
                         const double par[], int npar);
 
+    // The name of a symbol in the library that will be used to update a
+    // range of the table (optional).
+    std::string _updateRangeFuncName_;
+
+    // The function that is attached to _updateRangeFuncName_ symbol.
+    int (*_updateRangeFunc_)(const char* name,
+                             double table[], int bins,
+                             const double par[], int npar,
+                             int begin, int end){nullptr};
+
+    // The slot of the thread filling the table when it can't be split.  The
+    // owner gives the tables consecutive slots (the index of their dial
+    // collection), so they are updated by different threads at the same time.
+    int _updateSlot_{0};
+
     // A cache to hold the table of calculated values
     std::vector<double> _table_;
 
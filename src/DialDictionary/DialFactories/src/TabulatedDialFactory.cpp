@@ -6,6 +6,7 @@
 #include <Event.h>
 
 #include <GenericToolbox.Json.h>
+#include <GenericToolbox.Thread.h>
 #include <Logger.h>
 
 #include <dlfcn.h>
@@ -24,7 +25,13 @@ TabulatedDialFactory::TabulatedDialFactory(const JsonType& config_) {
     _initFuncName_ = GenericToolbox::Json::fetchValue<std::string>(tableConfig, "initFunction", _initFuncName_);
     _initArguments_ = GenericToolbox::Json::fetchValue(tableConfig, "initArguments", _initArguments_);
 
-    _updateFuncName_ = GenericToolbox::Json::fetchValue<std::string>(tableConfig, "updateFunction");
+    _updateRangeFuncName_ = GenericToolbox::Json::fetchValue<std::string>(tableConfig, "updateRangeFunction", _updateRangeFuncName_);
+    if( getUpdateRangeFunction().empty() ){
+        _updateFuncName_ = GenericToolbox::Json::fetchValue<std::string>(tableConfig, "updateFunction");
+    }
+    else{
+        _updateFuncName_ = GenericToolbox::Json::fetchValue<std::string>(tableConfig, "updateFunction", _updateFuncName_);
+    }
 
     _binningFuncName_ = GenericToolbox::Json::fetchValue<std::string>(tableConfig, "binningFunction");
 
@@ -39,6 +46,9 @@ TabulatedDialFactory::TabulatedDialFactory(const JsonType& config_) {
     LogInfo << "  Library path: " << getLibraryPath() << std::endl;
     LogInfo << "  Initialization function: " << getInitializationFunction() << std::endl;
     LogInfo << "  Update table function:   " << getUpdateFunction() << std::endl;
+    if (not getUpdateRangeFunction().empty()) {
+        LogInfo << "  Update range function:   " << getUpdateRangeFunction() << std::endl;
+    }
     LogInfo << "  Bin events function:     " << getBinningFunction() << std::endl;
     {
         int i{0};
@@ -89,18 +99,36 @@ TabulatedDialFactory::TabulatedDialFactory(const JsonType& config_) {
     }
     _table_.resize(bins);
 
+    // Get the update range function, the update function is then optional.
+    if (not getUpdateRangeFunction().empty()) {
+        void* updateRangeFunc = dlsym(library, getUpdateRangeFunction().c_str());
+        if( updateRangeFunc == nullptr ){
+            LogError << "Update range function symbol not found: "
+                     << getUpdateRangeFunction()
+                     << std::endl;
+            std::exit(EXIT_FAILURE); // Exit, not throw!
+        }
+        _updateRangeFunc_
+            = reinterpret_cast<
+                int(*)(const char* name, double table[],
+                       int bins, const double par[], int npar,
+                       int begin, int end)>(updateRangeFunc);
+    }
+
     // Get the update function
-    void* updateFunc = dlsym(library, getUpdateFunction().c_str());
-    if( updateFunc == nullptr ){
-        LogError << "Update function symbol not found: "
-                 << getUpdateFunction()
-                 << std::endl;
-        std::exit(EXIT_FAILURE); // Exit, not throw!
+    if (_updateRangeFunc_ == nullptr or not getUpdateFunction().empty()) {
+        void* updateFunc = dlsym(library, getUpdateFunction().c_str());
+        if( updateFunc == nullptr ){
+            LogError << "Update function symbol not found: "
+                     << getUpdateFunction()
+                     << std::endl;
+            std::exit(EXIT_FAILURE); // Exit, not throw!
+        }
+        _updateFunc_
+            = reinterpret_cast<
+                int(*)(const char* name, double table[],
+                       int bins, const double par[], int npar)>(updateFunc);
     }
-    _updateFunc_
-        = reinterpret_cast<
-            int(*)(const char* name, double table[],
-                   int bins, const double par[], int npar)>(updateFunc);
 
     // Get the binning function
     void* binningFunc = dlsym(library, getBinningFunction().c_str());
@@ -117,7 +145,21 @@ TabulatedDialFactory::TabulatedDialFactory(const JsonType& config_) {
 
 }
 
-void TabulatedDialFactory::updateTable(DialInputBuffer& inputBuffer) {
+void TabulatedDialFactory::updateTable(const DialInputBuffer& inputBuffer, int iThread_, int nThreads_) {
+    if (_updateRangeFunc_ != nullptr) {
+        auto bounds = GenericToolbox::ParallelWorker::getThreadBoundIndices(
+            iThread_, nThreads_, (int) _table_.size());
+        if (bounds.beginIndex >= bounds.endIndex) return;
+        _updateRangeFunc_(_name_.c_str(),
+                          _table_.data(),
+                          (int) _table_.size(),
+                          inputBuffer.getInputBuffer().data(),
+                          (int) inputBuffer.getInputBuffer().size(),
+                          bounds.beginIndex, bounds.endIndex);
+        return;
+    }
+
+    if (iThread_ >= 0 and iThread_ != _updateSlot_ % nThreads_) return;
     _updateFunc_(_name_.c_str(),
                  _table_.data(),
                  (int) _table_.size(),
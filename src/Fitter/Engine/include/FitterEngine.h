@@ -88,6 +88,8 @@ private:
   bool _enablePca_{false};
   bool _throwMcBeforeFit_{false};
   bool _enablePreFitScan_{false};
+  bool _freezeFixedParameterDials_{false};
+  bool _hoistBinConstantDials_{true};
   bool _enablePostFitScan_{false};
   bool _enablePreFitToPostFitLineScan_{true};
   bool _generateSamplePlots_{true};
@@ -93,6 +93,8 @@ void FitterEngine::configureImpl(){
   GenericToolbox::Json::fillValue(_config_, _pcaThreshold_, {{"pcaThreshold"},{"pcaDeltaLlhThreshold"},{"pcaDeltaChi2Threshold"},{"ghostParameterDeltaChi2Threshold"}});
 
   GenericToolbox::Json::fillValue(_config_, _enablePreFitScan_, "enablePreFitScan");
+  GenericToolbox::Json::fillValue(_config_, _freezeFixedParameterDials_, "freezeFixedParameterDials");
+  GenericToolbox::Json::fillValue(_config_, _hoistBinConstantDials_, "hoistBinConstantDials");
   GenericToolbox::Json::fillValue(_config_, _enablePostFitScan_, "enablePostFitScan");
   GenericToolbox::Json::fillValue(_config_, _enablePreFitToPostFitLineScan_, "enablePreFitToPostFitLineScan");
 
@@ -346,8 +348,35 @@ void FitterEngine::fit(){
     return;
   }
 
-  LogInfo << "Minimizing LLH..." << std::endl;
-  this->_minimizer_->minimize();
+  {
+    // the dials are restored as we leave, even if the minimizer throws
+    GenericToolbox::ScopedGuard freezeGuard{
+        [&](){
+          if( not _freezeFixedParameterDials_ ){ return; }
+          LogInfo << "Freezing the dials of the fixed parameters..." << std::endl;
+          getLikelihoodInterface().getModelPropagator().freezeFixedParameterDials();
+        },
+        [&](){
+          // the post-fit steps might release the fixed parameters (Hesse, scans...)
+          if( _freezeFixedParameterDials_ ){ getLikelihoodInterface().getModelPropagator().unfreezeFixedParameterDials(); }
+        }
+    };
+    GenericToolbox::ScopedGuard hoistGuard{
+        [&](){
+          if( not _hoistBinConstantDials_ ){ return; }
+          LogInfo << "Applying the dials shared by whole histogram bins on the bins..." << std::endl;
+          getLikelihoodInterface().getModelPropagator().hoistBinConstantDials();
+        },
+        [&](){
+          // the post-fit steps use the event weights (event trees, plots...)
+          if( _hoistBinConstantDials_ ){ getLikelihoodInterface().getModelPropagator().unhoistBinConstantDials(); }
+        }
+    };
+
+    LogInfo << "Minimizing LLH..." << std::endl;
+    this->_minimizer_->minimize();
+    getLikelihoodInterface().getModelPropagator().printSegmentHintSummary();
+  }
 
   LogWarning << "Saving post-fit par state..." << std::endl;
   _postFitParState_ = getLikelihoodInterface().getModelPropagator().getParametersManager().exportParameterInjectorConfig();
@@ -7,6 +7,7 @@
 
 #include "ParameterSet.h"
 #include "MinimizerBase.h"
+#include "AsyncTreeWriter.h"
 
 #include "GenericToolbox.Utils.h"
 #include "GenericToolbox.Time.h"
@@ -114,6 +115,46 @@ private:
   // The number of steps in each run cycle.
   int _steps_{10000};
 
+  // The number of chains that are run together.  Each chain has its own
+  // proposal and output tree, but all of the chains share the loaded events,
+  // and the proposed points for all of the chains are propagated in a single
+  // pass over the events.  One chain is the historical behavior.
+  int _nChains_{1};
+
+  // Combine the running posterior covariance estimates of all chains before
+  // each proposal update while the correlations are still being adapted.
+  bool _shareChainCovariance_{false};
+
+  // Stop running cycles once the Gelman-Rubin R-hat of every fit parameter
+  // (calculated at the end of each cycle) is below this value.  A value of
+  // zero (or less) never stops early.  Only used with several chains.
+  double _rHatStopThreshold_{0.0};
+
+  // Write the output trees from a background thread (see AsyncTreeWriter).
+  // The writer is also used when the steps are thinned, or the raw steps are
+  // saved as floats.
+  bool _asyncOutput_{false};
+
+  // The maximum number of steps waiting to be written by the background
+  // thread (for all of the chains).  The chains wait when the queue is full.
+  int _outputQueueSize_{1000};
+
+  // Only write one step out of this many to the output tree.  The last step
+  // of each cycle (with the full chain state) and the steps with a saved
+  // model are always written.  The mean and covariance of the points over
+  // all of the steps (after burn-in) are saved next to the tree.
+  int _stepSaveStride_{1};
+
+  // Save the raw steps (see _saveRawSteps_) as floats instead of doubles.
+  bool _saveRawStepsAsFloat_{false};
+
+  // The writer for the single chain output tree (when used).
+  std::unique_ptr<AsyncTreeWriter> _treeWriter_{};
+
+  // The thread doing all of the output file writes while the tree writers
+  // are used (shared by the chains and the convergence tree).
+  std::shared_ptr<AsyncFileWriter> _fileWriter_{};
+
   // The model for the likelihood takes up quite a bit of space, so it should
   // NOT be saved most of the time.  The _modelStride_ sets the number of
   // steps between when the model is saved to the output file.  The model is a
@@ -178,6 +219,10 @@ private:
   // covariance window).
   double _adaptiveCovDeweighting_{0.0};
 
+  // The number of incremental (rank-one) updates of the proposal
+  // decomposition before it is recalculated.  Zero to disable.
+  int _adaptiveIncrementalRefactor_{0};
+
   // The window used to calculate the current acceptance value.
   int _adaptiveWindow_{1000};
 
@@ -285,7 +330,94 @@ private:
 
   /// Set the default proposal based on the FitParameter values and steps.
   bool adaptiveDefaultProposalCovariance(AdaptiveStepMCMC& mcmc,sMCMC::Vector& prior);
+
+  /// Choose the starting point of a chain (either the current parameter
+  /// values, or a random point when _randomStart_ is true).  The chain has
+  /// been started at the returned point (without saving it).
+  sMCMC::Vector adaptiveStartPoint(AdaptiveStepMCMC& mcmc);
+
+  /////////////////////////////////////////////////////////////////
+  // Support routines to run several adaptive chains together.
+
+  /// The state of one of the chains when several chains are run together.
+  /// The output tree branches are attached to the fields of this struct, so
+  /// it must not move after the tree has been created.
+  struct ChainState {
+    std::unique_ptr<AdaptiveStepMCMC> mcmc{};
+    TTree* tree{nullptr};
+    std::unique_ptr<AsyncTreeWriter> writer{};
+
+    // The saved values for the accepted point (see the fields with the same
+    // names in AdaptiveMcmc).
+    std::vector<float> point{};
+    std::vector<float> model{};
+    std::vector<float> uncertainty{};
+    std::vector<float> saveModel{};
+    std::vector<float> saveUncertainty{};
+    float llhStatistical{0.0};
+    float llhPenalty{0.0};
+
+    // The same values for the last proposed point.  They are swapped with
+    // the accepted values when the step is accepted.
+    std::vector<float> proposedPoint{};
+    std::vector<float> proposedModel{};
+    std::vector<float> proposedUncertainty{};
+    float proposedLlhStatistical{0.0};
+    float proposedLlhPenalty{0.0};
+    double proposedLogLikelihood{0.0};
+
+    // Running mean and sum of the squared deviations of the accepted fit
+    // space points (used for the R-hat calculation).
+    double nSamples{0.0};
+    std::vector<double> sampleMean{};
+    std::vector<double> sampleSumSqDev{};
+  };
+
+  /// Route the filling of an MCMC output tree through an AsyncTreeWriter
+  /// when one of the output options needs it, otherwise return nullptr (and
+  /// the tree is filled directly).  The steps with a non empty saveModel_
+  /// are always written.
+  template<typename MCMC> std::unique_ptr<AsyncTreeWriter> makeTreeWriter(
+      MCMC& mcmc_, TTree* tree_, const std::vector<float>* saveModel_);
+
+  /// Run several adaptive chains side by side.  This follows the same
+  /// burn-in and cycle structure as setupAndRunAdaptiveStep.
+  void setupAndRunAdaptiveChains(std::vector<ChainState>& chains);
+
+  /// Take one step for every chain.  The proposals of all the chains are
+  /// propagated together.  If fillModel is true, then the model is filled
+  /// for the proposed points.
+  void stepAdaptiveChains(std::vector<ChainState>& chains, bool fillModel);
+
+  /// Replace the running covariance estimate of every chain by the
+  /// covariance of all the chains combined.
+  void adaptiveShareCovariance(std::vector<ChainState>& chains);
+
+  /// Calculate the Gelman-Rubin R-hat for each fit parameter, and return the
+  /// largest value.  Parameters that don't move are skipped (R-hat of zero).
+  double evalChainsRHat(const std::vector<ChainState>& chains,
+                        std::vector<double>& rHat) const;
 };
+template<typename MCMC> std::unique_ptr<AsyncTreeWriter> AdaptiveMcmc::makeTreeWriter(
+    MCMC& mcmc_, TTree* tree_, const std::vector<float>* saveModel_){
+  if (not _asyncOutput_ and _stepSaveStride_ <= 1 and not _saveRawStepsAsFloat_) return nullptr;
+
+  // The tree now only describes the branches.  The writer makes the tree
+  // that is saved in the current directory.
+  if (not _fileWriter_) _fileWriter_ = std::make_shared<AsyncFileWriter>(_outputQueueSize_);
+  auto writer = std::make_unique<AsyncTreeWriter>(tree_, _fileWriter_);
+  tree_->SetDirectory(nullptr);
+  writer->setStride(_stepSaveStride_);
+  if (_saveRawStepsAsFloat_) writer->setFloatBranchList({"Accepted", "Step"});
+  if (_stepSaveStride_ > 1) writer->setStatisticsBranch("Points");
+  writer->setStatisticsEnabled(false); // enabled after burn-in
+
+  AsyncTreeWriter* writerPtr = writer.get();
+  mcmc_.SetFillTree([writerPtr, saveModel_](bool forceSave){
+    writerPtr->fill(forceSave or not saveModel_->empty());
+  });
+  return writer;
+}
 #endif // GUNDAM_ADAPTIVE_MCMC_H
 
 //  A Lesser GNU Public License
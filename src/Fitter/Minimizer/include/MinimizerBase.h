@@ -194,6 +194,12 @@ protected:
   // validity without setting this to true.
   void setCheckParameterValidity(bool c) {_checkParameterValidity_ = c;}
 
+  /// Copy the fit space values in parArray_ to the minimizer parameters
+  /// without propagating them.  This returns false (and leaves the
+  /// parameters untouched) if the parameter validity is being checked and a
+  /// value is not valid.
+  bool setFitParameterValues( const double* parArray_ );
+
   // Query if a normalized fit space is being used.
   bool useNormalizedFitSpace() const {return _useNormalizedFitSpace_;}
   int* getNbFreeParametersPtr() {return &_nbFreeParameters_;}
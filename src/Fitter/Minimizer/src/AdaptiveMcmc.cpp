@@ -13,6 +13,8 @@
 #include "Logger.h"
 
 #include <locale>
+#include <sstream>
+#include <limits>
 
 #ifndef DISABLE_USER_HEADER
 LoggerInit([]{ Logger::setUserHeaderStr("[MCMC]"); });
@@ -50,6 +52,27 @@ void AdaptiveMcmc::configureImpl(){
   // into the likelihood space.
   GenericToolbox::Json::fillValue(_config_, _saveRawSteps_, "saveRawSteps");
 
+  // Write the output trees from a background thread so the chain doesn't
+  // wait for the compression and the disk.
+  GenericToolbox::Json::fillValue(_config_, _asyncOutput_, "asyncOutput");
+
+  // The number of steps that can wait to be written by the background
+  // thread before the chain has to wait.
+  GenericToolbox::Json::fillValue(_config_, _outputQueueSize_, "outputQueueSize");
+
+  // Thin the chain by only writing one step out of "stepSaveStride".  The
+  // steps at the end of the cycles (needed to restore the chain) and the
+  // steps with a saved model are always written.  The mean and covariance of
+  // the points are accumulated over all the steps (after burn-in) and saved
+  // as <mcmcOutputTree>_mean and <mcmcOutputTree>_covariance.
+  GenericToolbox::Json::fillValue(_config_, _stepSaveStride_, "stepSaveStride");
+  LogThrowIf(_stepSaveStride_ < 1, "Invalid stepSaveStride: " << _stepSaveStride_);
+
+  // Save the raw steps (see saveRawSteps) as floats.  A chain saved as
+  // floats can still be restored, but the restored likelihood will be
+  // slightly different than the saved one.
+  GenericToolbox::Json::fillValue(_config_, _saveRawStepsAsFloat_, "saveRawStepsAsFloat");
+
   // The number of steps between when the predicted sample histograms should
   // be saved into the output file.  The sample histograms can then be used
   // with the parameterSampleData vector to calculate the PPP for the chain.
@@ -79,6 +102,27 @@ void AdaptiveMcmc::configureImpl(){
   GenericToolbox::Json::fillValue(_config_, _cycles_, "cycles");
   GenericToolbox::Json::fillValue(_config_, _steps_, "steps");
 
+  // The number of chains to run together in this process.  The chains share
+  // the loaded events and each chain step propagates the proposals of all
+  // of the chains in a single pass over the events.  The chains are saved in
+  // separate trees named "<mcmcOutputTree>_chain<i>".  The chains should be
+  // started from different points (see randomStart) for the R-hat
+  // convergence test to be meaningful.
+  GenericToolbox::Json::fillValue(_config_, _nChains_, "nChains");
+  LogThrowIf(_nChains_ < 1, "Invalid number of MCMC chains: " << _nChains_);
+
+  // When several chains are run, combine the running covariance estimates
+  // of all chains before each update of the proposals.  This lets the chains
+  // learn the posterior correlations faster.  It stops when the correlations
+  // are frozen (see adaptiveFreezeCorrelations).
+  GenericToolbox::Json::fillValue(_config_, _shareChainCovariance_, "shareChainCovariance");
+
+  // When several chains are run, the Gelman-Rubin R-hat is calculated at the
+  // end of each cycle.  If it's below this threshold for every parameter,
+  // the remaining cycles are skipped.  The usual value would be about 1.01.
+  // Zero disables the early stop.
+  GenericToolbox::Json::fillValue(_config_, _rHatStopThreshold_, "rHatStopThreshold");
+
   ///////////////////////////////////////////////////////////////
   // Get parameters for the adaptive proposal.
 
@@ -162,6 +206,13 @@ void AdaptiveMcmc::configureImpl(){
   // covariance window).
   GenericToolbox::Json::fillValue(_config_, _adaptiveCovDeweighting_, "adaptiveCovDeweighting");
 
+  // Keep the decomposition of the proposal covariance in step with the
+  // running covariance (a rank-one update per step), and only recalculate
+  // it from scratch after this many steps.  Zero disables the incremental
+  // updates.
+  GenericToolbox::Json::fillValue(_config_, _adaptiveIncrementalRefactor_, "adaptiveIncrementalRefactor");
+  LogThrowIf(_adaptiveIncrementalRefactor_ < 0, "adaptiveIncrementalRefactor should not be negative.");
+
   // Stop updating the correlations between the steps after this many cycles.
   // If this is negative, the step size is never updated.  This freeze the
   // running covariance calculation.
@@ -240,6 +291,9 @@ bool AdaptiveMcmc::adaptiveRestoreState( AdaptiveStepMCMC& mcmc,
       .tolower(&tmp[0],&tmp[0]+tmp.size());
   if (tmp == "none") return false;
 
+  // The I/O thread must be idle while the main thread touches the files.
+  if (_fileWriter_) _fileWriter_->wait();
+
   // Open the file with the state.
   TFile* saveFile = gFile;
   std::unique_ptr<TFile> restoreFile
@@ -376,6 +430,8 @@ bool AdaptiveMcmc::adaptiveLoadProposalCovariance( AdaptiveStepMCMC& mcmc,
       .tolower(&tmp[0],&tmp[0]+tmp.size());
   if (tmp == "none") return false;
 
+  // The I/O thread must be idle while the main thread touches the files.
+  if (_fileWriter_) _fileWriter_->wait();
   TFile* saveFile = gFile;
   std::unique_ptr<TFile> restoreFile
       (new TFile(fileName.c_str(), "old"));
@@ -469,12 +525,7 @@ bool AdaptiveMcmc::adaptiveLoadProposalCovariance( AdaptiveStepMCMC& mcmc,
   return true;
 }
 
-void AdaptiveMcmc::setupAndRunAdaptiveStep( AdaptiveStepMCMC& mcmc) {
-
-  mcmc.GetProposeStep().SetDim(getMinimizerFitParameterPtr().size());
-  mcmc.GetLogLikelihood().functor = std::make_unique<ROOT::Math::Functor>(this, &AdaptiveMcmc::evalFitValid, getMinimizerFitParameterPtr().size());
-  mcmc.GetProposeStep().SetCovarianceUpdateDeweighting(0.0);
-  mcmc.GetProposeStep().SetCovarianceFrozen(false);
+sMCMC::Vector AdaptiveMcmc::adaptiveStartPoint( AdaptiveStepMCMC& mcmc) {
 
   // Create a fitting parameter vector and initialize it.  No need to worry
   // about resizing it or it moving, so be lazy and just use push_back.
@@ -539,6 +590,20 @@ void AdaptiveMcmc::setupAndRunAdaptiveStep( AdaptiveStepMCMC& mcmc) {
   StartStatus = mcmc.Start(prior, false);
   if (StartStatus!=true || prior.size()==0) LogThrow("The initial point is bad. MCMC chain cannot start.");
 
+  return prior;
+}
+
+void AdaptiveMcmc::setupAndRunAdaptiveStep( AdaptiveStepMCMC& mcmc) {
+
+  mcmc.GetProposeStep().SetDim(getMinimizerFitParameterPtr().size());
+  mcmc.GetLogLikelihood().functor = std::make_unique<ROOT::Math::Functor>(this, &AdaptiveMcmc::evalFitValid, getMinimizerFitParameterPtr().size());
+  mcmc.GetProposeStep().SetCovarianceUpdateDeweighting(0.0);
+  mcmc.GetProposeStep().SetCovarianceFrozen(false);
+  mcmc.GetProposeStep().SetIncrementalDecomposition(_adaptiveIncrementalRefactor_);
+
+  // Choose where the chain will start.
+  sMCMC::Vector prior = adaptiveStartPoint(mcmc);
+
   // Set the correlations in the default step proposal.
   if (not adaptiveLoadProposalCovariance(
       mcmc,prior,_adaptiveCovFile_,_adaptiveCovName_)) {;
@@ -643,6 +708,7 @@ void AdaptiveMcmc::setupAndRunAdaptiveStep( AdaptiveStepMCMC& mcmc) {
 
   ////////////////////////////////////////////////////////////////
   // Run the main cycles.
+  if (_treeWriter_) _treeWriter_->setStatisticsEnabled(true);
   mcmc.GetProposeStep().SetCovarianceWindow(_adaptiveCovWindow_);
   mcmc.GetProposeStep().SetAcceptanceWindow(_adaptiveWindow_);
   mcmc.SetStepRMSWindow(_adaptiveWindow_);
@@ -737,6 +803,356 @@ void AdaptiveMcmc::setupAndRunAdaptiveStep( AdaptiveStepMCMC& mcmc) {
   LogInfo << "Finished running chains" << std::endl;
 
 }
+void AdaptiveMcmc::setupAndRunAdaptiveChains( std::vector<ChainState>& chains) {
+
+  // Copy the last filled point (see fillPoint) as the accepted point of a
+  // chain.
+  auto copyFilledPoint = [&](ChainState& chain){
+    chain.point = _point_;
+    chain.model = _model_;
+    chain.uncertainty = _uncertainty_;
+    chain.llhStatistical = _llhStatistical_;
+    chain.llhPenalty = _llhPenalty_;
+  };
+
+  // Save the model every _modelStride_ trials (see setupAndRunAdaptiveStep).
+  auto fillSaveModel = [&](ChainState& chain){
+    chain.saveModel.clear();
+    chain.saveUncertainty.clear();
+    if (_modelStride_ < 1) return;
+    if (0 != (chain.mcmc->GetProposeStep().GetTrials()%_modelStride_)) return;
+    chain.saveModel = chain.model;
+    chain.saveUncertainty = chain.uncertainty;
+  };
+
+  // The R-hat of each cycle.  The tree is created before the chains start to
+  // write: the output file is then only touched by the I/O thread of the
+  // chains (when it is used), and the tree is written through it too.
+  std::string convergenceTreeName = _outTreeName_ + "Convergence";
+  auto* convergenceTree = new TTree(convergenceTreeName.c_str(),
+                                    "MCMC chains convergence");
+  int rHatCycle{0};
+  double maxRHat{0.0};
+  std::vector<double> rHat;
+  convergenceTree->Branch("Cycle", &rHatCycle);
+  convergenceTree->Branch("MaxRHat", &maxRHat);
+  convergenceTree->Branch("RHat", &rHat);
+  std::unique_ptr<AsyncTreeWriter> convergenceWriter{};
+  if (_fileWriter_) {
+    convergenceWriter = std::make_unique<AsyncTreeWriter>(convergenceTree, _fileWriter_);
+    convergenceTree->SetDirectory(nullptr);
+  }
+
+  // The chains share the burn-in, so they must all be restored, or none.
+  bool restored = true;
+  int nRestored = 0;
+  for (std::size_t iChain = 0; iChain < chains.size(); ++iChain) {
+    auto& mcmc = *chains[iChain].mcmc;
+    LogInfo << "Setting up chain " << iChain << std::endl;
+
+    mcmc.GetProposeStep().SetDim(getMinimizerFitParameterPtr().size());
+    mcmc.GetLogLikelihood().functor = std::make_unique<ROOT::Math::Functor>(this, &AdaptiveMcmc::evalFitValid, getMinimizerFitParameterPtr().size());
+    mcmc.GetProposeStep().SetCovarianceUpdateDeweighting(0.0);
+    mcmc.GetProposeStep().SetCovarianceFrozen(false);
+    mcmc.GetProposeStep().SetIncrementalDecomposition(_adaptiveIncrementalRefactor_);
+
+    sMCMC::Vector prior = adaptiveStartPoint(mcmc);
+
+    if (not adaptiveLoadProposalCovariance(
+        mcmc,prior,_adaptiveCovFile_,_adaptiveCovName_)) {
+      adaptiveDefaultProposalCovariance(mcmc,prior);
+    }
+
+    // Fill the initial point.
+    fillPoint();
+    copyFilledPoint(chains[iChain]);
+
+    mcmc.Start(prior, _saveBurnin_);
+    mcmc.GetProposeStep().SetAcceptanceWindow(_adaptiveWindow_);
+    mcmc.SetStepRMSWindow(_adaptiveWindow_);
+
+    // Each chain is restored from the tree with the same name.
+    std::string restorationTree = std::string("FitterEngine/fit/") + chains[iChain].tree->GetName();
+    bool chainRestored
+        = adaptiveRestoreState(mcmc,_adaptiveRestore_, restorationTree);
+    if (chainRestored) ++nRestored;
+    restored = restored and chainRestored;
+  }
+  LogThrowIf(nRestored > 0 and not restored,
+             "Only " << nRestored << " of the " << chains.size()
+             << " chains could be restored from " << _adaptiveRestore_);
+
+  if (not restored and _burninCycles_ > 0 and _burninLength_ > 0) {
+    // Burn-In cycles
+    for (auto& chain : chains) {
+      auto& propose = chain.mcmc->GetProposeStep();
+      propose.SetCovarianceWindow(_burninCovWindow_);
+      propose.SetAcceptanceWindow(_burninWindow_);
+      chain.mcmc->SetStepRMSWindow(_burninWindow_);
+      propose.SetCovarianceUpdateDeweighting(_burninCovDeweighting_);
+      propose.UpdateProposal();
+      propose.SetCovarianceFrozen(false);
+    }
+    for (int cycle = 0; cycle < _burninCycles_; ++cycle) {
+      LogInfo << "Start burn-In cycle " << cycle
+              << " for " << chains.size() << " chains" << std::endl;
+      for (auto& chain : chains) {
+        auto& propose = chain.mcmc->GetProposeStep();
+        propose.SetNextUpdate(2*_burninLength_*_burninCycles_);
+        propose.SetCovarianceUpdateDeweighting(_burninCovDeweighting_);
+        if (cycle < _burninFreezeAfter_) propose.SetAcceptanceRigidity(2.0);
+        else propose.SetAcceptanceRigidity(-1);
+      }
+      for (int i = 0; i < _burninLength_; ++i) {
+        stepAdaptiveChains(chains, false);
+        for (auto& chain : chains) {
+          fillSaveModel(chain);
+          if (_saveBurnin_) chain.mcmc->SaveStep(_burninLength_ <= (i+1));
+        }
+        if(_burninLength_ > 100 && !(i%(_burninLength_/100))){
+          std::stringstream ss;
+          ss << "Burn-in: " << cycle
+             << " step: " << i << "/" << _burninLength_ << " "
+             << i*100./_burninLength_ << "%";
+          for (auto& chain : chains) {
+            ss << " (acc " << chain.mcmc->GetProposeStep().GetAcceptance()
+               << ", sig " << chain.mcmc->GetProposeStep().GetSigma()
+               << ")";
+          }
+          LogInfo << ss.str() << std::endl;
+        }
+      }
+      // Update at the *END* of the burn-in cycle (see
+      // setupAndRunAdaptiveStep).
+      if (_shareChainCovariance_) adaptiveShareCovariance(chains);
+      for (auto& chain : chains) {
+        auto& propose = chain.mcmc->GetProposeStep();
+        propose.UpdateProposal();
+        if (cycle >= _burninResets_) continue;
+        sMCMC::Vector saveCenter{propose.GetEstimatedCenter()};
+        propose.ResetProposal();
+        if (_adaptiveCovTrials_ > 0) {
+          propose.SetCovarianceTrials(_adaptiveCovTrials_);
+          propose.SetEstimatedCenter(saveCenter);
+          propose.SetEstimatedCenterTrials(_adaptiveCovTrials_);
+        }
+      }
+    }
+    LogInfo << "Finished burn-in chains" << std::endl;
+  }
+
+  ////////////////////////////////////////////////////////////////
+  // Run the main cycles.  The R-hat statistic is calculated using all of
+  // the steps after burn-in, and is saved after each cycle.
+  for (auto& chain : chains) {
+    if (chain.writer) chain.writer->setStatisticsEnabled(true);
+    auto& propose = chain.mcmc->GetProposeStep();
+    propose.SetCovarianceWindow(_adaptiveCovWindow_);
+    propose.SetAcceptanceWindow(_adaptiveWindow_);
+    chain.mcmc->SetStepRMSWindow(_adaptiveWindow_);
+    propose.SetCovarianceUpdateDeweighting(_adaptiveCovDeweighting_);
+    chain.nSamples = 0;
+    chain.sampleMean.assign(getMinimizerFitParameterPtr().size(), 0.0);
+    chain.sampleSumSqDev.assign(getMinimizerFitParameterPtr().size(), 0.0);
+  }
+  for (int cycle = 0; cycle < _cycles_; ++cycle){
+    LogInfo << "Start run cycle " << cycle
+            << " for " << chains.size() << " chains" << std::endl;
+    if (_shareChainCovariance_ and cycle < _adaptiveFreezeCorrelations_) {
+      adaptiveShareCovariance(chains);
+    }
+    for (auto& chain : chains) {
+      auto& propose = chain.mcmc->GetProposeStep();
+      propose.UpdateProposal();
+      propose.SetCovarianceFrozen(cycle >= _adaptiveFreezeCorrelations_);
+      propose.SetNextUpdate(2*_steps_*_cycles_);
+      propose.SetCovarianceUpdateDeweighting(_adaptiveCovDeweighting_);
+      if (cycle < _adaptiveFreezeAfter_) propose.SetAcceptanceRigidity(2.0);
+      else propose.SetAcceptanceRigidity(-1);
+    }
+    for (int i = 0; i <= _steps_; ++i) {
+      stepAdaptiveChains(chains, true);
+      for (auto& chain : chains) {
+        // Update the running mean and variance of the chain.
+        const sMCMC::Vector& accepted = chain.mcmc->GetAccepted();
+        chain.nSamples += 1.0;
+        for (std::size_t iPar = 0; iPar < accepted.size(); ++iPar) {
+          double delta = accepted[iPar] - chain.sampleMean[iPar];
+          chain.sampleMean[iPar] += delta/chain.nSamples;
+          chain.sampleSumSqDev[iPar] += delta*(accepted[iPar] - chain.sampleMean[iPar]);
+        }
+        // The extra step at the end of the cycle saves the full state (see
+        // setupAndRunAdaptiveStep).
+        if (i < _steps_) {
+          if (not _saveRawSteps_) chain.mcmc->ClearSavedAccepted();
+          fillSaveModel(chain);
+          chain.mcmc->SaveStep(false);
+        }
+        else {
+          chain.saveModel.clear();
+          chain.saveUncertainty.clear();
+          chain.mcmc->SaveStep(true);
+        }
+      }
+      if(_steps_ > 100 && !(i%(_steps_/100))){
+        std::stringstream ss;
+        ss << "Cycle: " << cycle
+           << " step: " << i << "/" << _steps_ << " "
+           << i*100./_steps_ << "%";
+        for (auto& chain : chains) {
+          ss << " (acc " << chain.mcmc->GetProposeStep().GetAcceptance()
+             << ", sig " << chain.mcmc->GetProposeStep().GetSigma()
+             << ")";
+        }
+        LogInfo << ss.str() << std::endl;
+      }
+    }
+
+    rHatCycle = cycle;
+    maxRHat = evalChainsRHat(chains, rHat);
+    if (convergenceWriter) convergenceWriter->fill(true);
+    else convergenceTree->Fill();
+    LogInfo << "Cycle: " << cycle << " complete"
+            << " Run Length: " << _steps_
+            << " Max R-hat: " << maxRHat
+            << std::endl;
+    if (_rHatStopThreshold_ > 0.0 and maxRHat > 0.0
+        and maxRHat < _rHatStopThreshold_) {
+      LogWarning << "Chains converged (R-hat " << maxRHat << " < "
+                 << _rHatStopThreshold_ << "), skipping "
+                 << _cycles_ - cycle - 1 << " remaining cycles" << std::endl;
+      break;
+    }
+  }
+  if (convergenceWriter) {
+    convergenceWriter->close();
+    convergenceWriter.reset();
+    delete convergenceTree; // only described the branches
+  }
+  else convergenceTree->Write();
+  LogInfo << "Finished running chains" << std::endl;
+
+}
+void AdaptiveMcmc::stepAdaptiveChains( std::vector<ChainState>& chains,
+                                       bool fillModel) {
+
+  // Propose the next step for every chain.  The proposals that are not
+  // valid are rejected without being propagated.
+  std::vector<ChainState*> evalList;
+  std::vector<std::vector<double>> evalPoints;
+  evalList.reserve(chains.size());
+  evalPoints.reserve(chains.size());
+  for (auto& chain : chains) {
+    const sMCMC::Vector& proposed = chain.mcmc->Propose(false);
+    std::vector<double> x(proposed.begin(), proposed.end());
+    chain.proposedLogLikelihood = -std::numeric_limits<double>::infinity();
+    if (not setFitParameterValues(x.data())) continue;
+    evalList.emplace_back(&chain);
+    evalPoints.emplace_back(std::move(x));
+  }
+
+  getMonitor().evalLlhTimer.start();
+  getLikelihoodInterface().propagateAndEvalLikelihoodBatch(
+      int(evalList.size()),
+      [&](int iPoint_){ setFitParameterValues(evalPoints[iPoint_].data()); },
+      [&](int iPoint_){
+        auto& chain = *evalList[iPoint_];
+        if (not hasValidParameterValues()) return;
+        // See PrivateProxyLikelihood for the change of convention.
+        chain.proposedLogLikelihood = -0.5*getLikelihoodInterface().getLastLikelihood();
+        fillPoint(fillModel);
+        chain.proposedPoint = _point_;
+        chain.proposedModel = _model_;
+        chain.proposedUncertainty = _uncertainty_;
+        chain.proposedLlhStatistical = _llhStatistical_;
+        chain.proposedLlhPenalty = _llhPenalty_;
+      }
+  );
+  getMonitor().evalLlhTimer.stop();
+  getMonitor().nbEvalLikelihoodCalls += int(evalList.size());
+
+  for (auto& chain : chains) {
+    if (not chain.mcmc->Decide(chain.proposedLogLikelihood, false)) continue;
+    std::swap(chain.point, chain.proposedPoint);
+    std::swap(chain.model, chain.proposedModel);
+    std::swap(chain.uncertainty, chain.proposedUncertainty);
+    chain.llhStatistical = chain.proposedLlhStatistical;
+    chain.llhPenalty = chain.proposedLlhPenalty;
+  }
+}
+void AdaptiveMcmc::adaptiveShareCovariance( std::vector<ChainState>& chains) {
+
+  // The combined covariance is the trials weighted average of the chain
+  // covariances, plus the spread of the chain central points.
+  int dim = chains.front().mcmc->GetProposeStep().GetDim();
+  double totalTrials = 0.0;
+  std::vector<double> center(dim, 0.0);
+  for (auto& chain : chains) {
+    auto& propose = chain.mcmc->GetProposeStep();
+    double w = propose.GetCovarianceTrials();
+    totalTrials += w;
+    for (int i = 0; i < dim; ++i) center[i] += w*propose.GetEstimatedCenter()[i];
+  }
+  if (totalTrials <= 0.0) return;
+  for (auto& c : center) c /= totalTrials;
+
+  TMatrixD cov(dim, dim);
+  for (auto& chain : chains) {
+    auto& propose = chain.mcmc->GetProposeStep();
+    double w = propose.GetCovarianceTrials();
+    const sMCMC::Vector& chainCenter = propose.GetEstimatedCenter();
+    for (int i = 0; i < dim; ++i) {
+      for (int j = 0; j < dim; ++j) {
+        cov(i,j) += w*(propose.GetCovariance()(i,j)
+                       + (chainCenter[i]-center[i])*(chainCenter[j]-center[j]));
+      }
+    }
+  }
+  cov *= 1.0/totalTrials;
+
+  LogInfo << "Sharing the covariance of " << chains.size() << " chains"
+          << " (" << totalTrials << " trials)" << std::endl;
+  for (auto& chain : chains) {
+    auto& propose = chain.mcmc->GetProposeStep();
+    propose.SetCovariance(cov);
+    propose.SetCovarianceTrials(std::min(totalTrials, propose.GetCovarianceWindow()));
+  }
+}
+double AdaptiveMcmc::evalChainsRHat( const std::vector<ChainState>& chains,
+                                     std::vector<double>& rHat) const {
+
+  // The Gelman-Rubin potential scale reduction factor comparing the variance
+  // within each chain (W) to the variance between the chain means (B).
+  std::size_t dim = chains.front().sampleMean.size();
+  double m = chains.size();
+  double n = chains.front().nSamples;
+  rHat.assign(dim, 0.0);
+  if (m < 2 or n < 2) return 0.0;
+
+  double maxRHat = 0.0;
+  for (std::size_t iPar = 0; iPar < dim; ++iPar) {
+    double meanOfMeans = 0.0;
+    for (auto& chain : chains) meanOfMeans += chain.sampleMean[iPar];
+    meanOfMeans /= m;
+
+    double within = 0.0;
+    double betweenOverN = 0.0;
+    for (auto& chain : chains) {
+      within += chain.sampleSumSqDev[iPar]/(chain.nSamples-1.0);
+      double d = chain.sampleMean[iPar] - meanOfMeans;
+      betweenOverN += d*d;
+    }
+    within /= m;
+    betweenOverN /= m - 1.0;
+
+    // Skip the parameters that don't move.
+    if (not (within > 0.0)) continue;
+    double varEstimate = (n-1.0)/n*within + betweenOverN;
+    rHat[iPar] = std::sqrt(varEstimate/within);
+    maxRHat = std::max(maxRHat, rHat[iPar]);
+  }
+  return maxRHat;
+}
 void AdaptiveMcmc::setupAndRunSimpleStep( SimpleStepMCMC& mcmc) {
 
   mcmc.GetProposeStep().SetDim(getMinimizerFitParameterPtr().size());
@@ -774,6 +1190,7 @@ void AdaptiveMcmc::setupAndRunSimpleStep( SimpleStepMCMC& mcmc) {
   }
 
   // Run cycles
+  if (_treeWriter_) _treeWriter_->setStatisticsEnabled(true);
   for (int chain = 0; chain < _cycles_; ++chain){
     LogInfo << "Start Main Cycle " << chain << std::endl;
     // Update the covariance with the steps from the last cycle.  This
@@ -902,6 +1319,55 @@ void AdaptiveMcmc::minimize() {
   _point_.resize(parameterName.size());
   LogInfo << "Parameters in likelihood: " << _point_.size() << std::endl;
 
+  getMonitor().stateTitleMonitor = "Running MCMC chain...";
+  getMonitor().minimizerTitle = _algorithmName_ + "/" + _proposalName_;
+
+  // Run a chain.
+  int nbFitCallOffset = getMonitor().nbEvalLikelihoodCalls;
+  LogInfo << "Fit call offset: " << nbFitCallOffset << std::endl;
+
+  if (_nChains_ > 1) {
+    LogThrowIf(_proposalName_ != "adaptive",
+               "Several chains are only supported with the adaptive proposal");
+    LogInfo << "Running " << _nChains_ << " chains together" << std::endl;
+    LogAlertIf(not getLikelihoodInterface().getModelPropagator().isBatchPropagationSupported())
+        << "The propagator can't evaluate the chains in a single pass:"
+        << " the proposals of the chains will be propagated one by one."
+        << std::endl;
+
+    // Each chain gets its own output tree with the same branches as the
+    // single chain tree.  The vector must not be resized after this point.
+    std::vector<ChainState> chains(_nChains_);
+    for (int iChain = 0; iChain < _nChains_; ++iChain) {
+      auto& chain = chains[iChain];
+      std::string treeName = _outTreeName_ + "_chain" + std::to_string(iChain);
+      chain.point.resize(_point_.size());
+      chain.tree = new TTree(treeName.c_str(), "Tree of accepted points");
+      chain.tree->Branch("Points",&chain.point);
+      chain.tree->Branch("LLHPenalty",&chain.llhPenalty);
+      chain.tree->Branch("LLHStatistical",&chain.llhStatistical);
+      chain.tree->Branch("Models",&chain.saveModel);
+      chain.tree->Branch("ModelUncertainty",&chain.saveUncertainty);
+      chain.mcmc = std::make_unique<AdaptiveStepMCMC>(chain.tree);
+      chain.writer = makeTreeWriter(*chain.mcmc, chain.tree, &chain.saveModel);
+    }
+
+    setupAndRunAdaptiveChains(chains);
+
+    int nbMCMCCalls = getMonitor().nbEvalLikelihoodCalls - nbFitCallOffset;
+    LogInfo << "MCMC ended after " << nbMCMCCalls << " calls." << std::endl;
+
+    for (auto& chain : chains) {
+      if (not chain.writer) { chain.tree->Write(); continue; }
+      chain.writer->close();
+      chain.writer.reset();
+      delete chain.tree; // only described the branches
+    }
+    _fileWriter_.reset(); // stops the I/O thread
+    setMinimizerStatus(0);
+    return;
+  }
+
   // Create the output tree for the accepted points.
   auto *outputTree = new TTree(_outTreeName_.c_str(),
                                "Tree of accepted points");
@@ -911,20 +1377,15 @@ void AdaptiveMcmc::minimize() {
   outputTree->Branch("Models",&_saveModel_);
   outputTree->Branch("ModelUncertainty",&_saveUncertainty_);
 
-  getMonitor().stateTitleMonitor = "Running MCMC chain...";
-  getMonitor().minimizerTitle = _algorithmName_ + "/" + _proposalName_;
-
-  // Run a chain.
-  int nbFitCallOffset = getMonitor().nbEvalLikelihoodCalls;
-  LogInfo << "Fit call offset: " << nbFitCallOffset << std::endl;
-
   // Create the TSimpleMCMC object and call the specific runner.
   if (_proposalName_ == "adaptive") {
     sMCMC::TSimpleMCMC<PrivateProxyLikelihood,sMCMC::TProposeAdaptiveStep> mcmc(outputTree);
+    _treeWriter_ = makeTreeWriter(mcmc, outputTree, &_saveModel_);
     setupAndRunAdaptiveStep(mcmc);
   }
   else if (_proposalName_ == "simple") {
     sMCMC::TSimpleMCMC<PrivateProxyLikelihood,sMCMC::TProposeSimpleStep> mcmc(outputTree);
+    _treeWriter_ = makeTreeWriter(mcmc, outputTree, &_saveModel_);
     setupAndRunSimpleStep(mcmc);
   }
 
@@ -935,7 +1396,13 @@ void AdaptiveMcmc::minimize() {
   LogInfo << "MCMC ended after " << nbMCMCCalls << " calls." << std::endl;
 
   // Save the sampled points to the outputfile
-  outputTree->Write();
+  if (_treeWriter_) {
+    _treeWriter_->close();
+    _treeWriter_.reset();
+    _fileWriter_.reset(); // stops the I/O thread
+    delete outputTree; // only described the branches
+  }
+  else outputTree->Write();
 
   // success
   setMinimizerStatus(0);
@@ -130,14 +130,9 @@ void MinimizerBase::scanParameters(TDirectory* saveDir_){
   LogThrowIf( not isInitialized() );
   for( auto& parPtr : _minimizerParameterPtrList_ ) { getParameterScanner().scanParameter( *parPtr, saveDir_ ); }
 }
-double MinimizerBase::evalFit( const double* parArray_ ){
-/// The main access is through the evalFit method which takes an array of
-/// floating point values and returns the likelihood. The meaning of the
-/// parameters is defined by the vector of pointers to Parameter returned by
-/// the LikelihoodInterface.
-
-  _monitor_.externalTimer.stop();
-  _monitor_.evalLlhTimer.start();
+bool MinimizerBase::setFitParameterValues( const double* parArray_ ){
+/// Copy the fit space values into the parameters used by the minimizer.  This
+/// is the first half of evalFit.
 
   // Check the fit parameter values.  Do this first so that the parameters
   // don't change when a bad set of values is tried with evalFit.  This will
@@ -148,8 +143,7 @@ double MinimizerBase::evalFit( const double* parArray_ ){
       double val = *(v++);
       if (_useNormalizedFitSpace_) val = ParameterSet::toRealParValue(val,*par);
       if (par->isValidValue(val)) continue;
-      _monitor_.evalLlhTimer.stop();
-      return std::numeric_limits<double>::infinity();
+      return false;
     }
   }
 
@@ -168,6 +162,23 @@ double MinimizerBase::evalFit( const double* parArray_ ){
     }
   }
 
+  return true;
+}
+double MinimizerBase::evalFit( const double* parArray_ ){
+/// The main access is through the evalFit method which takes an array of
+/// floating point values and returns the likelihood. The meaning of the
+/// parameters is defined by the vector of pointers to Parameter returned by
+/// the LikelihoodInterface.
+
+  _monitor_.externalTimer.stop();
+  _monitor_.evalLlhTimer.start();
+
+  // Update the parameter values (unless a bad set of values is tried).
+  if( not this->setFitParameterValues( parArray_ ) ){
+    _monitor_.evalLlhTimer.stop();
+    return std::numeric_limits<double>::infinity();
+  }
+
   // Propagate the parameters
   getLikelihoodInterface().propagateAndEvalLikelihood();
   _monitor_.evalLlhTimer.stop();
@@ -7,6 +7,8 @@
 
 #include "Parameter.h"
 #include "ParameterThrowerMarkHarz.h"
+#include "CorrelatedThrowGenerator.h"
+#include "CovarianceBlocks.h"
 
 #include "Logger.h"
 #include "GenericToolbox.Root.h"
@@ -114,6 +116,12 @@ public:
 
   void updateDeltaVector() const;
 
+  /// The covariance penalty, delta^T C^-1 delta, of the stripped parameters.
+  /// The C^-1 delta vector is kept between the calls: when only a few
+  /// parameters have moved (e.g. the gradient evaluation of Migrad), it is
+  /// updated in O(n) per moved parameter instead of the O(n^2) product.
+  [[nodiscard]] double evalCovariancePenalty() const;
+
   /// Set all of the parameters to their prior values.
   void moveParametersToPrior();
 
@@ -181,6 +189,13 @@ protected:
   void readParameterDefinitionFile();
   void defineParameters();
 
+  /// The on-disk cache of the covariance decomposition (see
+  /// covarianceCacheDir).  The file name is a hash of the stripped covariance
+  /// matrix content.
+  [[nodiscard]] std::string getCovarianceCachePath() const;
+  bool readCovarianceCache();
+  void writeCovarianceCache() const;
+
   void setName(const std::string& name_){ _name_ = name_; }
 
 private:
@@ -208,6 +223,7 @@ private:
   std::string _parameterLowerBoundsTVectorD_{};
   std::string _parameterUpperBoundsTVectorD_{};
   std::string _throwEnabledListPath_{};
+  std::string _covarianceCacheDir_{};
   JsonType _parameterDefinitionConfig_{};
   JsonType _dialSetDefinitions_{};
 
@@ -230,7 +246,8 @@ private:
   bool _allowEigenDecompWithBounds_{false};
   bool _useOnlyOneParameterPerEvent_{false};
   std::vector<Parameter> _eigenParameterList_{};
-  std::shared_ptr<TMatrixDSymEigen> _eigenDecomp_{nullptr};
+  std::shared_ptr<TMatrixDSymEigen> _eigenDecomp_{nullptr}; // not set when read from cache
+  std::shared_ptr<TMatrixD> _cachedInverseMatrix_{nullptr};
 
   // internals
   std::vector<Parameter> _parameterList_;
@@ -253,6 +270,7 @@ private:
   std::shared_ptr<TMatrixDSym> _priorCorrelationMatrix_{nullptr};        // matrix coming from the file
   std::shared_ptr<TMatrixDSym> _strippedCovarianceMatrix_{nullptr};        // matrix stripped from fixed/freed parameters
   std::shared_ptr<TMatrixD>    _inverseStrippedCovarianceMatrix_{nullptr}; // inverse matrix used for chi2
+  CovarianceBlocks             _strippedCovarianceBlocks_{};               // independent blocks of the stripped matrix
 
   std::shared_ptr<TVectorD>  _parameterPriorList_{nullptr};
   std::shared_ptr<TVectorD>  _parameterLowerBoundsList_{nullptr};
@@ -261,8 +279,14 @@ private:
 
   std::shared_ptr<TVectorD>  _deltaVectorPtr_{nullptr}; // difference from prior
 
+  // covariance penalty cache (see evalCovariancePenalty)
+  mutable bool _isPenaltyCacheValid_{false};
+  mutable int _nbPenaltyIncrementalUpdates_{0};
+  mutable std::vector<double> _penaltyDeltaList_{};       // delta used for the current C^-1 delta
+  mutable std::vector<double> _penaltyInvCovDeltaList_{}; // C^-1 delta
+
   std::shared_ptr<TMatrixD> _choleskyMatrix_{nullptr};
-  GenericToolbox::CorrelatedVariablesSampler _correlatedVariableThrower_{};
+  std::shared_ptr<CorrelatedThrowGenerator> _throwGenerator_{nullptr};
   std::shared_ptr<ParameterThrowerMarkHarz> _markHartzGen_{nullptr};
 
 };
@@ -7,6 +7,7 @@
 
 #include "ParameterSet.h"
 #include "Parameter.h"
+#include "CorrelatedThrowGenerator.h"
 
 #include "TMatrixD.h"
 
@@ -40,12 +41,14 @@ public:
   // const core
   [[nodiscard]] std::string getParametersSummary( bool showEigen_ = true ) const;
   [[nodiscard]] JsonType exportParameterInjectorConfig() const;
+  [[nodiscard]] std::vector<double> exportParameterValues() const;
   [[nodiscard]] const ParameterSet* getFitParameterSetPtr(const std::string& name_) const;
 
   // core
   void moveParametersToPrior();
   void convertEigenToOrig();
   void injectParameterValues(const JsonType &config_);
+  void importParameterValues(const std::vector<double>& parameterValues_);
   void throwParameters();
   void throwParametersFromParSetCovariance();
   void throwParametersFromGlobalCovariance(bool quietVerbose_ = true);
@@ -89,7 +92,10 @@ private:
   std::vector<Parameter*> _strippedParameterList_{};
   std::shared_ptr<TMatrixD> _globalCovarianceMatrix_{nullptr};
   std::shared_ptr<TMatrixD> _strippedCovarianceMatrix_{nullptr};
-  std::shared_ptr<TMatrixD> _choleskyMatrix_{nullptr};
+  std::shared_ptr<CorrelatedThrowGenerator> _throwGenerator_{nullptr};
+  std::vector<double> _throwLowerBoundList_{}; // relative to the prior
+  std::vector<double> _throwUpperBoundList_{}; // relative to the prior
+  std::vector<double> _throwBuffer_{};
 
 };
 #endif //GUNDAM_PARAMETERS_MANAGER_H
@@ -7,14 +7,24 @@
 
 #include "GundamGlobals.h"
 #include "ParameterThrowerMarkHarz.h"
+#include "CovarianceBlocks.h"
 #include "ConfigUtils.h"
 
 #include "GenericToolbox.Root.h"
 
 #include "GenericToolbox.Utils.h"
+#include "GenericToolbox.Thread.h"
 #include "Logger.h"
 
+#include "TDecompChol.h"
+
 #include <memory>
+#include <algorithm>
+#include <cstdio>
+#include <cstdint>
+#include <sstream>
+#include <iomanip>
+#include <unistd.h>
 
 #ifndef DISABLE_USER_HEADER
 LoggerInit([]{ Logger::setUserHeaderStr("[ParameterSet]"); });
@@ -72,6 +82,7 @@ void ParameterSet::configureImpl(){
   GenericToolbox::Json::fillValue(_config_, _maxNbEigenParameters_, "maxNbEigenParameters");
   GenericToolbox::Json::fillValue(_config_, _maxEigenFraction_, "maxEigenFraction");
   GenericToolbox::Json::fillValue(_config_, _eigenSvdThreshold_, "eigenSvdThreshold");
+  GenericToolbox::Json::fillValue(_config_, _covarianceCacheDir_, "covarianceCacheDir");
 
   GenericToolbox::Json::fillValue(_config_, _eigenParRange_.min, "eigenParBounds/minValue");
   GenericToolbox::Json::fillValue(_config_, _eigenParRange_.max, "eigenParBounds/maxValue");
@@ -136,6 +147,116 @@ void ParameterSet::initializeImpl() {
 void ParameterSet::muteLogger(){ Logger::setIsMuted(true ); }
 void ParameterSet::unmuteLogger(){ Logger::setIsMuted(false ); }
 
+namespace {
+  // FNV-1a hash of the matrix content, used to name the cache files
+  uint64_t hashCovarianceMatrix(const TMatrixDSym& covariance_, bool isEigenDecomp_){
+    uint64_t hash{14695981039346656037ULL};
+    auto addBytes = [&](const void* data_, size_t size_){
+      auto* bytes = static_cast<const unsigned char*>(data_);
+      for( size_t iByte = 0 ; iByte < size_ ; iByte++ ){ hash ^= bytes[iByte]; hash *= 1099511628211ULL; }
+    };
+    int nRows{covariance_.GetNrows()};
+    addBytes(&nRows, sizeof(nRows));
+    addBytes(&isEigenDecomp_, sizeof(isEigenDecomp_));
+    addBytes(covariance_.GetMatrixArray(), sizeof(double) * covariance_.GetNoElements());
+    return hash;
+  }
+
+  // out_ = V * diag(scales_) * V^T.  Only the columns with a non-zero scale
+  // are used, the result is symmetric so only the lower triangle is computed.
+  // If all the vectors are local to one of the independent blocks, the
+  // product is done block by block.  The rows are interleaved between the
+  // threads to balance the triangle.
+  void fillScaledOuterProduct(const TMatrixD& vectors_, const std::vector<double>& scales_, TMatrixD& out_, const CovarianceBlocks* blocks_ = nullptr){
+    const int nRows{vectors_.GetNrows()};
+    const int nVectors{vectors_.GetNcols()};
+    const double* vectorArray{vectors_.GetMatrixArray()};
+
+    struct Group{
+      std::vector<int> rowList{};
+      std::vector<int> columnList{};
+      std::vector<double> packedList{};       // [iRow*nCols + iCol]
+      std::vector<double> scaledPackedList{};
+    };
+    std::vector<Group> groupList(1);
+
+    if( blocks_ != nullptr and blocks_->getNbBlocks() > 1 ){
+      groupList.resize(blocks_->getNbBlocks());
+      for( int iBlock = 0 ; iBlock < blocks_->getNbBlocks() ; iBlock++ ){ groupList[iBlock].rowList = blocks_->getBlock(iBlock); }
+
+      // the block of a vector is the one of its largest component
+      for( int iCol = 0 ; iCol < nVectors and not groupList.empty() ; iCol++ ){
+        if( scales_[iCol] == 0 ){ continue; }
+        int maxRow{0};
+        for( int iRow = 0 ; iRow < nRows ; iRow++ ){
+          if( std::abs(vectorArray[size_t(iRow) * nVectors + iCol]) > std::abs(vectorArray[size_t(maxRow) * nVectors + iCol]) ){ maxRow = iRow; }
+        }
+        int iBlock{blocks_->getBlockIndex(maxRow)};
+        for( int iRow = 0 ; iRow < nRows ; iRow++ ){
+          if( blocks_->getBlockIndex(iRow) != iBlock and vectorArray[size_t(iRow) * nVectors + iCol] != 0 ){
+            groupList.clear(); // not a block decomposition
+            break;
+          }
+        }
+        if( not groupList.empty() ){ groupList[iBlock].columnList.emplace_back(iCol); }
+      }
+    }
+
+    if( groupList.size() <= 1 ){
+      groupList.assign(1, Group());
+      groupList[0].rowList.resize(nRows);
+      for( int iRow = 0 ; iRow < nRows ; iRow++ ){ groupList[0].rowList[iRow] = iRow; }
+      for( int iCol = 0 ; iCol < nVectors ; iCol++ ){
+        if( scales_[iCol] != 0 ){ groupList[0].columnList.emplace_back(iCol); }
+      }
+    }
+
+    // packed rows of the selected columns
+    for( auto& group : groupList ){
+      size_t nCols{group.columnList.size()};
+      group.packedList.resize(group.rowList.size() * nCols);
+      group.scaledPackedList.resize(group.rowList.size() * nCols);
+      for( size_t iRow = 0 ; iRow < group.rowList.size() ; iRow++ ){
+        const double* row{vectorArray + size_t(group.rowList[iRow]) * nVectors};
+        for( size_t iCol = 0 ; iCol < nCols ; iCol++ ){
+          group.packedList[iRow * nCols + iCol] = row[group.columnList[iCol]];
+          group.scaledPackedList[iRow * nCols + iCol] = row[group.columnList[iCol]] * scales_[group.columnList[iCol]];
+        }
+      }
+    }
+
+    out_.ResizeTo(nRows, nRows);
+    out_.Zero();
+    double* outArray{out_.GetMatrixArray()};
+    const int nThreads{GundamGlobals::getNbCpuThreads()};
+
+    GenericToolbox::ParallelWorker threadPool;
+    threadPool.setNThreads(nThreads);
+    threadPool.initialize();
+    threadPool.addJob("fillScaledOuterProduct", [&](int iThread_){
+      int iStart{0}; int iStep{1};
+      if( iThread_ != -1 ){ iStart = iThread_; iStep = nThreads; }
+      for( auto& group : groupList ){
+        const int nGroupRows{int(group.rowList.size())};
+        const size_t nCols{group.columnList.size()};
+        for( int iRow = iStart ; iRow < nGroupRows ; iRow += iStep ){
+          const double* scaledRow{&group.scaledPackedList[size_t(iRow) * nCols]};
+          for( int jRow = 0 ; jRow <= iRow ; jRow++ ){
+            const double* row{&group.packedList[size_t(jRow) * nCols]};
+            double sum{0};
+            for( size_t iCol = 0 ; iCol < nCols ; iCol++ ){ sum += scaledRow[iCol] * row[iCol]; }
+            outArray[size_t(group.rowList[iRow]) * nRows + group.rowList[jRow]] = sum;
+            outArray[size_t(group.rowList[jRow]) * nRows + group.rowList[iRow]] = sum;
+          }
+        }
+      }
+    });
+    threadPool.runJob("fillScaledOuterProduct");
+    threadPool.removeJob("fillScaledOuterProduct");
+  }
+  }
+}
+
 // Post-init
 void ParameterSet::processCovarianceMatrix(){
 
@@ -189,27 +310,86 @@ void ParameterSet::processCovarianceMatrix(){
     }
   }
   _deltaVectorPtr_ = std::make_shared<TVectorD>(_strippedCovarianceMatrix_->GetNrows());
+  _isPenaltyCacheValid_ = false;
 
   LogThrowIf(not _strippedCovarianceMatrix_->IsSymmetric(), "Covariance matrix is not symmetric");
 
+  // the inverse and the eigen decomposition are done block by block
+  _strippedCovarianceBlocks_.build(*_strippedCovarianceMatrix_);
+  LogInfo << "Stripped covariance matrix: " << _strippedCovarianceBlocks_.getSummary() << std::endl;
+
   if( not isEnableEigenDecomp() ){
     LogWarning << "Computing inverse of the stripped covariance matrix: "
                << _strippedCovarianceMatrix_->GetNcols() << "x"
                << _strippedCovarianceMatrix_->GetNrows() << std::endl;
-    _inverseStrippedCovarianceMatrix_ = std::shared_ptr<TMatrixD>((TMatrixD*)(_strippedCovarianceMatrix_->Clone()));
-    _inverseStrippedCovarianceMatrix_->Invert();
+    if( not this->readCovarianceCache() ){
+      // the inverse of a block diagonal matrix is block diagonal
+      _inverseStrippedCovarianceMatrix_ = std::make_shared<TMatrixD>(_strippedCovarianceMatrix_->GetNrows(), _strippedCovarianceMatrix_->GetNrows());
+      for( int iBlock = 0 ; iBlock < _strippedCovarianceBlocks_.getNbBlocks() ; iBlock++ ){
+        auto& block = _strippedCovarianceBlocks_.getBlock(iBlock);
+        TMatrixDSym subMatrix{_strippedCovarianceBlocks_.getSubMatrix(*_strippedCovarianceMatrix_, iBlock)};
+
+        // the covariance should be positive definite: Cholesky is faster and
+        // more stable than the general LU inversion
+        TDecompChol choleskyDecomp(subMatrix);
+        if( choleskyDecomp.Decompose() ){
+          choleskyDecomp.Invert(subMatrix);
+        }
+        else{
+          LogAlert << "Cholesky decomposition failed, using the LU inversion." << std::endl;
+          subMatrix.Invert();
+        }
+
+        for( size_t iSub = 0 ; iSub < block.size() ; iSub++ ){
+          for( size_t jSub = 0 ; jSub < block.size() ; jSub++ ){
+            (*_inverseStrippedCovarianceMatrix_)[block[iSub]][block[jSub]] = subMatrix[int(iSub)][int(jSub)];
+          }
+        }
+      }
+      this->writeCovarianceCache();
+    }
   }
   else {
     LogWarning << "Decomposing the stripped covariance matrix..." << std::endl;
     _eigenParameterList_.resize(_strippedCovarianceMatrix_->GetNrows(), Parameter(this));
 
-    LogAlertIf(_strippedCovarianceMatrix_->GetNrows() > 1000) << "Decomposing matrix with " << _strippedCovarianceMatrix_->GetNrows() << " dim might take a while..." << std::endl;
-    _eigenDecomp_     = std::make_shared<TMatrixDSymEigen>(*_strippedCovarianceMatrix_);
+    bool isFromCache{this->readCovarianceCache()};
+    if( not isFromCache ){
+      LogAlertIf(_strippedCovarianceBlocks_.getLargestBlockSize() > 1000) << "Decomposing matrix with " << _strippedCovarianceBlocks_.getLargestBlockSize() << " dim might take a while..." << std::endl;
+      if( _strippedCovarianceBlocks_.getNbBlocks() == 1 ){
+        _eigenDecomp_     = std::make_shared<TMatrixDSymEigen>(*_strippedCovarianceMatrix_);
 
-    // Used for base swapping
-    _eigenValues_     = std::shared_ptr<TVectorD>( (TVectorD*) _eigenDecomp_->GetEigenValues().Clone() );
-    _eigenValuesInv_  = std::shared_ptr<TVectorD>( (TVectorD*) _eigenDecomp_->GetEigenValues().Clone() );
-    _eigenVectors_    = std::shared_ptr<TMatrixD>( (TMatrixD*) _eigenDecomp_->GetEigenVectors().Clone() );
+        // Used for base swapping
+        _eigenValues_     = std::shared_ptr<TVectorD>( (TVectorD*) _eigenDecomp_->GetEigenValues().Clone() );
+        _eigenVectors_    = std::shared_ptr<TMatrixD>( (TMatrixD*) _eigenDecomp_->GetEigenVectors().Clone() );
+      }
+      else{
+        // decompose each block, then merge the eigen values in decreasing order
+        struct EigenEntry{ double value; int block; int column; };
+        std::vector<EigenEntry> eigenEntryList;
+        std::vector<TMatrixD> blockVectorList;
+        for( int iBlock = 0 ; iBlock < _strippedCovarianceBlocks_.getNbBlocks() ; iBlock++ ){
+          TMatrixDSymEigen blockDecomp(_strippedCovarianceBlocks_.getSubMatrix(*_strippedCovarianceMatrix_, iBlock));
+          blockVectorList.emplace_back( blockDecomp.GetEigenVectors() );
+          for( int iEigen = 0 ; iEigen < blockDecomp.GetEigenValues().GetNrows() ; iEigen++ ){
+            eigenEntryList.push_back({blockDecomp.GetEigenValues()[iEigen], iBlock, iEigen});
+          }
+        }
+        std::stable_sort(eigenEntryList.begin(), eigenEntryList.end(), [](const EigenEntry& a_, const EigenEntry& b_){ return a_.value > b_.value; });
+
+        _eigenValues_  = std::make_shared<TVectorD>(_strippedCovarianceMatrix_->GetNrows());
+        _eigenVectors_ = std::make_shared<TMatrixD>(_strippedCovarianceMatrix_->GetNrows(), _strippedCovarianceMatrix_->GetNrows());
+        for( int iEigen = 0 ; iEigen < int(eigenEntryList.size()) ; iEigen++ ){
+          auto& entry = eigenEntryList[iEigen];
+          auto& block = _strippedCovarianceBlocks_.getBlock(entry.block);
+          (*_eigenValues_)[iEigen] = entry.value;
+          for( size_t iSub = 0 ; iSub < block.size() ; iSub++ ){
+            (*_eigenVectors_)[block[iSub]][iEigen] = blockVectorList[entry.block][int(iSub)][entry.column];
+          }
+        }
+      }
+    }
+    _eigenValuesInv_  = std::shared_ptr<TVectorD>( (TVectorD*) _eigenValues_->Clone() );
     _eigenVectorsInv_ = std::make_shared<TMatrixD>(TMatrixD::kTransposed, *_eigenVectors_ );
 
     _nbEnabledEigen_ = 0;
@@ -226,7 +406,7 @@ void ParameterSet::processCovarianceMatrix(){
     _inverseStrippedCovarianceMatrix_ = std::make_shared<TMatrixD>(_strippedCovarianceMatrix_->GetNrows(), _strippedCovarianceMatrix_->GetNrows());
     _projectorMatrix_                 = std::make_shared<TMatrixD>(_strippedCovarianceMatrix_->GetNrows(), _strippedCovarianceMatrix_->GetNrows());
 
-    auto* eigenState = new TVectorD(_eigenValues_->GetNrows());
+    std::vector<double> eigenState(_eigenValues_->GetNrows(), 0);
 
     for (int iEigen = 0; iEigen < _eigenValues_->GetNrows(); iEigen++) {
 
@@ -239,7 +419,7 @@ void ParameterSet::processCovarianceMatrix(){
 
       // fixing all of them by default
       _eigenParameterList_[iEigen].setIsFixed(true);
-      (*eigenState)[iEigen] = 0;
+      eigenState[iEigen] = 0;
       (*_eigenValuesInv_)[iEigen] = 1./(*_eigenValues_)[iEigen];
 
     }
@@ -266,26 +446,30 @@ void ParameterSet::processCovarianceMatrix(){
 
       // if we reach this point, the eigen value is accepted
       _eigenParameterList_[iEigen].setIsFixed( false );
-      (*eigenState)[iEigen] = 1.;
+      eigenState[iEigen] = 1.;
       eigenCumulative += (*_eigenValues_)[iEigen];
       _nbEnabledEigen_++;
 
     } // iEigen
 
-    TMatrixD* eigenStateMatrix    = GenericToolbox::makeDiagonalMatrix(eigenState);
-    TMatrixD* diagInvMatrix = GenericToolbox::makeDiagonalMatrix(_eigenValuesInv_.get());
-
-    (*_projectorMatrix_) =  (*_eigenVectors_);
-    (*_projectorMatrix_) *= (*eigenStateMatrix);
-    (*_projectorMatrix_) *= (*_eigenVectorsInv_);
-
-    (*_inverseStrippedCovarianceMatrix_) =  (*_eigenVectors_);
-    (*_inverseStrippedCovarianceMatrix_) *= (*diagInvMatrix);
-    (*_inverseStrippedCovarianceMatrix_) *= (*_eigenVectorsInv_);
+    // P = V * diag(state) * V^T, only the enabled eigen vectors contribute
+    fillScaledOuterProduct(*_eigenVectors_, eigenState, *_projectorMatrix_, &_strippedCovarianceBlocks_);
 
-    delete eigenState;
-    delete eigenStateMatrix;
-    delete diagInvMatrix;
+    if( isFromCache ){
+      // the inverse has been read with the eigen decomposition
+      (*_inverseStrippedCovarianceMatrix_) = (*_cachedInverseMatrix_);
+      _cachedInverseMatrix_ = nullptr;
+    }
+    else{
+      // C^-1 = V * diag(1/lambda) * V^T
+      fillScaledOuterProduct(
+          *_eigenVectors_,
+          std::vector<double>(_eigenValuesInv_->GetMatrixArray(), _eigenValuesInv_->GetMatrixArray() + _eigenValuesInv_->GetNrows()),
+          *_inverseStrippedCovarianceMatrix_,
+          &_strippedCovarianceBlocks_
+      );
+      this->writeCovarianceCache();
+    }
 
     LogWarning << "Eigen decomposition with " << _nbEnabledEigen_ << " / " << _eigenValues_->GetNrows() << " vectors" << std::endl;
     if(_nbEnabledEigen_ != _eigenValues_->GetNrows() ){
@@ -368,6 +552,70 @@ void ParameterSet::updateDeltaVector() const{
   }
 }
 
+double ParameterSet::evalCovariancePenalty() const{
+  // the incremental updates accumulate rounding errors, so C^-1 delta is
+  // recomputed from scratch after this many of them
+  static const int nMaxIncrementalUpdates{100};
+
+  this->updateDeltaVector();
+
+  const int nPars{_deltaVectorPtr_->GetNrows()};
+  const double* delta{_deltaVectorPtr_->GetMatrixArray()};
+  const double* invCov{_inverseStrippedCovarianceMatrix_->GetMatrixArray()};
+
+  if( int(_penaltyDeltaList_.size()) != nPars ){
+    _penaltyDeltaList_.resize(nPars);
+    _penaltyInvCovDeltaList_.resize(nPars);
+    _isPenaltyCacheValid_ = false;
+  }
+
+  // the incremental update costs n per moved parameter
+  int nMoved{0};
+  if( _isPenaltyCacheValid_ and _nbPenaltyIncrementalUpdates_ < nMaxIncrementalUpdates ){
+    for( int iPar = 0 ; iPar < nPars ; iPar++ ){
+      if( delta[iPar] != _penaltyDeltaList_[iPar] ){ nMoved++; }
+    }
+  }
+  else{
+    nMoved = nPars;
+  }
+
+  if( nMoved == 0 ){
+    // nothing to do
+  }
+  else if( 4 * nMoved < nPars ){
+    // C^-1 is symmetric: the column of a parameter is read from its (contiguous)
+    // row, and it is only non-zero within the parameter block
+    for( int iPar = 0 ; iPar < nPars ; iPar++ ){
+      double step{delta[iPar] - _penaltyDeltaList_[iPar]};
+      if( step == 0 ){ continue; }
+      const double* row{invCov + size_t(iPar) * nPars};
+      for( int jPar : _strippedCovarianceBlocks_.getBlock(_strippedCovarianceBlocks_.getBlockIndex(iPar)) ){
+        _penaltyInvCovDeltaList_[jPar] += row[jPar] * step;
+      }
+      _penaltyDeltaList_[iPar] = delta[iPar];
+    }
+    _nbPenaltyIncrementalUpdates_++;
+  }
+  else{
+    for( auto& block : _strippedCovarianceBlocks_.getBlockList() ){
+      for( int iPar : block ){
+        const double* row{invCov + size_t(iPar) * nPars};
+        double sum{0};
+        for( int jPar : block ){ sum += row[jPar] * delta[jPar]; }
+        _penaltyInvCovDeltaList_[iPar] = sum;
+        _penaltyDeltaList_[iPar] = delta[iPar];
+      }
+    }
+    _nbPenaltyIncrementalUpdates_ = 0;
+    _isPenaltyCacheValid_ = true;
+  }
+
+  double penalty{0};
+  for( int iPar = 0 ; iPar < nPars ; iPar++ ){ penalty += delta[iPar] * _penaltyInvCovDeltaList_[iPar]; }
+  return penalty;
+}
+
 void ParameterSet::setValidity(const std::string& validity) {
   for (Parameter& par : getParameterList()) {
     par.setValidity(validity);
@@ -574,13 +822,14 @@ void ParameterSet::throwParameters(bool rethrowIfNotInPhysical_, double gain_){
   else {
       LogInfo << "Throwing parameters for " << _name_ << " using Cholesky matrix" << std::endl;
 
-      if( not _correlatedVariableThrower_.isInitialized() ){
-        _correlatedVariableThrower_.setCovarianceMatrixPtr(_strippedCovarianceMatrix_.get());
-        _correlatedVariableThrower_.initialize();
+      if( _throwGenerator_ == nullptr ){
+        _throwGenerator_ = std::make_shared<CorrelatedThrowGenerator>( *_strippedCovarianceMatrix_ );
       }
 
       std::function<void()> gundamThrowFct = [&](){
-        _correlatedVariableThrower_.throwCorrelatedVariables(throwsList);
+        std::vector<double> throws{};
+        _throwGenerator_->throwBlock( 1, throws );
+        for( int iPar = 0 ; iPar < throwsList.GetNrows() ; iPar++ ){ throwsList[iPar] = throws[iPar]; }
       };
 
       throwParsFct( gundamThrowFct );
@@ -843,6 +1092,79 @@ void ParameterSet::printConfiguration() const {
 
 
 // Protected
+std::string ParameterSet::getCovarianceCachePath() const{
+  if( _covarianceCacheDir_.empty() ){ return {}; }
+  std::stringstream ss;
+  ss << "covarianceDecomposition_" << std::hex << std::setw(16) << std::setfill('0')
+     << hashCovarianceMatrix(*_strippedCovarianceMatrix_, isEnableEigenDecomp()) << ".root";
+  return GenericToolbox::joinPath(GenericToolbox::expandEnvironmentVariables(_covarianceCacheDir_), ss.str());
+}
+bool ParameterSet::readCovarianceCache(){
+  std::string path{this->getCovarianceCachePath()};
+  if( path.empty() or not GenericToolbox::isFile(path) ){ return false; }
+
+  std::unique_ptr<TFile> cacheFile(TFile::Open(path.c_str()));
+  if( cacheFile == nullptr or not cacheFile->IsOpen() ){
+    LogAlert << "Could not open the covariance cache: " << path << std::endl;
+    return false;
+  }
+
+  // the hash is only used to find the file: check the content as well.
+  // The objects read from the file are owned by the caller.
+  std::unique_ptr<TMatrixDSym> covariance(cacheFile->Get<TMatrixDSym>("covariance"));
+  std::unique_ptr<TMatrixD> inverse(cacheFile->Get<TMatrixD>("inverse"));
+  if( covariance == nullptr or inverse == nullptr or not (*covariance == *_strippedCovarianceMatrix_) ){
+    LogAlert << "Covariance cache doesn't match the covariance matrix: " << path << std::endl;
+    return false;
+  }
+
+  if( isEnableEigenDecomp() ){
+    std::unique_ptr<TVectorD> eigenValues(cacheFile->Get<TVectorD>("eigenValues"));
+    std::unique_ptr<TMatrixD> eigenVectors(cacheFile->Get<TMatrixD>("eigenVectors"));
+    if( eigenValues == nullptr or eigenVectors == nullptr ){
+      LogAlert << "Covariance cache has no eigen decomposition: " << path << std::endl;
+      return false;
+    }
+    _eigenValues_ = std::move(eigenValues);
+    _eigenVectors_ = std::move(eigenVectors);
+    _cachedInverseMatrix_ = std::move(inverse);
+  }
+  else{
+    _inverseStrippedCovarianceMatrix_ = std::move(inverse);
+  }
+
+  LogInfo << "Covariance decomposition read from cache: " << path << std::endl;
+  return true;
+}
+void ParameterSet::writeCovarianceCache() const{
+  std::string path{this->getCovarianceCachePath()};
+  if( path.empty() ){ return; }
+
+  GenericToolbox::mkdir( GenericToolbox::getFolderPath( path ) );
+
+  // write to a temporary file first, so jobs running in parallel never read
+  // an incomplete cache
+  std::string tmpPath{path + ".tmp" + std::to_string(getpid())};
+  std::unique_ptr<TFile> cacheFile(TFile::Open(tmpPath.c_str(), "RECREATE"));
+  if( cacheFile == nullptr or not cacheFile->IsOpen() ){
+    LogAlert << "Could not write the covariance cache: " << path << std::endl;
+    return;
+  }
+  cacheFile->WriteObject(_strippedCovarianceMatrix_.get(), "covariance");
+  cacheFile->WriteObject(_inverseStrippedCovarianceMatrix_.get(), "inverse");
+  if( isEnableEigenDecomp() ){
+    cacheFile->WriteObject(_eigenValues_.get(), "eigenValues");
+    cacheFile->WriteObject(_eigenVectors_.get(), "eigenVectors");
+  }
+  cacheFile->Close();
+
+  if( std::rename(tmpPath.c_str(), path.c_str()) != 0 ){
+    LogAlert << "Could not move the covariance cache to: " << path << std::endl;
+    std::remove(tmpPath.c_str());
+    return;
+  }
+  LogInfo << "Covariance decomposition written in cache: " << path << std::endl;
+}
 void ParameterSet::readParameterDefinitionFile(){
 
   TObject* objBuffer{nullptr};
@@ -5,12 +5,15 @@
 #include "ParametersManager.h"
 #include "ConfigUtils.h"
 #include "GundamGlobals.h"
+#include "CovarianceBlocks.h"
 
 #include "GenericToolbox.Utils.h"
 
 #include "Logger.h"
 
 #include <sstream>
+#include <limits>
+#include <cmath>
 
 
 #ifndef DISABLE_USER_HEADER
@@ -133,6 +136,18 @@ JsonType ParametersManager::exportParameterInjectorConfig() const{
 
   return out;
 }
+std::vector<double> ParametersManager::exportParameterValues() const{
+  // flat snapshot of every parameter value (original + eigen) of the enabled sets,
+  // cheap enough to be used in loops where exportParameterInjectorConfig() is not
+  std::vector<double> out{};
+  for( auto& parSet : _parameterSetList_ ){
+    if( not parSet.isEnabled() ){ continue; }
+    for( auto& par : parSet.getParameterList() ){ out.emplace_back( par.getParameterValue() ); }
+    if( not parSet.isEnableEigenDecomp() ){ continue; }
+    for( auto& eigenPar : parSet.getEigenParameterList() ){ out.emplace_back( eigenPar.getParameterValue() ); }
+  }
+  return out;
+}
 const ParameterSet* ParametersManager::getFitParameterSetPtr(const std::string& name_) const{
   for( auto& parSet : _parameterSetList_ ){
     if( parSet.getName() == name_ ) return &parSet;
@@ -179,22 +194,26 @@ void ParametersManager::initializeStrippedGlobalCov(){
   LogThrowIf( _globalCovarianceMatrix_ == nullptr, "Global covariance matrix not set." );
 
   _strippedParameterList_.clear();
+  std::vector<int> globalIndexList{};
   for( int iGlobPar = 0 ; iGlobPar < _globalCovarianceMatrix_->GetNrows() ; iGlobPar++ ){
     if( _globalCovParList_[iGlobPar]->isFixed() ){ continue; }
     if( _globalCovParList_[iGlobPar]->isFree() and (*_globalCovarianceMatrix_)[iGlobPar][iGlobPar] == 0 ){ continue; }
     _strippedParameterList_.emplace_back( _globalCovParList_[iGlobPar] );
+    globalIndexList.emplace_back( iGlobPar );
   }
+  _throwGenerator_ = nullptr; // the factorisation is now outdated
 
   int nStripped{int(_strippedParameterList_.size())};
   _strippedCovarianceMatrix_ = std::make_shared<TMatrixD>(nStripped, nStripped);
 
   for( int iStrippedPar = 0 ; iStrippedPar < nStripped ; iStrippedPar++ ){
-    int iGlobPar{GenericToolbox::findElementIndex(_strippedParameterList_[iStrippedPar], _globalCovParList_)};
+    int iGlobPar{globalIndexList[iStrippedPar]};
     for( int jStrippedPar = 0 ; jStrippedPar < nStripped ; jStrippedPar++ ){
-      int jGlobPar{GenericToolbox::findElementIndex(_strippedParameterList_[jStrippedPar], _globalCovParList_)};
+      int jGlobPar{globalIndexList[jStrippedPar]};
       (*_strippedCovarianceMatrix_)[iStrippedPar][jStrippedPar] = (*_globalCovarianceMatrix_)[iGlobPar][jGlobPar];
     }
   }
+  LogInfo << "Stripped global covariance matrix: " << CovarianceBlocks(*_strippedCovarianceMatrix_).getSummary() << std::endl;
 }
 void ParametersManager::throwParametersFromGlobalCovariance(bool quietVerbose_){
 
@@ -212,50 +231,42 @@ void ParametersManager::throwParametersFromGlobalCovariance(bool quietVerbose_){
     Logger::setIsMuted(quietVerbose_);
   }
 
-  if( _choleskyMatrix_ == nullptr ){
+  if( _throwGenerator_ == nullptr ){
     LogInfo << "Generating global cholesky matrix" << std::endl;
-    _choleskyMatrix_ = std::shared_ptr<TMatrixD>(
-        GenericToolbox::getCholeskyMatrix(_strippedCovarianceMatrix_.get())
-    );
-  }
+    _throwGenerator_ = std::make_shared<CorrelatedThrowGenerator>( *_strippedCovarianceMatrix_ );
 
-  int throwNb{0};
-  while( true ) {
-    throwNb++;
-    bool rethrow{false};
-    auto throws = GenericToolbox::throwCorrelatedParameters(_choleskyMatrix_.get());
-    for( int iPar = 0 ; iPar < _choleskyMatrix_->GetNrows() ; iPar++ ){
+    // the bounds are checked on the throws directly: nan bounds don't cut anything
+    auto nPars{_strippedParameterList_.size()};
+    _throwLowerBoundList_.assign( nPars, -std::numeric_limits<double>::infinity() );
+    _throwUpperBoundList_.assign( nPars, std::numeric_limits<double>::infinity() );
+    for( size_t iPar = 0 ; iPar < nPars ; iPar++ ){
       auto* parPtr = _strippedParameterList_[iPar];
-      parPtr->setThrowValue(parPtr->getPriorValue() + throws[iPar]);
-      if ( not std::isnan(parPtr->getMinValue()) and parPtr->getThrowValue() < parPtr->getMinValue()) {
-        LogAlert << "Thrown value lower than min bound -> " << parPtr->getThrowValue() << " < min(" << parPtr->getMinValue() << ") " << parPtr->getFullTitle() << std::endl;
-        rethrow = true;
-        break;
-      }
-      if ( not std::isnan(parPtr->getMaxValue()) and parPtr->getThrowValue() > parPtr->getMaxValue()) {
-        LogAlert << "Thrown value greater than max bound -> " << parPtr->getThrowValue() << " > max(" << parPtr->getMaxValue() << ") " << parPtr->getFullTitle() << std::endl;
-        rethrow = true;
-        break;
+      double lower{parPtr->getMinValue()};
+      double upper{parPtr->getMaxValue()};
+      if( _reThrowParSetIfOutOfPhysical_ ){
+        if( not std::isnan(parPtr->getMinPhysical()) ){ lower = std::isnan(lower) ? parPtr->getMinPhysical() : std::max(lower, parPtr->getMinPhysical()); }
+        if( not std::isnan(parPtr->getMaxPhysical()) ){ upper = std::isnan(upper) ? parPtr->getMaxPhysical() : std::min(upper, parPtr->getMaxPhysical()); }
       }
+      if( not std::isnan(lower) ){ _throwLowerBoundList_[iPar] = lower - parPtr->getPriorValue(); }
+      if( not std::isnan(upper) ){ _throwUpperBoundList_[iPar] = upper - parPtr->getPriorValue(); }
+    }
+  }
+
+  auto nPars{_strippedParameterList_.size()};
+  auto isThrowValidFct = [&](const double* throws_){
+    // bounds of the thrown parameters
+    for( size_t iPar = 0 ; iPar < nPars ; iPar++ ){
+      if( throws_[iPar] < _throwLowerBoundList_[iPar] or throws_[iPar] > _throwUpperBoundList_[iPar] ){ return false; }
+    }
+
+    for( size_t iPar = 0 ; iPar < nPars ; iPar++ ){
+      auto* parPtr = _strippedParameterList_[iPar];
+      parPtr->setThrowValue( parPtr->getPriorValue() + throws_[iPar] );
       parPtr->setParameterValue( parPtr->getThrowValue() );
-      if( not _reThrowParSetIfOutOfPhysical_ ) continue;
-      if( not std::isnan(parPtr->getMinPhysical()) and parPtr->getParameterValue() < parPtr->getMinPhysical() ){
-        rethrow = true;
-        LogAlert << "thrown value lower than physical min bound -> "
-                 << parPtr->getSummary() << std::endl;
-        break;
-      }
-      if( not std::isnan(parPtr->getMaxPhysical()) and parPtr->getParameterValue() > parPtr->getMaxPhysical() ){
-        rethrow = true;
-        LogAlert << "thrown value higher than physical max bound -> "
-                 << parPtr->getSummary() << std::endl;
-        break;
-      }
     }
 
     // Making sure eigen decomposed parameters get the conversion done
     for( auto& parSet : _parameterSetList_ ) {
-      if (rethrow) break;  // short circuit if we are already rethrowing.
       if( not parSet.isEnabled() ) continue;
       if( not parSet.isEnableEigenDecomp() ) continue;
       parSet.propagateOriginalToEigen();
@@ -264,41 +275,39 @@ void ParametersManager::throwParametersFromGlobalCovariance(bool quietVerbose_){
         if( not par.isEnabled() ) continue;
         if( par.isValueWithinBounds() ) continue;
         // re-do the throwing
-        rethrow = true;
-        break;
+        return false;
       }
     }
+    return true;
+  };
 
-    if( rethrow ) {
-      LogThrowIf( throwNb > 100000, "Too many throw attempts")
-      // wrap back to the while loop
-      LogWarning << "Rethrowing after attempt #" << throwNb << std::endl;
-      continue;
-    }
+  // the candidates are drawn by blocks until one is within the bounds.
+  // The last checked candidate is the one that has been accepted.
+  long nCandidates = _throwGenerator_->throwAccepted( _throwBuffer_, isThrowValidFct );
+  LogThrowIf( nCandidates == 0, "Too many throw attempts" );
+  if( nCandidates > 1 ){
+    LogWarning << "Thrown parameters accepted after attempt #" << nCandidates << std::endl;
+  }
 
-    for( auto& parSet : _parameterSetList_ ){
-      if( not parSet.isEnabled() ){ continue; }
-      LogInfo << parSet.getName() << ":" << std::endl;
-      for( auto& par : parSet.getParameterList() ){
-        if( not par.isEnabled() ){ continue; }
-        LogScopeIndent;
-        par.setThrowValue( par.getParameterValue() );
-        LogInfo << "Thrown par " << par.getFullTitle() << ": " << par.getPriorValue();
-        LogInfo << " becomes " << par.getParameterValue() << std::endl;
-      }
-      if( not parSet.isEnableEigenDecomp() ) continue;
-      LogInfo << "Translated to eigen space:" << std::endl;
-      for( auto& eigenPar : parSet.getEigenParameterList() ){
-        if( not eigenPar.isEnabled() ){ continue; }
-        LogScopeIndent;
-        eigenPar.setThrowValue( eigenPar.getParameterValue() );
-        LogInfo << "Eigen par " << eigenPar.getFullTitle() << ": " << eigenPar.getPriorValue();
-        LogInfo << " becomes " << eigenPar.getParameterValue() << std::endl;
-      }
+  for( auto& parSet : _parameterSetList_ ){
+    if( not parSet.isEnabled() ){ continue; }
+    LogInfo << parSet.getName() << ":" << std::endl;
+    for( auto& par : parSet.getParameterList() ){
+      if( not par.isEnabled() ){ continue; }
+      LogScopeIndent;
+      par.setThrowValue( par.getParameterValue() );
+      LogInfo << "Thrown par " << par.getFullTitle() << ": " << par.getPriorValue();
+      LogInfo << " becomes " << par.getParameterValue() << std::endl;
+    }
+    if( not parSet.isEnableEigenDecomp() ) continue;
+    LogInfo << "Translated to eigen space:" << std::endl;
+    for( auto& eigenPar : parSet.getEigenParameterList() ){
+      if( not eigenPar.isEnabled() ){ continue; }
+      LogScopeIndent;
+      eigenPar.setThrowValue( eigenPar.getParameterValue() );
+      LogInfo << "Eigen par " << eigenPar.getFullTitle() << ": " << eigenPar.getPriorValue();
+      LogInfo << " becomes " << eigenPar.getParameterValue() << std::endl;
     }
-
-    // reached this point: all parameters are within bounds
-    break;
   }
 }
 
@@ -333,6 +342,23 @@ void ParametersManager::injectParameterValues(const JsonType &config_) {
     selectedParSet->injectParameterValues(entryParSet);
   }
 }
+void ParametersManager::importParameterValues(const std::vector<double>& parameterValues_){
+  // counterpart of exportParameterValues(): the parameter layout must not have changed in between
+  size_t iValue{0};
+  for( auto& parSet : _parameterSetList_ ){
+    if( not parSet.isEnabled() ){ continue; }
+    for( auto& par : parSet.getParameterList() ){
+      LogThrowIf(iValue >= parameterValues_.size(), "Parameter value snapshot is too short: " << parameterValues_.size());
+      par.setParameterValue( parameterValues_[iValue++], true );
+    }
+    if( not parSet.isEnableEigenDecomp() ){ continue; }
+    for( auto& eigenPar : parSet.getEigenParameterList() ){
+      LogThrowIf(iValue >= parameterValues_.size(), "Parameter value snapshot is too short: " << parameterValues_.size());
+      eigenPar.setParameterValue( parameterValues_[iValue++], true );
+    }
+  }
+  LogThrowIf(iValue != parameterValues_.size(), "Parameter value snapshot size mismatch: " << iValue << " != " << parameterValues_.size());
+}
 ParameterSet* ParametersManager::getFitParameterSetPtr(const std::string& name_){
   return const_cast<ParameterSet*>(const_cast<const ParametersManager*>(this)->getFitParameterSetPtr(name_));
 }
@@ -107,6 +107,10 @@ public:
   std::vector<std::string> fetchListOfVarToPlot(bool isData_ = false) const;
   std::vector<std::string> fetchListOfSplitVarNames() const;
 
+  /// True if a histogram needs the variables of the individual events: it
+  /// doesn't follow the sample binning, or it is split by an event variable.
+  [[nodiscard]] bool isUsingEventVariables() const;
+
   void defineHistogramHolders();
 
 
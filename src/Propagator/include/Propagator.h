@@ -17,6 +17,7 @@
 #include <vector>
 #include <map>
 #include <future>
+#include <functional>
 
 
 class Propagator : public JsonBaseClass {
@@ -37,6 +38,8 @@ public:
   void setEnableEigenToOrigInPropagate(bool enableEigenToOrigInPropagate){ _enableEigenToOrigInPropagate_ = enableEigenToOrigInPropagate; }
   void setIThrow(int iThrow){ _iThrow_ = iThrow; }
   void setParameterInjectorConfig(const JsonType &parameterInjector){ _parameterInjectorMc_ = parameterInjector; }
+  void setDevSingleThreadReweight(bool devSingleThreadReweight_){ _devSingleThreadReweight_ = devSingleThreadReweight_; }
+  void setDevSingleThreadHistFill(bool devSingleThreadHistFill_){ _devSingleThreadHistFill_ = devSingleThreadHistFill_; }
 
   // const getters
   [[nodiscard]] bool isDebugPrintLoadedEvents() const { return _debugPrintLoadedEvents_; }
@@ -62,10 +65,50 @@ public:
   void propagateParameters();
   void reweightEvents();
 
+  /// Propagate several parameter points with a single pass over the event
+  /// dial cache.  setPointFct_(iPoint) is called nPoints_ times to move the
+  /// parameters to each point, then the K weights of each event are computed
+  /// in one go and the K histogram sets are accumulated.  Finally, for each
+  /// point, the parameters, the event weights and the sample histograms are
+  /// set back to that point before onPointFct_(iPoint) is called, so the
+  /// callback can use the events (e.g. for the MC stat throws) as after a
+  /// regular propagation.  Once done, the propagator
+  /// is left in the state of the last point.  Falls back to a sequential
+  /// propagation if the batch can't be handled (see isBatchPropagationSupported()).
+  void propagateParametersBatch(
+      int nPoints_,
+      const std::function<void(int)>& setPointFct_,
+      const std::function<void(int)>& onPointFct_ = {}
+  );
+  [[nodiscard]] bool isBatchPropagationSupported() const;
+
+  /// Throw the MC statistical error of the events (if enabled, and not
+  /// disabled for the sample), then the statistical error of every sample
+  /// histogram.  The throws are drawn from the counter-based generator, in
+  /// parallel over the bins: they don't depend on the number of threads.
+  void throwStatErrors(const CounterRandom& random_, bool enableEventMcThrow_, bool useGaussThrow_ = false);
+
+  /// Fold the response of the dials which only depend on fixed (or
+  /// disabled) parameters into a constant factor of each event, so they
+  /// aren't evaluated while reweighting.  The parameters must not be
+  /// released or moved before unfreezeFixedParameterDials() is called.
+  void freezeFixedParameterDials();
+  void unfreezeFixedParameterDials();
+
+  /// Find the dials shared by all the events of a histogram bin (e.g. norm
+  /// dials binned like the sample), and apply them on the bin content
+  /// instead of each event weight.  While the dials are hoisted, the event
+  /// weights don't include them: only the histograms are meant to be used
+  /// until unhoistBinConstantDials() is called.
+  void hoistBinConstantDials();
+  void unhoistBinConstantDials();
+  [[nodiscard]] bool hasHoistedDials() const { return not _hoistedDialList_.empty(); }
+
   // misc
   void copyEventsFrom(const Propagator& src_);
   void printConfiguration() const;
   void printBreakdowns() const;
+  void printSegmentHintSummary() const;
   void writeEventRates(const GenericToolbox::TFilePath& saveDir_) const;
 
   // public members
@@ -77,10 +120,17 @@ protected:
 
   // multithreading
   void reweightEvents( int iThread_);
+  void reweightEventsBatch( int iThread_);
   void refillHistogramsFct( int iThread_);
+  void throwStatErrorsFct( int iThread_);
+  void updateDialInputBuffersFct( int iThread_);
+  void updateDialResponsesFct( int iThread_);
+  void updateDialCollectionsFct( int iThread_);
 
   void updateDialState();
+  void updateParameterValueList();
   void refillHistograms();
+  void buildBatchCache();
 
 private:
 
@@ -112,6 +162,40 @@ private:
 
   GenericToolbox::ParallelWorker _threadPool_{};
 
+  // Contiguous copy of the parameter values, read by the dial input buffers
+  std::vector<double> _parameterValueList_{};     // the parameters of all the sets, in order
+  std::vector<char> _parameterChangedList_{};     // changed since the last update
+  std::vector<DialInputBuffer*> _dialInputBufferRefList_{}; // all the collections
+  std::vector<DialCollection*> _updatedDialCollectionList_{}; // the update callbacks to run (e.g. the tables)
+
+  // Dials applied on the histogram bins (see hoistBinConstantDials)
+  struct HoistedDial{
+    DialInterface* dialInterface{nullptr};
+    double response{std::nan("unset")};
+  };
+  std::vector<HoistedDial> _hoistedDialList_{};
+
+  // Batched propagation
+  struct BatchCacheEntry{
+    // flattened over the bins of every sample, -1 if not in a bin
+    int histBinIndex{-1};
+    // flattened over the input buffers of every dial collection, one per dial response of the cache entry
+    std::vector<size_t> inputBufferIndexList{};
+  };
+  int _batchNbPoints_{0};
+  size_t _batchNbBins_{0};
+  std::vector<BatchCacheEntry> _batchCache_{};
+  std::vector<DialInputBuffer*> _batchInputBufferRefList_{};
+  std::vector<DialInputBuffer> _batchInputBufferList_{}; // [iPoint][iInputBuffer]
+  std::vector<std::vector<double>> _batchBinContentList_{}; // [iThread][iPoint][iBin][sumW, sumW2]
+  std::vector<double> _batchEventWeightList_{}; // [iCacheEntry][iPoint]
+  std::vector<size_t> _batchHoistedInputBufferIndexList_{}; // [iHoistedDial]
+
+  // Stat throws
+  CounterRandom _statThrowRandom_{};
+  bool _statThrowEventMc_{false};
+  bool _statThrowGauss_{false};
+
 };
 #endif //GUNDAM_PROPAGATOR_H
 
@@ -627,6 +627,14 @@ std::vector<std::string> PlotGenerator::fetchListOfSplitVarNames() const {
 
   return varNameList;
 }
+bool PlotGenerator::isUsingEventVariables() const {
+  if( not _isEnabled_ ){ return false; }
+  if( not fetchListOfSplitVarNames().empty() ){ return true; }
+  for( auto& histDef : _histDefList_ ){
+    if( not histDef.useSampleBinning ){ return true; }
+  }
+  return false;
+}
 
 // Internals
 void PlotGenerator::defineHistogramHolders() {
@@ -17,6 +17,8 @@
 
 #include <memory>
 #include <vector>
+#include <unordered_map>
+#include <algorithm>
 
 #ifndef DISABLE_USER_HEADER
 LoggerInit([]{ Logger::setUserHeaderStr("[Propagator]"); });
@@ -87,6 +89,7 @@ void Propagator::configureImpl(){
   GenericToolbox::Json::fillValue(_config_, _devSingleThreadReweight_, "devSingleThreadReweight");
   GenericToolbox::Json::fillValue(_config_, _devSingleThreadHistFill_, "devSingleThreadHistFill");
   GenericToolbox::Json::fillValue(_config_, _eventDialCache_.getGlobalEventReweightCap().maxReweight, "globalEventReweightCap");
+  GenericToolbox::Json::fillValue(_config_, _eventDialCache_.getEventCompression(), "enableEventCompression");
 
 }
 void Propagator::initializeImpl(){
@@ -114,7 +117,13 @@ void Propagator::clearContent(){
     // clear input buffer cache to trigger the cache eval
     dialCollection.invalidateCachedInputBuffers();
   }
+  // keep the configured options of the cache
+  auto reweightCap = _eventDialCache_.getGlobalEventReweightCap();
+  bool isEventCompressionEnabled{_eventDialCache_.getEventCompression()};
   _eventDialCache_ = EventDialCache();
+  _eventDialCache_.getGlobalEventReweightCap() = reweightCap;
+  _eventDialCache_.getEventCompression() = isEventCompressionEnabled;
+  _batchCache_.clear();
 
 }
 void Propagator::shrinkDialContainers(){
@@ -126,6 +135,7 @@ void Propagator::shrinkDialContainers(){
 void Propagator::buildDialCache(){
   _eventDialCache_.shrinkIndexedCache();
   _eventDialCache_.buildReferenceCache(_sampleSet_, _dialCollectionList_);
+  _batchCache_.clear();
 
   // be extra sure the dial input will request an update
   for( auto& dialCollection : _dialCollectionList_ ){
@@ -144,6 +154,13 @@ void Propagator::reweightEvents() {
 
   updateDialState();
 
+  // the dials applied on the histogram bins
+  for( auto& hoistedDial : _hoistedDialList_ ){
+    if( hoistedDial.dialInterface->getInputBufferRef()->isDialUpdateRequested() ){
+      hoistedDial.response = hoistedDial.dialInterface->evalResponse();
+    }
+  }
+
   bool usedGPU{false};
 #ifdef GUNDAM_USING_CACHE_MANAGER
   if( GundamGlobals::isCacheManagerEnabled() ) {
@@ -155,12 +172,137 @@ void Propagator::reweightEvents() {
 #endif
   if( not usedGPU ){
     if( not _devSingleThreadReweight_ ){
+      _threadPool_.runJob("Propagator::updateDialResponses");
       _threadPool_.runJob("Propagator::reweightEvents");
     }
-    else{ this->reweightEvents(-1); }
+    else{
+      this->updateDialResponsesFct(-1);
+      this->reweightEvents(-1);
+    }
+  }
+
+  reweightTimer.stop();
+}
+void Propagator::propagateParametersBatch(
+    int nPoints_,
+    const std::function<void(int)>& setPointFct_,
+    const std::function<void(int)>& onPointFct_
+){
+
+  if( nPoints_ < 2 or not this->isBatchPropagationSupported() ){
+    // nothing to gain: regular propagation, point by point
+    for( int iPoint = 0 ; iPoint < nPoints_ ; iPoint++ ){
+      setPointFct_( iPoint );
+      this->propagateParameters();
+      if( onPointFct_ ){ onPointFct_( iPoint ); }
+    }
+    return;
+  }
+
+  if( _batchCache_.empty() or _batchCache_.size() != _eventDialCache_.getCache().size() ){ this->buildBatchCache(); }
+
+  reweightTimer.start();
+
+  // one copy of every input buffer per point
+  _batchNbPoints_ = nPoints_;
+  if( _batchInputBufferList_.size() != size_t(nPoints_) * _batchInputBufferRefList_.size() ){
+    _batchInputBufferList_.clear();
+    _batchInputBufferList_.reserve( size_t(nPoints_) * _batchInputBufferRefList_.size() );
+    for( int iPoint = 0 ; iPoint < nPoints_ ; iPoint++ ){
+      for( auto* inputBufferPtr : _batchInputBufferRefList_ ){ _batchInputBufferList_.emplace_back( *inputBufferPtr ); }
+    }
+  }
+
+  // collect the points
+  std::vector<std::vector<double>> parameterValuesList(nPoints_);
+  for( int iPoint = 0 ; iPoint < nPoints_ ; iPoint++ ){
+    setPointFct_( iPoint );
+
+    // Only real parameters are propagated on the spectra -> need to convert the eigen to original
+    if( _enableEigenToOrigInPropagate_ ){ _parManager_.convertEigenToOrig(); }
+
+    parameterValuesList[iPoint] = _parManager_.exportParameterValues();
+    std::for_each(
+        _batchInputBufferList_.begin() + long(iPoint * _batchInputBufferRefList_.size()),
+        _batchInputBufferList_.begin() + long((iPoint+1) * _batchInputBufferRefList_.size()),
+        []( DialInputBuffer& inputBuffer_ ){ inputBuffer_.update(); }
+    );
   }
 
+  // single pass over the events
+  _batchEventWeightList_.resize( _eventDialCache_.getCache().size() * size_t(nPoints_) );
+  _batchBinContentList_.resize( std::max(1, int(_threadPool_.getNbThreads())) );
+  for( auto& binContentList : _batchBinContentList_ ){ binContentList.assign( 2 * size_t(nPoints_) * _batchNbBins_, 0 ); }
+  if( not _devSingleThreadReweight_ ){ _threadPool_.runJob("Propagator::reweightEventsBatch"); }
+  else{ this->reweightEventsBatch(-1); }
+
+  // merge the thread buffers
+  auto& binContentList = _batchBinContentList_[0];
+  for( size_t iThread = 1 ; iThread < _batchBinContentList_.size() ; iThread++ ){
+    for( size_t iSlot = 0 ; iSlot < binContentList.size() ; iSlot++ ){ binContentList[iSlot] += _batchBinContentList_[iThread][iSlot]; }
+  }
+
+  // the dial response caches don't reflect any of the points: force a full re-evaluation next time
+  for( auto& dialCollection : _dialCollectionList_ ){ dialCollection.invalidateCachedInputBuffers(); }
+
   reweightTimer.stop();
+
+  // hand over the points one by one
+  for( int iPoint = 0 ; iPoint < nPoints_ ; iPoint++ ){
+    _parManager_.importParameterValues( parameterValuesList[iPoint] );
+
+    // the events get the weights of this point, the stat throws rely on them
+    auto& cache = _eventDialCache_.getCache();
+    for( size_t iEntry = 0 ; iEntry < cache.size() ; iEntry++ ){
+      cache[iEntry].event->getWeights().current = _batchEventWeightList_[iEntry * size_t(nPoints_) + size_t(iPoint)];
+    }
+
+    // the dials applied on the histogram bins take the responses of this point
+    DialInputBuffer* inputBufferList{&_batchInputBufferList_[size_t(iPoint) * _batchInputBufferRefList_.size()]};
+    for( size_t iHoisted = 0 ; iHoisted < _hoistedDialList_.size() ; iHoisted++ ){
+      auto* dialInterface = _hoistedDialList_[iHoisted].dialInterface;
+      _hoistedDialList_[iHoisted].response = DialInterface::evalResponse(
+          &inputBufferList[_batchHoistedInputBufferIndexList_[iHoisted]],
+          dialInterface->getDialBaseRef(),
+          dialInterface->getResponseSupervisorRef()
+      );
+    }
+
+    const double* binContentPtr{&binContentList[2 * size_t(iPoint) * _batchNbBins_]};
+    for( auto& sample : _sampleSet_.getSampleList() ){
+#if HAS_CPP_17
+      for( auto [binContent, binContext] : sample.getHistogram().loop() ){
+#else
+      for( auto element : sample.getHistogram().loop() ){ auto& binContent = std::get<0>(element); auto& binContext = std::get<1>(element);
+#endif
+        binContent.sumWeights = *(binContentPtr++);
+        binContent.sqrtSumSqWeights = std::sqrt( *(binContentPtr++) );
+        binContext.applyBinFactors(binContent);
+      }
+    }
+
+    if( onPointFct_ ){ onPointFct_( iPoint ); }
+  }
+
+}
+bool Propagator::isBatchPropagationSupported() const {
+#ifdef GUNDAM_USING_CACHE_MANAGER
+  // the event weights are held on the device
+  if( GundamGlobals::isCacheManagerEnabled() ){ return false; }
+#endif
+  // dials relying on a shared state (tables) can only represent one point at a time
+  return std::none_of(
+      _dialCollectionList_.begin(), _dialCollectionList_.end(),
+      []( const DialCollection& dc_ ){ return dc_.isEnabled() and dc_.hasUpdateCallbacks(); }
+  );
+}
+void Propagator::throwStatErrors(const CounterRandom& random_, bool enableEventMcThrow_, bool useGaussThrow_){
+  _statThrowRandom_ = random_;
+  _statThrowEventMc_ = enableEventMcThrow_;
+  _statThrowGauss_ = useGaussThrow_;
+
+  if( not _devSingleThreadHistFill_ ){ _threadPool_.runJob("Propagator::throwStatErrors"); }
+  else{ throwStatErrorsFct(-1); }
 }
 
 // misc
@@ -177,6 +319,16 @@ void Propagator::printConfiguration() const {
 
   LogInfo << std::endl;
 }
+void Propagator::printSegmentHintSummary() const {
+  // the dials which start their knot search from the previous segment
+  for( auto& dialCollection : _dialCollectionList_ ){
+    auto segmentHint = dialCollection.getSegmentHintTotal();
+    if( segmentHint.nCalls == 0 ){ continue; }
+    LogInfo << "Knot segment hint hit rate for \"" << dialCollection.getTitle() << "\": "
+            << 100. * double(segmentHint.nHits) / double(segmentHint.nCalls) << "% ("
+            << segmentHint.nCalls << " evaluations)" << std::endl;
+  }
+}
 void Propagator::printBreakdowns() const {
 
   LogInfo << std::endl << "Breaking down samples..." << std::endl;
@@ -257,9 +409,143 @@ void Propagator::printBreakdowns() const {
 void Propagator::copyEventsFrom(const Propagator& src_){
   _sampleSet_.copyEventsFrom( src_.getSampleSet() );
   _eventDialCache_.fillCacheEntries( _sampleSet_ );
+  _batchCache_.clear();
+}
+
+
+
+void Propagator::freezeFixedParameterDials(){
+  // the input buffers need to hold the current parameter values
+  this->updateDialState();
+
+  size_t nFrozen = _eventDialCache_.freezeDials([](const DialInterface& dial_){
+    auto* inputBuffer = dial_.getInputBufferRef();
+    if( inputBuffer == nullptr or inputBuffer->getInputSize() == 0 ){ return false; }
+    for( int iInput = 0 ; iInput < int(inputBuffer->getInputSize()) ; iInput++ ){
+      auto& parSet = inputBuffer->getParameterSet(iInput);
+      if( not parSet.isEnabled() ){ continue; }
+      // the original parameters are moved by the eigen parameters
+      if( parSet.isEnableEigenDecomp() ){ return false; }
+      auto& par = inputBuffer->getParameter(iInput);
+      if( par.isEnabled() and not par.isFixed() ){ return false; }
+    }
+    return true;
+  });
+  _batchCache_.clear(); // the dial lists have changed
+
+  LogInfo << nFrozen << " event dials from fixed parameters have been frozen." << std::endl;
 }
+void Propagator::unfreezeFixedParameterDials(){
+  this->updateDialState();
+  _eventDialCache_.unfreezeDials();
+  _batchCache_.clear();
+}
+
+void Propagator::hoistBinConstantDials(){
+  if( not _hoistedDialList_.empty() ){ return; } // already done
 
+#ifdef GUNDAM_USING_CACHE_MANAGER
+  // the device computes the full event weights
+  if( GundamGlobals::isCacheManagerEnabled() ){ return; }
+#endif
+  if( _eventDialCache_.getGlobalEventReweightCap().isEnabled ){
+    // the cap is applied on the product of the event dials
+    LogAlert << "Can't apply the dials on the histogram bins with the global event reweight cap." << std::endl;
+    return;
+  }
 
+  // the input buffers need to hold the current parameter values
+  this->updateDialState();
+
+  std::unordered_map<const Event*, EventDialCache::CacheEntry*> cacheEntryMap{};
+  for( auto& cacheEntry : _eventDialCache_.getCache() ){ cacheEntryMap[cacheEntry.event] = &cacheEntry; }
+
+  // the dial interfaces used by every event of the bin: the response of a
+  // dial interface doesn't depend on the event
+  struct BinHoist{ Histogram::BinContext* binContext; std::vector<size_t> hoistedIndexList; };
+  std::vector<BinHoist> binHoistList{};
+  std::unordered_map<DialInterface*, size_t> hoistedIndexMap{};
+  size_t nHoistedEventDials{0};
+  for( auto& sample : _sampleSet_.getSampleList() ){
+    for( auto& binContext : sample.getHistogram().getBinContextList() ){
+      if( binContext.eventPtrList.empty() ){ continue; }
+
+      std::vector<DialInterface*> sharedDialList{};
+      for( size_t iEvent = 0 ; iEvent < binContext.eventPtrList.size() ; iEvent++ ){
+        auto cacheEntryIt = cacheEntryMap.find( binContext.eventPtrList[iEvent] );
+        if( cacheEntryIt == cacheEntryMap.end() ){ sharedDialList.clear(); break; }
+        auto& dialList = cacheEntryIt->second->dialResponseCacheList;
+
+        if( iEvent == 0 ){
+          for( auto& dial : dialList ){ sharedDialList.emplace_back( dial.dialInterface ); }
+        }
+        else{
+          sharedDialList.erase( std::remove_if(sharedDialList.begin(), sharedDialList.end(), [&](DialInterface* dialInterface_){
+            return std::none_of(dialList.begin(), dialList.end(), [&](const EventDialCache::DialResponseCache& dial_){
+              return dial_.dialInterface == dialInterface_;
+            });
+          }), sharedDialList.end() );
+        }
+        if( sharedDialList.empty() ){ break; }
+      }
+      if( sharedDialList.empty() ){ continue; }
+
+      binHoistList.emplace_back();
+      binHoistList.back().binContext = &binContext;
+      for( auto* dialInterface : sharedDialList ){
+        auto hoistedIndexIt = hoistedIndexMap.find( dialInterface );
+        if( hoistedIndexIt == hoistedIndexMap.end() ){
+          hoistedIndexIt = hoistedIndexMap.emplace( dialInterface, _hoistedDialList_.size() ).first;
+          _hoistedDialList_.emplace_back();
+          _hoistedDialList_.back().dialInterface = dialInterface;
+          _hoistedDialList_.back().response = dialInterface->evalResponse();
+        }
+        binHoistList.back().hoistedIndexList.emplace_back( hoistedIndexIt->second );
+      }
+
+      // remove them from the events
+      for( auto* eventPtr : binContext.eventPtrList ){
+        auto* cacheEntry = cacheEntryMap[eventPtr];
+        auto& dialList = cacheEntry->dialResponseCacheList;
+        auto firstHoisted = std::stable_partition(dialList.begin(), dialList.end(), [&](const EventDialCache::DialResponseCache& dial_){
+          return std::find(sharedDialList.begin(), sharedDialList.end(), dial_.dialInterface) == sharedDialList.end();
+        });
+        nHoistedEventDials += std::distance(firstHoisted, dialList.end());
+        cacheEntry->hoistedDialResponseCacheList.insert( cacheEntry->hoistedDialResponseCacheList.end(), firstHoisted, dialList.end() );
+        dialList.erase(firstHoisted, dialList.end());
+      }
+    }
+  }
+
+  // the hoisted list won't be resized anymore
+  for( auto& binHoist : binHoistList ){
+    for( auto hoistedIndex : binHoist.hoistedIndexList ){
+      binHoist.binContext->binFactorPtrList.emplace_back( &_hoistedDialList_[hoistedIndex].response );
+    }
+  }
+  _batchCache_.clear(); // the dial lists have changed
+
+  LogInfo << _hoistedDialList_.size() << " dials applied on " << binHoistList.size() << " histogram bins instead of "
+          << nHoistedEventDials << " event dials." << std::endl;
+}
+void Propagator::unhoistBinConstantDials(){
+  if( _hoistedDialList_.empty() ){ return; }
+
+  this->updateDialState();
+  for( auto& cacheEntry : _eventDialCache_.getCache() ){
+    for( auto& dial : cacheEntry.hoistedDialResponseCacheList ){
+      // the cached response might be outdated
+      dial.response = dial.dialInterface->evalResponse();
+      cacheEntry.dialResponseCacheList.emplace_back( dial );
+    }
+    cacheEntry.hoistedDialResponseCacheList.clear();
+  }
+  for( auto& sample : _sampleSet_.getSampleList() ){
+    for( auto& binContext : sample.getHistogram().getBinContextList() ){ binContext.binFactorPtrList.clear(); }
+  }
+  _hoistedDialList_.clear();
+  _batchCache_.clear();
+}
 
 // Protected
 void Propagator::initializeThreads() {
@@ -272,23 +558,180 @@ void Propagator::initializeThreads() {
       [this](int iThread){ this->reweightEvents(iThread); }
   );
 
+  _threadPool_.addJob(
+      "Propagator::reweightEventsBatch",
+      [this](int iThread){ this->reweightEventsBatch(iThread); }
+  );
+
   _threadPool_.addJob(
       "Propagator::refillHistograms",
       [this](int iThread){ this->refillHistogramsFct(iThread); }
   );
 
+  _threadPool_.addJob(
+      "Propagator::updateDialInputBuffers",
+      [this](int iThread){ this->updateDialInputBuffersFct(iThread); }
+  );
+
+  _threadPool_.addJob(
+      "Propagator::updateDialResponses",
+      [this](int iThread){ this->updateDialResponsesFct(iThread); }
+  );
+
+  _threadPool_.addJob(
+      "Propagator::updateDialCollections",
+      [this](int iThread){ this->updateDialCollectionsFct(iThread); }
+  );
+
+  _threadPool_.addJob(
+      "Propagator::throwStatErrors",
+      [this](int iThread){ this->throwStatErrorsFct(iThread); }
+  );
+
 }
 
 // private
 void Propagator::updateDialState(){
-  std::for_each(_dialCollectionList_.begin(), _dialCollectionList_.end(),
-                [&]( DialCollection& dc_){
-                  dc_.updateInputBuffers();
-                });
-  std::for_each(_dialCollectionList_.begin(), _dialCollectionList_.end(),
-                [&]( DialCollection& dc_){
-                  dc_.update();
-                });
+  this->updateParameterValueList();
+
+  // the input buffers might have been reallocated (e.g. reloading the events)
+  size_t nInputBuffers{0};
+  bool isInputBufferListValid{true};
+  for( auto& dialCollection : _dialCollectionList_ ){
+    auto& inputBufferList = dialCollection.getDialInputBufferList();
+    isInputBufferListValid &= ( nInputBuffers + inputBufferList.size() <= _dialInputBufferRefList_.size() );
+    isInputBufferListValid &= ( inputBufferList.empty() or _dialInputBufferRefList_[nInputBuffers] == &inputBufferList[0] );
+    nInputBuffers += inputBufferList.size();
+    if( not isInputBufferListValid ){ break; }
+  }
+  if( not isInputBufferListValid or nInputBuffers != _dialInputBufferRefList_.size() ){
+    _dialInputBufferRefList_.clear();
+    for( auto& dialCollection : _dialCollectionList_ ){
+      for( auto& inputBuffer : dialCollection.getDialInputBufferList() ){ _dialInputBufferRefList_.emplace_back( &inputBuffer ); }
+    }
+  }
+
+  if( not _devSingleThreadReweight_ ){
+    _threadPool_.runJob("Propagator::updateDialInputBuffers");
+  }
+  else{ this->updateDialInputBuffersFct(-1); }
+
+  // the collections relying on a shared state (e.g. the tables) are only
+  // updated if their inputs have changed, and all at the same time
+  _updatedDialCollectionList_.clear();
+  for( auto& dialCollection : _dialCollectionList_ ){
+    if( dialCollection.hasUpdateCallbacks() and dialCollection.isUpdateRequested() ){
+      _updatedDialCollectionList_.emplace_back( &dialCollection );
+    }
+  }
+  if( _updatedDialCollectionList_.empty() ){ return; }
+
+  if( not _devSingleThreadReweight_ ){
+    _threadPool_.runJob("Propagator::updateDialCollections");
+  }
+  else{ this->updateDialCollectionsFct(-1); }
+
+  for( auto* dialCollection : _updatedDialCollectionList_ ){ dialCollection->flagUpdateDone(); }
+}
+void Propagator::updateParameterValueList(){
+  auto& parSetList = _parManager_.getParameterSetsList();
+
+  size_t nParameters{0};
+  for( auto& parSet : parSetList ){ nParameters += parSet.getParameterList().size(); }
+  if( _parameterValueList_.size() != nParameters ){
+    // nan: everything is flagged as changed on the first update
+    _parameterValueList_.assign( nParameters, std::nan("unset") );
+    _parameterChangedList_.assign( nParameters, 1 );
+  }
+
+  // each parameter is only read once, whatever the number of dials using it
+  size_t iValue{0};
+  for( auto& parSet : parSetList ){
+    for( auto& par : parSet.getParameterList() ){
+      double value{par.getParameterValue()};
+      // nan != nan: nan values are always flagged, the input buffers will complain
+      _parameterChangedList_[iValue] = char( not (value == _parameterValueList_[iValue]) );
+      _parameterValueList_[iValue] = value;
+      iValue++;
+    }
+  }
+}
+void Propagator::updateDialInputBuffersFct(int iThread_){
+  auto bounds = GenericToolbox::ParallelWorker::getThreadBoundIndices(
+      iThread_, _threadPool_.getNbThreads(), int(_dialInputBufferRefList_.size())
+  );
+  const double* valueList{_parameterValueList_.data()};
+  const char* changedList{_parameterChangedList_.data()};
+  for( int iBuffer = bounds.beginIndex ; iBuffer < bounds.endIndex ; iBuffer++ ){
+    _dialInputBufferRefList_[iBuffer]->update( valueList, changedList );
+  }
+}
+void Propagator::updateDialResponsesFct(int iThread_){
+  // each dial is evaluated once, whatever the number of events using it
+  for( auto& dialCollection : _dialCollectionList_ ){
+    if( not dialCollection.isEnabled() ){ continue; }
+    dialCollection.updateDialResponses( iThread_, _threadPool_.getNbThreads() );
+  }
+}
+void Propagator::updateDialCollectionsFct(int iThread_){
+  for( auto* dialCollection : _updatedDialCollectionList_ ){
+    dialCollection->update( iThread_, _threadPool_.getNbThreads() );
+  }
+}
+void Propagator::buildBatchCache(){
+  LogInfo << "Building batch propagation cache..." << std::endl;
+
+  // flatten the input buffers of all the collections
+  _batchInputBufferRefList_.clear();
+  _batchInputBufferList_.clear();
+  std::unordered_map<const DialInputBuffer*, size_t> inputBufferIndexMap{};
+  for( auto& dialCollection : _dialCollectionList_ ){
+    for( auto& inputBuffer : dialCollection.getDialInputBufferList() ){
+      inputBufferIndexMap[&inputBuffer] = _batchInputBufferRefList_.size();
+      _batchInputBufferRefList_.emplace_back( &inputBuffer );
+    }
+  }
+
+  // flatten the bins of all the samples
+  struct SampleEventRange{ const Event* begin; const Event* end; size_t binOffset; int nBins; };
+  std::vector<SampleEventRange> sampleEventRangeList{};
+  _batchNbBins_ = 0;
+  for( auto& sample : _sampleSet_.getSampleList() ){
+    sampleEventRangeList.emplace_back(SampleEventRange{
+      sample.getEventList().data(), sample.getEventList().data() + sample.getEventList().size(),
+      _batchNbBins_, sample.getHistogram().getNbBins()
+    });
+    _batchNbBins_ += sample.getHistogram().getNbBins();
+  }
+
+  // the dials applied on the histogram bins are evaluated with the input buffers of each point
+  _batchHoistedInputBufferIndexList_.clear();
+  for( auto& hoistedDial : _hoistedDialList_ ){
+    auto inputBufferIndex = inputBufferIndexMap.find( hoistedDial.dialInterface->getInputBufferRef() );
+    LogThrowIf(inputBufferIndex == inputBufferIndexMap.end(), "Could not find the input buffer of dial: " << hoistedDial.dialInterface->getSummary());
+    _batchHoistedInputBufferIndexList_.emplace_back( inputBufferIndex->second );
+  }
+
+  _batchCache_.clear();
+  _batchCache_.reserve( _eventDialCache_.getCache().size() );
+  for( auto& cacheEntry : _eventDialCache_.getCache() ){
+    _batchCache_.emplace_back();
+    auto& batchEntry = _batchCache_.back();
+
+    for( auto& sampleRange : sampleEventRangeList ){
+      if( cacheEntry.event < sampleRange.begin or cacheEntry.event >= sampleRange.end ){ continue; }
+      int iBin{cacheEntry.event->getIndices().bin};
+      if( iBin >= 0 and iBin < sampleRange.nBins ){ batchEntry.histBinIndex = int(sampleRange.binOffset) + iBin; }
+      break;
+    }
+
+    batchEntry.inputBufferIndexList.reserve( cacheEntry.dialResponseCacheList.size() );
+    for( auto& dialResponseCache : cacheEntry.dialResponseCacheList ){
+      auto inputBufferIndex = inputBufferIndexMap.find( dialResponseCache.dialInterface->getInputBufferRef() );
+      LogThrowIf(inputBufferIndex == inputBufferIndexMap.end(), "Could not find the input buffer of dial: " << dialResponseCache.dialInterface->getSummary());
+      batchEntry.inputBufferIndexList.emplace_back( inputBufferIndex->second );
+    }
+  }
 }
 void Propagator::refillHistograms(){
   refillHistogramTimer.start();
@@ -316,12 +759,67 @@ void Propagator::reweightEvents( int iThread_) {
       [this]( EventDialCache::CacheEntry& cache_){ _eventDialCache_.reweightEntry(cache_); }
   );
 
+}
+void Propagator::reweightEventsBatch( int iThread_) {
+
+  //! Same remark as reweightEvents(): this is the hot loop of the batch.
+  //! Events are read once and the points are looped in the inner loop.
+
+  auto bounds = GenericToolbox::ParallelWorker::getThreadBoundIndices(
+      iThread_, _threadPool_.getNbThreads(),
+      int(_eventDialCache_.getCache().size())
+  );
+
+  auto& binContentList = _batchBinContentList_[std::max(iThread_, 0)];
+  const size_t nInputBuffers{_batchInputBufferRefList_.size()};
+
+  double weight;
+  for( int iEntry = bounds.beginIndex ; iEntry < bounds.endIndex ; iEntry++ ){
+    auto& cacheEntry = _eventDialCache_.getCache()[iEntry];
+    auto& batchEntry = _batchCache_[iEntry];
+
+    for( int iPoint = 0 ; iPoint < _batchNbPoints_ ; iPoint++ ){
+      DialInputBuffer* inputBufferList{&_batchInputBufferList_[size_t(iPoint) * nInputBuffers]};
+
+      weight = cacheEntry.frozenReweight;
+      for( size_t iDial = 0 ; iDial < cacheEntry.dialResponseCacheList.size() ; iDial++ ){
+        auto* dialInterface = cacheEntry.dialResponseCacheList[iDial].dialInterface;
+        weight *= DialInterface::evalResponse(
+            &inputBufferList[batchEntry.inputBufferIndexList[iDial]],
+            dialInterface->getDialBaseRef(),
+            dialInterface->getResponseSupervisorRef()
+        );
+      }
+      _eventDialCache_.getGlobalEventReweightCap().process( weight );
+      weight *= cacheEntry.event->getWeights().base;
+
+      // the events get the weight of their point when it is handed over
+      _batchEventWeightList_[size_t(iEntry) * size_t(_batchNbPoints_) + size_t(iPoint)] = weight;
+
+      if( batchEntry.histBinIndex < 0 ){ continue; }
+      double* binContentPtr{&binContentList[2 * (size_t(iPoint) * _batchNbBins_ + batchEntry.histBinIndex)]};
+      binContentPtr[0] += weight;
+      binContentPtr[1] += weight * weight * cacheEntry.event->getWeights().sqScale;
+    }
+  }
+
 }
 void Propagator::refillHistogramsFct( int iThread_){
   for( auto& sample : _sampleSet_.getSampleList() ){
     sample.getHistogram().refillHistogram(iThread_);
   }
 }
+void Propagator::throwStatErrorsFct( int iThread_){
+  // a given bin is handled by the same thread for both throws
+  for( size_t iSample = 0 ; iSample < _sampleSet_.getSampleList().size() ; iSample++ ){
+    auto& sample = _sampleSet_.getSampleList()[iSample];
+    auto sampleRandom = _statThrowRandom_.getSubStream( iSample );
+    if( _statThrowEventMc_ and not sample.isEventMcThrowDisabled() ){
+      sample.getHistogram().throwEventMcError( sampleRandom.getSubStream(0), iThread_ );
+    }
+    sample.getHistogram().throwStatError( sampleRandom.getSubStream(1), _statThrowGauss_, iThread_ );
+  }
+}
 
 //  A Lesser GNU Public License
 
@@ -31,6 +31,10 @@ namespace EventUtils{
     double base{1};
     double current{1};
 
+    // sum of the squared base weights over the squared base weight: only
+    // different from 1 for merged events (see EventDialCache::compressEvents)
+    double sqScale{1};
+
     void resetCurrentWeight(){ current = base; }
     [[nodiscard]] std::string getSummary() const;
     friend std::ostream& operator <<( std::ostream& o, const Weights& this_ ){ o << this_.getSummary(); return o; }
@@ -8,9 +8,12 @@
 #include "Event.h"
 #include "Bin.h"
 #include "ConfigUtils.h"
+#include "CounterRandom.h"
 
 #include "GenericToolbox.Loops.h"
 
+#include <cmath>
+
 
 class Histogram{
 
@@ -24,6 +27,17 @@ public:
   struct BinContext{
     Bin bin{};
     std::vector<Event*> eventPtrList{};
+
+    // factors common to all the events of the bin, applied on the bin content
+    // instead of the event weights (see Propagator::hoistBinConstantDials)
+    std::vector<const double*> binFactorPtrList{};
+
+    void applyBinFactors(BinContent& binContent_) const {
+      for( auto* factorPtr : binFactorPtrList ){
+        binContent_.sumWeights *= *factorPtr;
+        binContent_.sqrtSumSqWeights *= std::abs(*factorPtr);
+      }
+    }
   };
 
   // const getters
@@ -44,6 +58,11 @@ public:
   void updateBinEventList(std::vector<Event>& eventList_, int iThread_ = -1);
   void refillHistogram(int iThread_ = -1);
 
+  // multi-thread: same throws as above, drawn from a counter-based generator
+  // keyed by the bin and the event position in the bin (independent of iThread_)
+  void throwEventMcError(const CounterRandom& random_, int iThread_ = -1);
+  void throwStatError(const CounterRandom& random_, bool useGaussThrow_ = false, int iThread_ = -1);
+
   // utils
   auto loop(){ return GenericToolbox::Zip(binContentList, binContextList); }
   auto loop(size_t start_, size_t end_){ return GenericToolbox::ZipPartial(start_, end_, binContentList, binContextList); }
@@ -51,6 +70,30 @@ public:
   [[nodiscard]] auto loop(size_t start_, size_t end_) const { return GenericToolbox::ZipPartial(start_, end_, binContentList, binContextList); }
 
 private:
+  // event by event poisson throw of one bin, shared by both throwEventMcError:
+  // poisson_(mean, iEvent) draws the count of the iEvent-th event of the bin
+  template<typename PoissonFct> void throwBinMcError(int iBin_, PoissonFct poisson_){
+    auto& binContent = binContentList[iBin_];
+    auto& binContext = binContextList[iBin_];
+
+    binContent.sumWeights = 0;
+    binContent.sqrtSumSqWeights = 0;
+    for( size_t iEvent = 0 ; iEvent < binContext.eventPtrList.size() ; iEvent++ ){
+      auto* eventPtr = binContext.eventPtrList[iEvent];
+      // a merged event stands for 1/sqScale events (see EventDialCache::compressEvents):
+      // throwing that many keeps the variance of the throws of its constituents
+      double nEvents{1. / eventPtr->getWeights().sqScale};
+      eventPtr->getWeights().current = (double(poisson_(nEvents, iEvent)) / nEvents * eventPtr->getEventWeight());
+
+      double weight{eventPtr->getEventWeight()};
+      binContent.sumWeights += weight;
+      binContent.sqrtSumSqWeights += weight * weight * eventPtr->getWeights().sqScale;
+    }
+
+    binContent.sqrtSumSqWeights = std::sqrt(binContent.sqrtSumSqWeights);
+    binContext.applyBinFactors(binContent);
+  }
+
   int nBins{0};
   std::vector<BinContent> binContentList{};
   std::vector<BinContext> binContextList{};
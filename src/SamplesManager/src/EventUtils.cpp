@@ -30,6 +30,7 @@ namespace EventUtils{
     std::stringstream ss;
     ss << "base(" << base << ")";
     ss << ", " << "current(" << current << ")";
+    if( sqScale != 1 ){ ss << ", " << "sqScale(" << sqScale << ")"; }
     return ss.str();
   }
 }
@@ -31,26 +31,10 @@ void Histogram::build(const JsonType& binningConfig_){
 }
 void Histogram::throwEventMcError(){
   // event by event poisson throw -> takes into account the finite amount of stat in MC
-
-#if HAS_CPP_17
-  for( auto [binContent, binContext] : loop() ){
-#else
-  for( auto element : loop() ){ auto& binContent = std::get<0>(element); auto& binContext = std::get<1>(element);
-#endif
-    binContent.sumWeights = 0;
-    binContent.sqrtSumSqWeights = 0;
-    for (auto *eventPtr: binContext.eventPtrList) {
-      // gRandom->Poisson(1) -> returns an INT -> can be 0
-      eventPtr->getWeights().current = (double(gRandom->Poisson(1)) * eventPtr->getEventWeight());
-
-      double weight{eventPtr->getEventWeight()};
-      binContent.sumWeights += weight;
-      binContent.sqrtSumSqWeights += weight * weight;
-    }
-
-    binContent.sqrtSumSqWeights = sqrt(binContent.sqrtSumSqWeights);
+  for( int iBin = 0 ; iBin < nBins ; iBin++ ){
+    // gRandom->Poisson() -> returns an INT -> can be 0
+    throwBinMcError(iBin, [](double nEvents_, size_t){ return gRandom->Poisson(nEvents_); });
   }
-
 }
 void Histogram::throwStatError(bool useGaussThrow_){
   /*
@@ -85,6 +69,48 @@ void Histogram::throwStatError(bool useGaussThrow_){
   }
 }
 
+void Histogram::throwEventMcError(const CounterRandom& random_, int iThread_){
+
+  auto bounds = GenericToolbox::ParallelWorker::getThreadBoundIndices(
+      iThread_, GundamGlobals::getNbCpuThreads(), getNbBins()
+  );
+
+  for( int iBin = bounds.beginIndex ; iBin < bounds.endIndex ; iBin++ ){
+    throwBinMcError(iBin, [&](double nEvents_, size_t iEvent_){
+      return random_.poisson(nEvents_, uint64_t(iBin) << 32 | uint64_t(iEvent_));
+    });
+  }
+
+}
+void Histogram::throwStatError(const CounterRandom& random_, bool useGaussThrow_, int iThread_){
+
+  auto bounds = GenericToolbox::ParallelWorker::getThreadBoundIndices(
+      iThread_, GundamGlobals::getNbCpuThreads(), getNbBins()
+  );
+
+  double nCounts;
+  for( int iBin = bounds.beginIndex ; iBin < bounds.endIndex ; iBin++ ){
+    auto& binContent = binContentList[iBin];
+    auto& binContext = binContextList[iBin];
+
+    if( binContent.sumWeights == 0 ){ continue; }
+
+    if( not useGaussThrow_ ){
+      nCounts = double( random_.poisson( binContent.sumWeights, uint64_t(iBin) ) );
+    }
+    else{
+      nCounts = double( std::max(
+          int( random_.gaus(binContent.sumWeights, std::sqrt(binContent.sumWeights), uint64_t(iBin)) )
+          , 0 // if the throw is negative, cap it to 0
+      ) );
+    }
+    for( auto* eventPtr : binContext.eventPtrList ){
+      eventPtr->getWeights().current *= nCounts / binContent.sumWeights;
+    }
+    binContent.sumWeights = nCounts;
+  }
+}
+
 void Histogram::updateBinEventList(std::vector<Event>& eventList_, int iThread_) {
 
   auto bounds = GenericToolbox::ParallelWorker::getThreadBoundIndices(
@@ -141,10 +167,11 @@ void Histogram::refillHistogram(int iThread_){
       for( auto *eventPtr: binContext.eventPtrList ){
         weightBuffer = eventPtr->getEventWeight();
         binContent.sumWeights += weightBuffer;
-        binContent.sqrtSumSqWeights += weightBuffer * weightBuffer;
+        binContent.sqrtSumSqWeights += weightBuffer * weightBuffer * eventPtr->getWeights().sqScale;
       }
 
       binContent.sqrtSumSqWeights = std::sqrt(binContent.sqrtSumSqWeights);
+      binContext.applyBinFactors(binContent);
 #ifdef GUNDAM_USING_CACHE_MANAGER
     }
 
@@ -89,6 +89,16 @@ public:
   // mutable core
   void propagateAndEvalLikelihood();
 
+  /// Evaluate the likelihood at nPoints_ parameter points with a single pass
+  /// over the model events (see Propagator::propagateParametersBatch()).
+  /// When onPointFct_(iPoint) is called, the buffer, the parameters and the
+  /// model histograms correspond to that point.  Returns one Buffer per point.
+  std::vector<Buffer> propagateAndEvalLikelihoodBatch(
+      int nPoints_,
+      const std::function<void(int)>& setPointFct_,
+      const std::function<void(int)>& onPointFct_ = {}
+  );
+
   // core
   double evalLikelihood() const;
   double evalStatLikelihood() const;
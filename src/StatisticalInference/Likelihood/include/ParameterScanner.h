@@ -32,6 +32,8 @@ public:
   // setters
   void setNbPoints(int nbPoints_){ _nbPoints_ = nbPoints_; }
   void setNbPointsLineScan(int nbPointsLineScan_){ _nbPointsLineScan_ = nbPointsLineScan_; }
+  void setNbPointsPerBatch(int nbPointsPerBatch_){ _nbPointsPerBatch_ = nbPointsPerBatch_; }
+  void setNbScanProcesses(int nbScanProcesses_){ _nbScanProcesses_ = nbScanProcesses_; }
   void setLikelihoodInterfacePtr(LikelihoodInterface* likelihoodInterfacePtr_){ _likelihoodInterfacePtr_ = likelihoodInterfacePtr_; }
 
   // const getters
@@ -67,11 +69,26 @@ public:
     TGraph graph{};
   };
 
+protected:
+  /// Evaluate nPoints_ scan points: moveToPointFct_(iPoint) sets the
+  /// parameters and readPointFct_() is called once the likelihood has been
+  /// evaluated at that point.  The returned list is indexed by iPoint.  When
+  /// several scan processes are requested, the points are shared among forked
+  /// processes which inherit the loaded events (copy-on-write) and send their
+  /// results back through a pipe.
+  std::vector<std::vector<double>> evalScanPoints(
+      int nPoints_,
+      const std::function<void(int)>& moveToPointFct_,
+      const std::function<std::vector<double>()>& readPointFct_
+  );
+
 private:
   // Config
   bool _useParameterLimits_{true};
   int _nbPoints_{100};
   int _nbPointsLineScan_{_nbPoints_};
+  int _nbPointsPerBatch_{1}; // >1: points are propagated together in one pass over the events
+  int _nbScanProcesses_{1}; // >1: points are shared among forked processes
   GenericToolbox::Range _parameterSigmaRange_{-3.,3.};
   JsonType _varsConfig_{};
 
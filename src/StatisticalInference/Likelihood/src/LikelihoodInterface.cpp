@@ -105,6 +105,12 @@ void LikelihoodInterface::initializeImpl() {
   _plotGenerator_.setDataSampleSetPtr( &_dataPropagator_.getSampleSet().getSampleList() );
   _plotGenerator_.initialize();
 
+  // the merged events only keep the sample bin of their constituents
+  LogThrowIf(
+      _modelPropagator_.getEventDialCache().getEventCompression() and _plotGenerator_.isUsingEventVariables(),
+      "enableEventCompression: the plots must use the sample binning (useSampleBinning) and can't be split."
+  );
+
   _eventTreeWriter_.initialize();
 
   // loading the propagators
@@ -155,6 +161,19 @@ void LikelihoodInterface::propagateAndEvalLikelihood(){
   _modelPropagator_.propagateParameters();
   this->evalLikelihood();
 }
+std::vector<LikelihoodInterface::Buffer> LikelihoodInterface::propagateAndEvalLikelihoodBatch(
+    int nPoints_,
+    const std::function<void(int)>& setPointFct_,
+    const std::function<void(int)>& onPointFct_
+){
+  std::vector<Buffer> out(nPoints_);
+  _modelPropagator_.propagateParametersBatch(nPoints_, setPointFct_, [&](int iPoint_){
+    this->evalLikelihood();
+    out[iPoint_] = _buffer_;
+    if( onPointFct_ ){ onPointFct_( iPoint_ ); }
+  });
+  return out;
+}
 
 double LikelihoodInterface::evalLikelihood() const {
   this->evalStatLikelihood();
@@ -213,16 +232,27 @@ void LikelihoodInterface::writeEvents(const GenericToolbox::TFilePath& saveDir_)
 
   // TODO: use the EventDialCache for writing the dials?
 
-  LogInfo << "Writing model sample events..." << std::endl;
-  for( auto& sample : _modelPropagator_.getSampleSet().getSampleList() ){
-    if( not sample.isEnabled() ){ continue; }
-    _eventTreeWriter_.writeEvents( saveDir_.getSubDir("model").getSubDir(sample.getName()), sample.getEventList() );
+  // the merged events don't describe the events that have been loaded
+  if( _modelPropagator_.getEventDialCache().getEventCompression() ){
+    LogAlert << "Events are compressed (enableEventCompression): not writing the model sample events." << std::endl;
+  }
+  else{
+    LogInfo << "Writing model sample events..." << std::endl;
+    for( auto& sample : _modelPropagator_.getSampleSet().getSampleList() ){
+      if( not sample.isEnabled() ){ continue; }
+      _eventTreeWriter_.writeEvents( saveDir_.getSubDir("model").getSubDir(sample.getName()), sample.getEventList() );
+    }
   }
 
-  LogInfo << "Writing data sample events..." << std::endl;
-  for( auto& sample : _dataPropagator_.getSampleSet().getSampleList() ){
-    if( not sample.isEnabled() ){ continue; }
-    _eventTreeWriter_.writeEvents( saveDir_.getSubDir("data").getSubDir(sample.getName()), sample.getEventList() );
+  if( _dataPropagator_.getEventDialCache().getEventCompression() ){
+    LogAlert << "Events are compressed (enableEventCompression): not writing the data sample events." << std::endl;
+  }
+  else{
+    LogInfo << "Writing data sample events..." << std::endl;
+    for( auto& sample : _dataPropagator_.getSampleSet().getSampleList() ){
+      if( not sample.isEnabled() ){ continue; }
+      _eventTreeWriter_.writeEvents( saveDir_.getSubDir("data").getSubDir(sample.getName()), sample.getEventList() );
+    }
   }
 
 }
@@ -281,13 +311,8 @@ double LikelihoodInterface::evalPenaltyLikelihood(const ParameterSet& parSet_) {
       }
     }
     else{
-      // make delta vector
-      parSet_.updateDeltaVector();
-
       // compute penalty term with covariance
-      buffer =
-          (*parSet_.getDeltaVectorPtr())
-          * ( (*parSet_.getInverseStrippedCovarianceMatrix()) * (*parSet_.getDeltaVectorPtr()) );
+      buffer = parSet_.evalCovariancePenalty();
     }
   }
 
@@ -5,6 +5,8 @@
 #include "ParameterScanner.h"
 #include "Propagator.h"
 #include "Parameter.h"
+#include "GundamGlobals.h"
+#include "ForkedWorkers.h"
 
 #include "GenericToolbox.Utils.h"
 
@@ -28,6 +30,8 @@ void ParameterScanner::configureImpl() {
   GenericToolbox::Json::fillValue(_config_, _nbPoints_, "nbPoints");
   GenericToolbox::Json::fillValue(_config_, _varsConfig_, "varsConfig");
   GenericToolbox::Json::fillValue(_config_, _nbPointsLineScan_, "nbPointsLineScan");
+  GenericToolbox::Json::fillValue(_config_, _nbPointsPerBatch_, "nbPointsPerBatch");
+  GenericToolbox::Json::fillValue(_config_, _nbScanProcesses_, "nbScanProcesses");
   GenericToolbox::Json::fillValue(_config_, _useParameterLimits_, "useParameterLimits");
   GenericToolbox::Json::fillValue(_config_, _parameterSigmaRange_, "parameterSigmaRange");
 
@@ -36,6 +40,8 @@ void ParameterScanner::initializeImpl() {
   LogWarning << "Initializing ParameterScanner..." << std::endl;
 
   LogThrowIf(_likelihoodInterfacePtr_ == nullptr, "_likelihoodInterfacePtr_ not set.");
+  LogThrowIf(_nbPointsPerBatch_ < 1, "Invalid nbPointsPerBatch: " << _nbPointsPerBatch_);
+  LogThrowIf(_nbScanProcesses_ < 1, "Invalid nbScanProcesses: " << _nbScanProcesses_);
 
   _scanDataDict_.clear();
   if( GenericToolbox::Json::fetchValue(_varsConfig_, "llh", true) ){
@@ -165,6 +171,7 @@ void ParameterScanner::scanParameter(Parameter& par_, TDirectory* saveDir_) {
     highBound = std::min(highBound, par_.getMaxValue());
   }
 
+  std::vector<double> scanValues(_nbPoints_+1,0);
   int offSet{0}; // offset help make sure the first point
   for( int iPt = 0 ; iPt < _nbPoints_+1 ; iPt++ ){
     double newVal = lowBound + double(iPt-offSet)/(_nbPoints_-1)*( highBound - lowBound );
@@ -188,16 +195,29 @@ void ParameterScanner::scanParameter(Parameter& par_, TDirectory* saveDir_) {
             << GET_VAR_NAME_VALUE(par_.getStdDevValue()) << std::endl
     );
 
-    par_.setParameterValue(newVal);
-
-    _likelihoodInterfacePtr_->propagateAndEvalLikelihood();
-    parPoints[iPt] = par_.getParameterValue();
+    scanValues[iPt] = newVal;
+  }
 
-    for( auto& scanEntry : _scanDataDict_ ){
-      double y = scanEntry.evalY();
-      if (std::isnan(y)) y = -2.0;
-      if (not std::isfinite(y)) y = -1.0;
-      scanEntry.yPoints[iPt] = y;
+  auto scanResults = this->evalScanPoints(
+      _nbPoints_+1,
+      [&](int iPt_){ par_.setParameterValue( scanValues[iPt_] ); },
+      [&](){
+        std::vector<double> out{};
+        out.reserve( 1 + _scanDataDict_.size() );
+        out.emplace_back( par_.getParameterValue() );
+        for( auto& scanEntry : _scanDataDict_ ){
+          double y = scanEntry.evalY();
+          if (std::isnan(y)) y = -2.0;
+          if (not std::isfinite(y)) y = -1.0;
+          out.emplace_back( y );
+        }
+        return out;
+      }
+  );
+  for( int iPt = 0 ; iPt < _nbPoints_+1 ; iPt++ ){
+    parPoints[iPt] = scanResults[iPt][0];
+    for( size_t iEntry = 0 ; iEntry < _scanDataDict_.size() ; iEntry++ ){
+      _scanDataDict_[iEntry].yPoints[iPt] = scanResults[iPt][1 + iEntry];
     }
   }
 
@@ -292,14 +312,14 @@ void ParameterScanner::scanSegment(TDirectory *saveDir_, const JsonType &end_, c
   ss << LogWarning.getPrefixString() << "Scanning...";
 
   LogInfo << "Scanning along the line..." << std::endl;
-  for( int iStep = 0 ; iStep < nTotalSteps ; iStep++ ){
-    if( not Logger::isMuted() ){ GenericToolbox::displayProgressBar(iStep, nTotalSteps-1, ss.str()); }
+  auto moveToStepFct = [&](int iStep_){
+    if( not Logger::isMuted() ){ GenericToolbox::displayProgressBar(iStep_, nTotalSteps-1, ss.str()); }
 
     for( size_t iPar = 0 ; iPar < startPointParValList.size() ; iPar++ ){
       auto* par = startPointParValList[iPar].first;
       par->setParameterValue(
           startPointParValList[iPar].second
-          + ( endPointParValList[iPar].second - startPointParValList[iPar].second ) * double(iStep) / double(nTotalSteps-1)
+          + ( endPointParValList[iPar].second - startPointParValList[iPar].second ) * double(iStep_) / double(nTotalSteps-1)
       );
     }
 
@@ -310,14 +330,28 @@ void ParameterScanner::scanSegment(TDirectory *saveDir_, const JsonType &end_, c
         parSet.propagateOriginalToEigen();
       }
     }
-
-    _likelihoodInterfacePtr_->propagateAndEvalLikelihood();
-
-    for( auto& graphEntry : _graphEntriesBuf_ ){
-      graphEntry.graph.SetPointX(iStep, graphEntry.fitParPtr->getParameterValue());
-      graphEntry.graph.SetPointY(iStep, graphEntry.scanDataPtr->evalY());
+  };
+  auto scanResults = this->evalScanPoints(
+      nTotalSteps,
+      moveToStepFct,
+      [&](){
+        // x: the parameter values, then y: the scanned quantities
+        std::vector<double> out{};
+        out.reserve( startPointParValList.size() + _scanDataDict_.size() );
+        for( auto& parPair : startPointParValList ){ out.emplace_back( parPair.first->getParameterValue() ); }
+        for( auto& scanData : _scanDataDict_ ){ out.emplace_back( scanData.evalY() ); }
+        return out;
+      }
+  );
+  for( int iStep = 0 ; iStep < nTotalSteps ; iStep++ ){
+    size_t iEntry{0};
+    for( size_t iScanData = 0 ; iScanData < _scanDataDict_.size() ; iScanData++ ){
+      for( size_t iPar = 0 ; iPar < startPointParValList.size() ; iPar++ ){
+        auto& graphEntry = _graphEntriesBuf_[iEntry++];
+        graphEntry.graph.SetPointX(iStep, scanResults[iStep][iPar]);
+        graphEntry.graph.SetPointY(iStep, scanResults[iStep][startPointParValList.size() + iScanData]);
+      }
     }
-
   }
 
   LogInfo << "Writing scan line graph in file..." << std::endl;
@@ -538,6 +572,54 @@ void ParameterScanner::varyEvenRates(const std::vector<double>& paramVariationLi
   }
 }
 
+std::vector<std::vector<double>> ParameterScanner::evalScanPoints(
+    int nPoints_,
+    const std::function<void(int)>& moveToPointFct_,
+    const std::function<std::vector<double>()>& readPointFct_
+){
+  std::vector<std::vector<double>> out(nPoints_);
+
+  // the points are propagated by batches: one pass over the events per batch
+  auto evalPointListFct = [&](const std::vector<int>& pointList_){
+    for( size_t iFirst = 0 ; iFirst < pointList_.size() ; iFirst += _nbPointsPerBatch_ ){
+      _likelihoodInterfacePtr_->propagateAndEvalLikelihoodBatch(
+          int( std::min(size_t(_nbPointsPerBatch_), pointList_.size() - iFirst) ),
+          [&](int iPoint_){ moveToPointFct_( pointList_[iFirst + iPoint_] ); },
+          [&](int iPoint_){ out[pointList_[iFirst + iPoint_]] = readPointFct_(); }
+      );
+    }
+  };
+
+  int nProcesses{std::min(_nbScanProcesses_, nPoints_)};
+#ifdef GUNDAM_USING_CACHE_MANAGER
+  // the device context can't be shared with forked processes
+  if( GundamGlobals::isCacheManagerEnabled() ){ nProcesses = 1; }
+#endif
+
+  if( nProcesses <= 1 ){
+    std::vector<int> pointList(nPoints_);
+    for( int iPoint = 0 ; iPoint < nPoints_ ; iPoint++ ){ pointList[iPoint] = iPoint; }
+    evalPointListFct( pointList );
+    return out;
+  }
+
+  ForkedWorkers::run(
+      nProcesses, nPoints_, "scan process",
+      [&](){
+        // only this thread survived the fork, the thread pools can't be used
+        _likelihoodInterfacePtr_->getModelPropagator().setDevSingleThreadReweight( true );
+        _likelihoodInterfacePtr_->getModelPropagator().setDevSingleThreadHistFill( true );
+      },
+      [&](const std::vector<int>& pointList_, const ForkedWorkers::SendFct& sendFct_){
+        evalPointListFct( pointList_ );
+        for( int iPoint : pointList_ ){ sendFct_( iPoint, out[iPoint] ); }
+      },
+      [&](int iPoint_, const std::vector<double>& values_){ out[iPoint_] = values_; }
+  );
+
+  return out;
+}
+
 // statics
 void ParameterScanner::writeGraphEntry(GraphEntry& entry_, TDirectory* saveDir_){
   entry_.graph.SetTitle(entry_.scanDataPtr->title.c_str());
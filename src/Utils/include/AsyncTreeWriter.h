@@ -0,0 +1,181 @@
+#ifndef GUNDAM_ASYNC_TREE_WRITER_H
+#define GUNDAM_ASYNC_TREE_WRITER_H
+
+#include "TTree.h"
+#include "TDirectory.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+/*
+  The AsyncFileWriter runs the I/O of one output file on a single
+  background thread.  ROOT can't write to the same file from several threads
+  at once, so every tree of the file (and any other object written while
+  the thread runs) must go through the same AsyncFileWriter.  The tasks are
+  run in the order they have been posted.
+*/
+
+class AsyncFileWriter{
+
+public:
+  explicit AsyncFileWriter(int queueSize_ = 1000);
+  ~AsyncFileWriter();
+
+  AsyncFileWriter(const AsyncFileWriter&) = delete;
+  AsyncFileWriter& operator=(const AsyncFileWriter&) = delete;
+
+  /// Queue a task for the I/O thread (started at the first post).  This
+  /// blocks if the queue is full.
+  void post(std::function<void()> task_);
+
+  /// Wait for every posted task to be done.
+  void wait();
+
+  /// Wait for the queue, and stop the I/O thread.
+  void stop();
+
+private:
+  void ioLoop();
+
+  size_t _queueSize_{1000};
+  std::mutex _mutex_{};
+  std::condition_variable _notEmpty_{};
+  std::condition_variable _notFull_{};
+  std::condition_variable _isIdle_{};
+  std::deque<std::function<void()>> _queue_{};
+  bool _isRunningTask_{false};
+  bool _isStopRequested_{false};
+  std::thread _ioThread_{};
+
+};
+
+
+/*
+  The AsyncTreeWriter fills a TTree from the thread of an AsyncFileWriter.
+  The branches are declared (as usual) on a "source" tree that is never
+  filled.  Each call to fill() takes a copy of the current values of the
+  source branches and queues it, and the I/O thread fills the output tree
+  (which has the same name and branches).  The supported branch types are
+  int, float, double, std::vector<float> and std::vector<double>.
+
+  Optionally, only one entry out of "stride" is written (forced entries are
+  always written), std::vector<double> branches can be stored as floats, and
+  a running mean and covariance of one std::vector<float> branch is kept
+  over all the entries (including the ones that are not written).
+*/
+
+class AsyncTreeWriter{
+
+public:
+  /// Attach to the branches of sourceTree_.  The output tree is created in
+  /// the current directory, by the I/O thread of fileWriter_, at the first
+  /// fill (so the branches can still be added until then).  The trees of
+  /// the same file must share the same fileWriter_.
+  AsyncTreeWriter(TTree* sourceTree_, std::shared_ptr<AsyncFileWriter> fileWriter_);
+  ~AsyncTreeWriter();
+
+  AsyncTreeWriter(const AsyncTreeWriter&) = delete;
+  AsyncTreeWriter& operator=(const AsyncTreeWriter&) = delete;
+
+  // setters (used at the first fill)
+  void setStride(int stride_){ _stride_ = std::max(1, stride_); }
+  void setFloatBranchList(const std::vector<std::string>& floatBranchList_);
+  void setStatisticsBranch(const std::string& statisticsBranch_);
+
+  // setters
+  void setStatisticsEnabled(bool isStatisticsEnabled_){ _isStatisticsEnabled_ = isStatisticsEnabled_; }
+
+  // getters
+  [[nodiscard]] const std::shared_ptr<AsyncFileWriter>& getFileWriter() const { return _fileWriter_; }
+
+  /// Copy the current values of the source branches, and queue them to be
+  /// written.  This blocks if the queue is full.  A forced entry is always
+  /// written (even when it's thinned out by the stride).
+  void fill(bool force_ = false);
+
+  /// Write the output tree to its directory along with the statistics
+  /// (<tree>_mean and <tree>_covariance) if they have been accumulated,
+  /// and wait for it to be done.  The I/O thread keeps serving the other
+  /// trees of the file.
+  void close();
+
+private:
+  enum class Type{ Int, Float, Double, VectorFloat, VectorDouble };
+
+  struct Column{
+    std::string name{};
+    Type type{Type::Double};
+    bool storeAsFloat{false};
+    const void* source{nullptr};
+    size_t slot{0}; // index of the value in the entry
+
+    // output buffers
+    int intValue{0};
+    float floatValue{0};
+    double doubleValue{0};
+    std::vector<float> floatVector{};
+    std::vector<double> doubleVector{};
+  };
+
+  struct Entry{
+    bool isWritten{false};
+    bool isAccumulated{false};
+    std::vector<double> scalarList{};
+    std::vector<std::vector<float>> floatVectorList{};
+    std::vector<std::vector<double>> doubleVectorList{};
+  };
+
+  void defineColumns();
+  void start();
+  void createOutputTree();
+  void writeOutput();
+  void writeEntry(Entry& entry_);
+  void accumulate(const std::vector<float>& point_);
+
+  // parameters
+  int _stride_{1};
+  std::vector<std::string> _floatBranchList_{};
+  std::string _statisticsBranch_{};
+  bool _isStatisticsEnabled_{true};
+
+  // internals
+  TTree* _sourceTree_{nullptr};
+  TTree* _outputTree_{nullptr};
+  TDirectory* _outputDir_{nullptr};
+  std::vector<Column> _columnList_{};
+  size_t _nScalars_{0};
+  size_t _nFloatVectors_{0};
+  size_t _nDoubleVectors_{0};
+  int _statisticsColumn_{-1};
+  long _nFills_{0};
+  bool _isStarted_{false};
+  bool _isClosed_{false};
+
+  // the I/O thread, and a pool of used entries to avoid reallocating the vectors
+  std::shared_ptr<AsyncFileWriter> _fileWriter_{};
+  std::mutex _poolMutex_{};
+  std::vector<Entry> _entryPool_{};
+
+  // running statistics (only touched by the I/O thread)
+  double _nSamples_{0};
+  std::vector<double> _mean_{};
+  std::vector<double> _covariance_{}; // lower triangle: i*(i+1)/2+j
+  std::vector<double> _delta_{};
+
+};
+
+
+#endif //GUNDAM_ASYNC_TREE_WRITER_H
+
+// Local Variables:
+// mode:c++
+// c-basic-offset:2
+// End:
@@ -25,6 +25,8 @@
 #define DEVICE_FLOATING_POINT double
 #endif
 
+#include "CalculateSegmentHint.h"
+
 // Place in a private name space so it plays nicely with CUDA
 namespace {
     // Interpolate one point a spline with non-uniform points.  The spline can
@@ -46,11 +48,14 @@ namespace {
     // CalculateCompactSpline, and CalculateMonotonicSpline have very similar,
     // but different calls.  In particular the dim parameter meaning is not
     // consistent.
+    //
+    // The knot search (FindGeneralSplineSegment) and the interpolation
+    // (CalculateGeneralSplineSegment) are split so that the segment can
+    // also come from a hint (see CalculateGeneralSplineHinted).
     DEVICE_CALLABLE_INLINE
-    double CalculateGeneralSpline(const double x,
-                                  const double lowerBound, double upperBound,
-                                  const DEVICE_FLOATING_POINT* data,
-                                  const int dim) {
+    int FindGeneralSplineSegment(const double x,
+                                 const DEVICE_FLOATING_POINT* data,
+                                 const int dim) {
 
 #if defined(CALCULATE_GENERAL_SPLINE_LINEAR_IF)
 #warning USING CALCULATE_GENERAL_SPLINE_LINEAR_IF
@@ -132,6 +137,29 @@ namespace {
         CHECK_OFFSET(2);
         CHECK_OFFSET(1);
 #endif
+        return ix;
+    }
+
+    // The largest segment which can be returned by FindGeneralSplineSegment,
+    // or -1 if the search isn't the binary search.
+    DEVICE_CALLABLE_INLINE
+    int GetGeneralSplineMaxSegment(const int dim) {
+#if defined(CALCULATE_GENERAL_SPLINE_LINEAR_IF) || defined(CALCULATE_GENERAL_SPLINE_LINEAR_MULT)
+        return -1;
+#else
+        const int maxSegment = (dim-2)/3 - 3;
+        if (maxSegment < 0) return 0;
+        if (maxSegment > 15) return 15;
+        return maxSegment;
+#endif
+    }
+
+    // Interpolate in the segment between knot ix and knot ix+1.
+    DEVICE_CALLABLE_INLINE
+    double CalculateGeneralSplineSegment(const double x,
+                                         const double lowerBound, double upperBound,
+                                         const DEVICE_FLOATING_POINT* data,
+                                         const int ix) {
         const double x1 = data[2+3*ix+2];
         const double x2 = data[2+3*(ix+1)+2];
         const double step = x2-x1;
@@ -158,6 +186,36 @@ namespace {
 
         return v;
     }
+
+    DEVICE_CALLABLE_INLINE
+    double CalculateGeneralSpline(const double x,
+                                  const double lowerBound, double upperBound,
+                                  const DEVICE_FLOATING_POINT* data,
+                                  const int dim) {
+        return CalculateGeneralSplineSegment(
+            x, lowerBound, upperBound, data,
+            FindGeneralSplineSegment(x, data, dim));
+    }
+
+    // Same as CalculateGeneralSpline, but the segment of the previous call
+    // (kept in the hint) is checked before running the search.  The
+    // segment is the same as the one found by the search.
+    DEVICE_CALLABLE_INLINE
+    double CalculateGeneralSplineHinted(const double x,
+                                        const double lowerBound, double upperBound,
+                                        const DEVICE_FLOATING_POINT* data,
+                                        const int dim,
+                                        SegmentHint& hint) {
+        ++hint.nCalls;
+        if (CheckSegmentHint(x, data+4, 3, GetGeneralSplineMaxSegment(dim), hint.segment)) {
+            ++hint.nHits;
+        }
+        else {
+            hint.segment = FindGeneralSplineSegment(x, data, dim);
+        }
+        return CalculateGeneralSplineSegment(
+            x, lowerBound, upperBound, data, hint.segment);
+    }
 }
 
 // An MIT Style License
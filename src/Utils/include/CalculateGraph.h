@@ -24,6 +24,8 @@
 #define DEVICE_FLOATING_POINT double
 #endif
 
+#include "CalculateSegmentHint.h"
+
 // Place in a private name space so it plays nicely with CUDA
 namespace {
     /// Interpolate one point in a graph with non-uniform points.  The graph can
@@ -40,15 +42,14 @@ namespace {
     /// CalculateCompactSpline, and CalculateMonotonicSpline have very similar,
     /// but different calls.  In particular the dim parameter meaning is not
     /// consistent.
+    ///
+    /// The knot search (FindGraphSegment) and the interpolation
+    /// (CalculateGraphSegment) are split so that the segment can also come
+    /// from a hint (see CalculateGraphHinted).
     DEVICE_CALLABLE_INLINE
-    double CalculateGraph(const double x,
-                          const double lowerBound, double upperBound,
-                          const DEVICE_FLOATING_POINT* data,
-                          const int dim) {
-
-        // Short circuit 1 point graphs.
-        if (dim < 4) return data[0];
-
+    int FindGraphSegment(const double x,
+                         const DEVICE_FLOATING_POINT* data,
+                         const int dim) {
         // Check to find a point that is less than x.  This is "brute force"
         // binary search for upto 16 elements.  The "if" has been checked and
         // is efficient with CUDA.
@@ -59,7 +60,24 @@ namespace {
         CHECK_OFFSET(4);
         CHECK_OFFSET(2);
         CHECK_OFFSET(1);
+        return ix;
+    }
+
+    /// The largest segment which can be returned by FindGraphSegment.
+    DEVICE_CALLABLE_INLINE
+    int GetGraphMaxSegment(const int dim) {
+        const int maxSegment = (dim)/2 - 1;
+        if (maxSegment < 0) return 0;
+        if (maxSegment > 15) return 15;
+        return maxSegment;
+    }
 
+    /// Interpolate in the segment between knot ix and knot ix+1.
+    DEVICE_CALLABLE_INLINE
+    double CalculateGraphSegment(const double x,
+                                 const double lowerBound, double upperBound,
+                                 const DEVICE_FLOATING_POINT* data,
+                                 const int ix) {
         const double p1 = data[2*ix];
         const double x1 = data[2*ix+1];
 
@@ -79,6 +97,43 @@ namespace {
 
         return v;
     }
+
+    DEVICE_CALLABLE_INLINE
+    double CalculateGraph(const double x,
+                          const double lowerBound, double upperBound,
+                          const DEVICE_FLOATING_POINT* data,
+                          const int dim) {
+
+        // Short circuit 1 point graphs.
+        if (dim < 4) return data[0];
+
+        return CalculateGraphSegment(x, lowerBound, upperBound, data,
+                                     FindGraphSegment(x, data, dim));
+    }
+
+    /// Same as CalculateGraph, but the segment of the previous call (kept in
+    /// the hint) is checked before running the search.  The segment is the
+    /// same as the one found by the search.
+    DEVICE_CALLABLE_INLINE
+    double CalculateGraphHinted(const double x,
+                                const double lowerBound, double upperBound,
+                                const DEVICE_FLOATING_POINT* data,
+                                const int dim,
+                                SegmentHint& hint) {
+
+        // Short circuit 1 point graphs.
+        if (dim < 4) return data[0];
+
+        ++hint.nCalls;
+        if (CheckSegmentHint(x, data+1, 2, GetGraphMaxSegment(dim), hint.segment)) {
+            ++hint.nHits;
+        }
+        else {
+            hint.segment = FindGraphSegment(x, data, dim);
+        }
+        return CalculateGraphSegment(x, lowerBound, upperBound, data,
+                                     hint.segment);
+    }
 }
 
 #ifdef TEST_CALCULATE_GRAPH
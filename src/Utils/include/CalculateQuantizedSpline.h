@@ -0,0 +1,92 @@
+#ifndef GUNDAM_CALCULATE_QUANTIZED_SPLINE_H
+#define GUNDAM_CALCULATE_QUANTIZED_SPLINE_H
+
+// A spline with uniformly spaced knots (see CalculateUniformSpline) whose
+// knot values and slopes are stored as 16 bit fixed point numbers, relative
+// to an offset and a scale shared by the knots of the spline.  The knot
+// values are responses close to one, so 16 bits are usually enough: the
+// largest error on a knot value is half of the scale.
+
+#include <cstdint>
+
+#ifndef DEVICE_CALLABLE_INLINE
+#ifdef __CUDACC__
+#define DEVICE_CALLABLE_INLINE __host__ __device__ inline
+#else
+#define DEVICE_CALLABLE_INLINE /* __host__ __device__ inline */
+#endif
+#endif
+
+namespace {
+    // The largest code of the fixed point numbers.
+    constexpr double QuantizedSplineMaxCode{65535.0};
+
+    // The code of a value in [offset, offset + scale*QuantizedSplineMaxCode].
+    inline std::uint16_t EncodeQuantizedSplineValue(const double value,
+                                                    const double offset,
+                                                    const double scale) {
+        if (!(scale > 0.0)) return 0;
+        double code = (value - offset)/scale + 0.5;
+        if (code < 0.0) code = 0.0;
+        if (code > QuantizedSplineMaxCode) code = QuantizedSplineMaxCode;
+        return std::uint16_t(code);
+    }
+
+    DEVICE_CALLABLE_INLINE
+    double DecodeQuantizedSplineValue(const std::uint16_t code,
+                                      const double offset,
+                                      const double scale) {
+        return offset + scale*code;
+    }
+
+    // Interpolate one point of a quantised spline.  The spline is given by
+    //
+    // header[0] -- spline lower bound
+    // header[1] -- spline step
+    // header[2], header[3] -- the offset and scale of the knot values
+    // header[4], header[5] -- the offset and scale of the knot slopes
+    // codes[2*n+0] -- The code of the function value for knot n
+    // codes[2*n+1] -- The code of the function slope for knot n
+    //
+    // and nKnots is the number of knots (at least two).  The calculation is
+    // the one of CalculateUniformSpline once the knots are decoded.
+    DEVICE_CALLABLE_INLINE
+    double CalculateQuantizedSpline(const double x,
+                                    const double lowerBound, double upperBound,
+                                    const double* header,
+                                    const std::uint16_t* codes,
+                                    const int nKnots) {
+
+        // Get the integer part
+        const double step = header[1];
+        const double xx = (x-header[0])/step;
+        int ix = xx;
+        if (ix<0) ix=0;
+        if (ix>nKnots-2) ix = nKnots-2;
+
+        const double fx = xx-ix;
+
+        const double p1 = DecodeQuantizedSplineValue(codes[2*ix], header[2], header[3]);
+        const double m1 = DecodeQuantizedSplineValue(codes[2*ix+1], header[4], header[5])*step;
+        const double p2 = DecodeQuantizedSplineValue(codes[2*ix+2], header[2], header[3]);
+        const double m2 = DecodeQuantizedSplineValue(codes[2*ix+3], header[4], header[5])*step;
+
+        // Factored via Horner's method.
+        double v = ((((2.0*p1 - 2.0*p2 + m2 + m1)*fx
+                      + 3.0*p2 - 3.0*p1 - m2 - 2.0*m1)*fx
+                     +m1)*fx
+                    +p1);
+
+        if (v < lowerBound) v = lowerBound;
+        if (v > upperBound) v = upperBound;
+
+        return v;
+    }
+}
+
+#endif //GUNDAM_CALCULATE_QUANTIZED_SPLINE_H
+
+// Local Variables:
+// mode:c++
+// c-basic-offset:4
+// End:
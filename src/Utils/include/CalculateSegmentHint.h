@@ -0,0 +1,56 @@
+#ifndef GUNDAM_CALCULATE_SEGMENT_HINT_H
+#define GUNDAM_CALCULATE_SEGMENT_HINT_H
+
+// The knot search of the general splines and of the graphs can be skipped
+// when the input is still in the segment found by the previous call.  The
+// parameters usually move by small steps (minimizer iterations, MCMC
+// steps), so keeping the last segment of each parameter avoids most of the
+// searches.  The hint only has to be kept for a parameter, not for a dial:
+// the hinted segment is checked against the knots of the dial, and the
+// search is run if it doesn't match.
+
+#ifndef DEVICE_CALLABLE_INLINE
+#ifdef __CUDACC__
+#define DEVICE_CALLABLE_INLINE __host__ __device__ inline
+#else
+#define DEVICE_CALLABLE_INLINE /* __host__ __device__ inline */
+#endif
+#endif
+
+#ifndef DEVICE_FLOATING_POINT
+#define DEVICE_FLOATING_POINT double
+#endif
+
+// The last segment, and the counters to monitor the hit rate.
+struct SegmentHint {
+    int segment{0};
+    long nHits{0};
+    long nCalls{0};
+};
+
+namespace {
+    // The searches return the last segment ix in [0, maxSegment] with
+    // "ix == 0 or x > knotX[stride*ix]".  Check if the hinted segment is
+    // still that segment for x (false if maxSegment is negative).  This is
+    // always inline since the header is included by the dial collections.
+#ifdef __CUDACC__
+    __host__ __device__
+#endif
+    inline bool CheckSegmentHint(const double x,
+                                 const DEVICE_FLOATING_POINT* knotX,
+                                 const int stride,
+                                 const int maxSegment,
+                                 const int segment) {
+        if (segment < 0 || segment > maxSegment) return false;
+        if (segment > 0 && !(x > knotX[stride*segment])) return false;
+        if (segment < maxSegment && x > knotX[stride*(segment+1)]) return false;
+        return true;
+    }
+}
+
+#endif //GUNDAM_CALCULATE_SEGMENT_HINT_H
+
+// Local Variables:
+// mode:c++
+// c-basic-offset:4
+// End:
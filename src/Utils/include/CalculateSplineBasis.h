@@ -0,0 +1,142 @@
+#ifndef GUNDAM_CALCULATE_SPLINE_BASIS_H
+#define GUNDAM_CALCULATE_SPLINE_BASIS_H
+
+#include <vector>
+
+
+/*
+  The compact, uniform and general splines are linear in their knot values:
+  for a given input, the response is a weighted sum of (at most) four values
+  of the spline data.  The weights and the positions of these values only
+  depend on the knot grid (the x positions of the knots), so a list of
+  splines sharing the same grid and evaluated at the same input can reuse a
+  single SplineBasis.  The data layouts are the ones of the Calculate*.h
+  kernels.
+
+  The basis gives the same responses as the kernels up to the rounding
+  (the operations are not done in the same order).  The monotonic splines
+  aren't linear (the slopes are limited), so they don't have a basis.
+*/
+
+struct SplineBasis{
+  int nTerms{0};
+  int offset[4]{0, 0, 0, 0};
+  double weight[4]{0, 0, 0, 0};
+};
+
+namespace {
+
+  // The cubic Hermite polynomials (value and slope at both ends of the segment)
+  inline void FillHermiteWeights(const double fx, double* h_){
+    const double fx2{fx*fx};
+    const double fx3{fx2*fx};
+    h_[0] = 2.0*fx3 - 3.0*fx2 + 1.0; // p1
+    h_[1] = fx3 - 2.0*fx2 + fx;      // m1
+    h_[2] = -2.0*fx3 + 3.0*fx2;      // p2
+    h_[3] = fx3 - fx2;               // m2
+  }
+
+  // See CalculateCompactSpline: the slopes are the averages of the
+  // neighbouring differences, so the response depends on up to four
+  // consecutive knots.
+  inline void CalculateCompactSplineBasis(const double x, const double* data, const int dim, SplineBasis& basis){
+    const double xx = (x-data[0])/data[1];
+    const int ix = (xx<0) ? xx-1: xx;
+
+    auto clampIndex = [&](int i_){ return (i_ < 0) ? 0 : (i_ > dim-2) ? dim-2 : i_; };
+    const int d21_0 = clampIndex(ix-1);
+    const int d32_0 = clampIndex(ix);
+    const int d43_0 = clampIndex(ix+1);
+
+    double h[4];
+    FillHermiteWeights(xx-d32_0, h);
+
+    // indices relative to d21_0
+    basis.nTerms = d43_0 + 2 - d21_0;
+    for( int iTerm = 0 ; iTerm < 4 ; iTerm++ ){
+      basis.offset[iTerm] = 2 + d21_0 + iTerm;
+      basis.weight[iTerm] = 0;
+    }
+    auto add = [&](int knot_, double weight_){ basis.weight[knot_ - d21_0] += weight_; };
+    add(d32_0, h[0]);
+    add(d32_0+1, h[2]);
+    // m2 = 0.5*(d21+d32)
+    add(d21_0+1, 0.5*h[1]); add(d21_0, -0.5*h[1]);
+    add(d32_0+1, 0.5*h[1]); add(d32_0, -0.5*h[1]);
+    // m3 = 0.5*(d32+d43)
+    add(d32_0+1, 0.5*h[3]); add(d32_0, -0.5*h[3]);
+    add(d43_0+1, 0.5*h[3]); add(d43_0, -0.5*h[3]);
+  }
+
+  // See CalculateUniformSpline: (value, slope) pairs
+  inline void CalculateUniformSplineBasis(const double x, const double* data, const int dim, SplineBasis& basis){
+    const double step = data[1];
+    const double xx = (x-data[0])/step;
+    int ix = xx;
+    if (ix<0) ix=0;
+    if (2*ix+7>dim) ix = (dim-2)/2 - 2 ;
+
+    double h[4];
+    FillHermiteWeights(xx-ix, h);
+
+    basis.nTerms = 4;
+    for( int iTerm = 0 ; iTerm < 4 ; iTerm++ ){ basis.offset[iTerm] = 2 + 2*ix + iTerm; }
+    basis.weight[0] = h[0]; basis.weight[1] = h[1]*step;
+    basis.weight[2] = h[2]; basis.weight[3] = h[3]*step;
+  }
+
+  // See CalculateGeneralSpline: (value, slope, x) triplets
+  inline void CalculateGeneralSplineBasis(const double x, const double* data, const int dim, SplineBasis& basis){
+    const int knotCount = (dim-2)/3 - 2;
+    int ix = 0;
+    for( int iOffset : {8, 4, 2, 1} ){
+      if ((ix+iOffset < knotCount) && (x > data[2+3*(ix+iOffset)+2])) ix += iOffset;
+    }
+    const double x1 = data[2+3*ix+2];
+    const double step = data[2+3*(ix+1)+2]-x1;
+
+    double h[4];
+    FillHermiteWeights((x - x1)/step, h);
+
+    basis.nTerms = 4;
+    basis.offset[0] = 2+3*ix;     basis.weight[0] = h[0];
+    basis.offset[1] = 2+3*ix+1;   basis.weight[1] = h[1]*step;
+    basis.offset[2] = 2+3*ix+3;   basis.weight[2] = h[2];
+    basis.offset[3] = 2+3*ix+4;   basis.weight[3] = h[3]*step;
+  }
+
+  // The values which define the basis of each layout (dim included)
+  inline void GetCompactSplineGrid(const double* data, const int dim, std::vector<double>& grid){
+    grid.assign({double(dim), data[0], data[1]});
+  }
+  inline void GetUniformSplineGrid(const double* data, const int dim, std::vector<double>& grid){
+    grid.assign({double(dim), data[0], data[1]});
+  }
+  inline void GetGeneralSplineGrid(const double* data, const int dim, std::vector<double>& grid){
+    grid.assign({double(dim)});
+    for( int iKnot = 0 ; 2+3*iKnot+2 < dim ; iKnot++ ){ grid.emplace_back( data[2+3*iKnot+2] ); }
+  }
+
+  inline double CalculateSplineFromBasis(const SplineBasis& basis,
+                                         const double lowerBound, double upperBound,
+                                         const double* data){
+    double v{0};
+    for( int iTerm = 0 ; iTerm < basis.nTerms ; iTerm++ ){
+      v += basis.weight[iTerm] * data[basis.offset[iTerm]];
+    }
+
+    if (v < lowerBound) v = lowerBound;
+    if (v > upperBound) v = upperBound;
+
+    return v;
+  }
+
+}
+
+
+#endif //GUNDAM_CALCULATE_SPLINE_BASIS_H
+
+// Local Variables:
+// mode:c++
+// c-basic-offset:2
+// End:
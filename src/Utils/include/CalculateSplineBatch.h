@@ -0,0 +1,101 @@
+#ifndef GUNDAM_CALCULATE_SPLINE_BATCH_H
+#define GUNDAM_CALCULATE_SPLINE_BATCH_H
+
+
+/*
+  Batch versions of the Calculate*.h kernels: a whole list of dials of the
+  same type is evaluated in one call.  The uniform knot kernels (compact,
+  uniform and monotonic splines) have AVX2 and AVX-512 implementations which
+  evaluate 4 or 8 dials at once.  The instruction set is picked at runtime
+  (see getIsa()), and the portable implementation, which calls the scalar
+  kernel, is used everywhere else.  The knot search of the general splines
+  and of the graphs depends on the data, so these always use the portable
+  loop.
+
+  All the implementations perform the same floating point operations as the
+  scalar kernels (the sources are compiled without FMA contraction), so the
+  results are identical.
+*/
+
+namespace SplineBatch{
+
+  enum class Isa{ Portable = 0, Avx2, Avx512 };
+
+  /// The instruction set used by the batch kernels.  This is the best one
+  /// supported by the CPU, unless it has been changed with setIsa().
+  Isa getIsa();
+
+  /// Change the instruction set (e.g. for benchmarking).  An instruction set
+  /// which isn't supported (by the CPU, or by the build) is replaced by the
+  /// best supported one.
+  void setIsa(Isa isa_);
+
+  Isa getBestSupportedIsa();
+  const char* getIsaName(Isa isa_);
+
+  /// The dials to evaluate.  Dial i is evaluated at x[i] with the knots
+  /// data[i] (dim[i] has the same meaning as for the scalar kernel), and the
+  /// response is clamped between lowerBound[i] and upperBound[i].  The
+  /// responses are written to result[i].
+  struct Batch{
+    int size{0};
+    const double* x{nullptr};
+    const double* lowerBound{nullptr};
+    const double* upperBound{nullptr};
+    const double* const* data{nullptr};
+    const int* dim{nullptr};
+    double* result{nullptr};
+  };
+
+  void evalCompactSpline(const Batch& batch_);
+  void evalUniformSpline(const Batch& batch_);
+  void evalMonotonicSpline(const Batch& batch_);
+  void evalGeneralSpline(const Batch& batch_);
+  void evalGraph(const Batch& batch_);
+
+  typedef void (*BatchFct)(const Batch& batch_);
+
+  /// Evaluate the splines stored the Cache::Weight way: the knots of spline
+  /// i are knots[knotIndex[i]] to knots[knotIndex[i+1]], the spline is
+  /// evaluated at params[parIndex[i]] and clamped with the clamps of the
+  /// same parameter.  The response multiplies results[resIndex[i]].
+  /// dimOffset_ is added to the number of knot values to get dim.
+  template<typename ParIndex>
+  void evalIndexed(BatchFct batchFct_, int dimOffset_, int nSplines_, double* results_,
+                   const double* params_, const double* lowerClamp_, const double* upperClamp_,
+                   const double* knots_, const int* resIndex_, const ParIndex* parIndex_, const int* knotIndex_){
+    constexpr int chunkSize{256};
+    double x[chunkSize]; double lowerBound[chunkSize]; double upperBound[chunkSize];
+    const double* data[chunkSize]; int dim[chunkSize]; double result[chunkSize];
+
+    Batch batch;
+    batch.x = x; batch.lowerBound = lowerBound; batch.upperBound = upperBound;
+    batch.data = data; batch.dim = dim; batch.result = result;
+
+    for( int iFirst = 0 ; iFirst < nSplines_ ; iFirst += chunkSize ){
+      batch.size = ( nSplines_ - iFirst < chunkSize ) ? nSplines_ - iFirst : chunkSize;
+      for( int iEntry = 0 ; iEntry < batch.size ; iEntry++ ){
+        const int iSpline{iFirst + iEntry};
+        const int iPar{parIndex_[iSpline]};
+        x[iEntry] = params_[iPar];
+        lowerBound[iEntry] = lowerClamp_[iPar];
+        upperBound[iEntry] = upperClamp_[iPar];
+        data[iEntry] = &knots_[knotIndex_[iSpline]];
+        dim[iEntry] = knotIndex_[iSpline+1] - knotIndex_[iSpline] + dimOffset_;
+      }
+      batchFct_( batch );
+      for( int iEntry = 0 ; iEntry < batch.size ; iEntry++ ){
+        results_[resIndex_[iFirst + iEntry]] *= result[iEntry];
+      }
+    }
+  }
+
+}
+
+
+#endif //GUNDAM_CALCULATE_SPLINE_BATCH_H
+
+// Local Variables:
+// mode:c++
+// c-basic-offset:2
+// End:
@@ -0,0 +1,185 @@
+#ifndef GUNDAM_CALCULATE_SPLINE_BATCH_IMPL_H
+#define GUNDAM_CALCULATE_SPLINE_BATCH_IMPL_H
+
+#include "CalculateSplineBatch.h"
+
+#include "CalculateCompactSpline.h"
+#include "CalculateUniformSpline.h"
+#include "CalculateMonotonicSpline.h"
+
+
+/*
+  The vectorised kernels, written once for any lane type V.  V provides:
+    - D (double lanes), I (int lanes), P (pointer lanes) and width
+    - loadD/storeD/set1D, add/sub/mul/div, neg (sign flip)
+    - select(a, b, x, y): a < b ? x : y, and selectLE(a, b, x, y): a <= b ? x : y
+    - loadP, gather(p, i): p[i]
+    - loadI/set1I, addI/subI/minI/maxI, selectGtI(a, b, x, y): a > b ? x : y
+    - halfI(i): i/2 (rounded toward zero), truncI(d), toD(i)
+  The operations follow the scalar kernels one by one: same order, same
+  comparisons.  This header must only be included by the translation units
+  compiled for a given instruction set (see CalculateSplineBatch.cpp).
+*/
+
+namespace {
+
+  template<typename V>
+  struct SplineBatchKernels{
+
+    // the clamping of the scalar kernels
+    static typename V::D clampResult(typename V::D v_, typename V::D lowerBound_, typename V::D upperBound_){
+      v_ = V::select(v_, lowerBound_, lowerBound_, v_);
+      v_ = V::select(upperBound_, v_, upperBound_, v_);
+      return v_;
+    }
+
+    // Horner's method, as written in the scalar kernels
+    static typename V::D hermite(typename V::D p2_, typename V::D p3_, typename V::D m2_, typename V::D m3_, typename V::D fx_){
+      const typename V::D two{V::set1D(2.0)};
+      const typename V::D three{V::set1D(3.0)};
+      typename V::D v = V::add(V::add(V::sub(V::mul(two, p2_), V::mul(two, p3_)), m3_), m2_);
+      v = V::mul(v, fx_);
+      v = V::sub(V::sub(V::sub(V::add(v, V::mul(three, p3_)), V::mul(three, p2_)), m3_), V::mul(two, m2_));
+      v = V::mul(v, fx_);
+      v = V::add(v, m2_);
+      v = V::mul(v, fx_);
+      return V::add(v, p2_);
+    }
+
+    // The common part of the compact and monotonic splines.
+    struct CatmullRomPoints{
+      typename V::D p2, p3, d21, d32, d43, fx;
+    };
+    static CatmullRomPoints getPoints(const SplineBatch::Batch& batch_, int i_){
+      const typename V::P data{V::loadP(batch_.data + i_)};
+      const typename V::I zero{V::set1I(0)};
+      const typename V::I one{V::set1I(1)};
+      const typename V::I two{V::set1I(2)};
+      const typename V::I dimMinusTwo{V::subI(V::loadI(batch_.dim + i_), two)};
+
+      const typename V::D low{V::gather(data, zero)};
+      const typename V::D step{V::gather(data, one)};
+      const typename V::D xx{V::div(V::sub(V::loadD(batch_.x + i_), low), step)};
+      const typename V::D zeroD{V::set1D(0.0)};
+      const typename V::I ix{V::truncI(V::select(xx, zeroD, V::sub(xx, V::set1D(1.0)), xx))};
+
+      auto clampIndex = [&](typename V::I index_){ return V::minI(V::maxI(index_, zero), dimMinusTwo); };
+      const typename V::I d21_0{clampIndex(V::subI(ix, one))};
+      const typename V::I d32_0{clampIndex(ix)};
+      const typename V::I d43_0{clampIndex(V::addI(ix, one))};
+
+      // knot n is data[2+n]
+      const typename V::I k21_0{V::addI(d21_0, two)};
+      const typename V::I k32_0{V::addI(d32_0, two)};
+      const typename V::I k43_0{V::addI(d43_0, two)};
+
+      CatmullRomPoints out;
+      out.p2 = V::gather(data, k32_0);
+      out.p3 = V::gather(data, V::addI(k32_0, one));
+      out.fx = V::sub(xx, V::toD(d32_0));
+      out.d21 = V::sub(V::gather(data, V::addI(k21_0, one)), V::gather(data, k21_0));
+      out.d32 = V::sub(out.p3, out.p2);
+      out.d43 = V::sub(V::gather(data, V::addI(k43_0, one)), V::gather(data, k43_0));
+      return out;
+    }
+
+    static void evalCompactSpline(const SplineBatch::Batch& batch_){
+      const typename V::D half{V::set1D(0.5)};
+      int i{0};
+      for( ; i + V::width <= batch_.size ; i += V::width ){
+        auto pts = getPoints(batch_, i);
+        const typename V::D m2{V::mul(half, V::add(pts.d21, pts.d32))};
+        const typename V::D m3{V::mul(half, V::add(pts.d32, pts.d43))};
+        V::storeD(batch_.result + i, clampResult(
+            hermite(pts.p2, pts.p3, m2, m3, pts.fx),
+            V::loadD(batch_.lowerBound + i), V::loadD(batch_.upperBound + i)
+        ));
+      }
+      for( ; i < batch_.size ; i++ ){
+        batch_.result[i] = CalculateCompactSpline(batch_.x[i], batch_.lowerBound[i], batch_.upperBound[i], batch_.data[i], batch_.dim[i]);
+      }
+    }
+
+    static void evalMonotonicSpline(const SplineBatch::Batch& batch_){
+      const typename V::D half{V::set1D(0.5)};
+      const typename V::D zeroD{V::set1D(0.0)};
+      const typename V::D three{V::set1D(3.0)};
+      int i{0};
+      for( ; i + V::width <= batch_.size ; i += V::width ){
+        auto pts = getPoints(batch_, i);
+        typename V::D m2{V::mul(half, V::add(pts.d21, pts.d32))};
+        typename V::D m3{V::mul(half, V::add(pts.d32, pts.d43))};
+
+        // Fritsch-Carlson conditions
+        m2 = V::selectLE(V::mul(pts.d32, pts.d21), zeroD, zeroD, m2);
+        m3 = V::selectLE(V::mul(pts.d43, pts.d32), zeroD, zeroD, m3);
+
+        const typename V::D ad21{V::select(pts.d21, zeroD, V::neg(pts.d21), pts.d21)};
+        const typename V::D ad32{V::select(pts.d32, zeroD, V::neg(pts.d32), pts.d32)};
+        const typename V::D ad43{V::select(pts.d43, zeroD, V::neg(pts.d43), pts.d43)};
+
+        const typename V::D delta2{V::mul(three, V::select(ad21, ad32, ad21, ad32))};
+        const typename V::D delta3{V::mul(three, V::select(ad32, ad43, ad32, ad43))};
+
+        m2 = V::select(delta2, m2, delta2, m2);
+        m2 = V::select(m2, V::neg(delta2), V::neg(delta2), m2);
+        m3 = V::select(delta3, m3, delta3, m3);
+        m3 = V::select(m3, V::neg(delta3), V::neg(delta3), m3);
+
+        V::storeD(batch_.result + i, clampResult(
+            hermite(pts.p2, pts.p3, m2, m3, pts.fx),
+            V::loadD(batch_.lowerBound + i), V::loadD(batch_.upperBound + i)
+        ));
+      }
+      for( ; i < batch_.size ; i++ ){
+        batch_.result[i] = CalculateMonotonicSpline(batch_.x[i], batch_.lowerBound[i], batch_.upperBound[i], batch_.data[i], batch_.dim[i]);
+      }
+    }
+
+    static void evalUniformSpline(const SplineBatch::Batch& batch_){
+      const typename V::I zero{V::set1I(0)};
+      const typename V::I one{V::set1I(1)};
+      const typename V::I two{V::set1I(2)};
+      int i{0};
+      for( ; i + V::width <= batch_.size ; i += V::width ){
+        const typename V::P data{V::loadP(batch_.data + i)};
+        const typename V::I dim{V::loadI(batch_.dim + i)};
+
+        const typename V::D step{V::gather(data, one)};
+        const typename V::D xx{V::div(V::sub(V::loadD(batch_.x + i), V::gather(data, zero)), step)};
+        typename V::I ix{V::maxI(V::truncI(xx), zero)};
+        // if (2*ix+7>dim) ix = (dim-2)/2 - 2
+        ix = V::selectGtI(
+            V::addI(V::addI(ix, ix), V::set1I(7)), dim,
+            V::subI(V::halfI(V::subI(dim, two)), two), ix
+        );
+
+        const typename V::D fx{V::sub(xx, V::toD(ix))};
+        const typename V::I k1{V::addI(V::addI(ix, ix), two)};
+
+        const typename V::D p1{V::gather(data, k1)};
+        const typename V::D m1{V::mul(V::gather(data, V::addI(k1, one)), step)};
+        const typename V::D p2{V::gather(data, V::addI(k1, two))};
+        const typename V::D m2{V::mul(V::gather(data, V::addI(k1, V::set1I(3))), step)};
+
+        V::storeD(batch_.result + i, clampResult(
+            hermite(p1, p2, m1, m2, fx),
+            V::loadD(batch_.lowerBound + i), V::loadD(batch_.upperBound + i)
+        ));
+      }
+      for( ; i < batch_.size ; i++ ){
+        batch_.result[i] = CalculateUniformSpline(batch_.x[i], batch_.lowerBound[i], batch_.upperBound[i], batch_.data[i], batch_.dim[i]);
+      }
+    }
+
+  };
+
+}
+
+
+#endif //GUNDAM_CALCULATE_SPLINE_BATCH_IMPL_H
+
+// Local Variables:
+// mode:c++
+// c-basic-offset:2
+// End:
@@ -0,0 +1,89 @@
+#ifndef GUNDAM_CORRELATED_THROW_GENERATOR_H
+#define GUNDAM_CORRELATED_THROW_GENERATOR_H
+
+#include "CovarianceBlocks.h"
+
+#include "TMatrixD.h"
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+
+/*
+  The CorrelatedThrowGenerator draws multivariate normal throws (centered on
+  zero) following a covariance matrix.  The Cholesky factor is computed once
+  and kept as a packed lower triangle, and the throws are generated by
+  blocks: the standard normal numbers of the whole block are drawn from
+  gRandom at once, and the block is multiplied by the factor with a single
+  matrix-matrix product.  The independent blocks of the covariance are
+  factorised separately (see CovarianceBlocks).
+
+  The throws of a given candidate only depend on its position in the random
+  sequence (not on the block it's generated in), so the same gRandom state
+  always gives the same accepted throw.
+*/
+
+class CorrelatedThrowGenerator{
+
+public:
+  CorrelatedThrowGenerator() = default;
+  explicit CorrelatedThrowGenerator(const TMatrixD& covariance_){ this->setCovariance(covariance_); }
+
+  /// Compute the Cholesky factor of the covariance.  Throws if the matrix is
+  /// not positive definite.
+  void setCovariance(const TMatrixD& covariance_);
+
+  /// The maximum number of candidates generated together when throws get
+  /// rejected (see throwAccepted).
+  void setMaxBlockSize(int maxBlockSize_){ _maxBlockSize_ = std::max(1, maxBlockSize_); }
+
+  // getters
+  [[nodiscard]] int getNbDimensions() const { return _nDim_; }
+  [[nodiscard]] long getNbCandidates() const { return _nCandidates_; }
+  [[nodiscard]] long getNbAccepted() const { return _nAccepted_; }
+  [[nodiscard]] const CovarianceBlocks& getBlocks() const { return _blocks_; }
+
+  /// Fill throwList_ with nThrows_ independent throws.  The values of throw
+  /// #i are stored at [i*nDim, (i+1)*nDim).
+  void throwBlock(int nThrows_, std::vector<double>& throwList_);
+
+  /// Draw throws until one is accepted by isValid_, and copy it into out_.
+  /// The first block has a single candidate, and the block size is doubled
+  /// (up to the max block size) every time the whole block is rejected.
+  /// Returns the number of candidates which have been checked, or zero if
+  /// nothing has been accepted after maxCandidates_.
+  long throwAccepted(
+      std::vector<double>& out_,
+      const std::function<bool(const double*)>& isValid_,
+      long maxCandidates_ = 100000
+  );
+
+private:
+  // parameters
+  int _maxBlockSize_{64};
+
+  // internals
+  int _nDim_{0};
+  CovarianceBlocks _blocks_{};
+  std::vector<std::vector<double>> _choleskyLowerList_{}; // one per block, row i starts at i*(i+1)/2
+
+  // work space
+  std::vector<double> _uniformList_{};
+  std::vector<double> _normalList_{};    // dimension major: [iDim*nThrows + iThrow]
+  std::vector<double> _productList_{};   // dimension major
+  std::vector<double> _candidateList_{}; // throw major
+
+  // monitoring
+  long _nCandidates_{0};
+  long _nAccepted_{0};
+
+};
+
+
+#endif //GUNDAM_CORRELATED_THROW_GENERATOR_H
+
+// Local Variables:
+// mode:c++
+// c-basic-offset:2
+// End:
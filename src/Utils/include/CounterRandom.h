@@ -0,0 +1,132 @@
+#ifndef GUNDAM_COUNTER_RANDOM_H
+#define GUNDAM_COUNTER_RANDOM_H
+
+#include <cmath>
+#include <cstdint>
+
+
+/*
+  CounterRandom is a counter-based random generator (Philox4x32-10, see
+  Salmon et al., "Parallel random numbers: as easy as 1, 2, 3", SC11).  The
+  random numbers are a pure function of (seed, stream, index, draw): there
+  is no internal state, so the same generator can be used from any thread,
+  and the value given to an index doesn't depend on the order of the calls.
+
+  The stream is typically a toy index, and the index an event or a bin.
+  Only the 48 lower bits of the stream, and 16 bits of draws per index are
+  used.
+*/
+
+class CounterRandom{
+
+public:
+  CounterRandom() = default;
+  CounterRandom(uint64_t seed_, uint64_t stream_) : _seed_(seed_), _stream_(stream_) {}
+
+  // getters
+  [[nodiscard]] uint64_t getSeed() const { return _seed_; }
+  [[nodiscard]] uint64_t getStream() const { return _stream_; }
+
+  /// An independent generator for a sub-part (e.g. a sample) of the stream.
+  [[nodiscard]] CounterRandom getSubStream(uint64_t subStream_) const {
+    return { mix(_seed_ + (subStream_ + 1) * 0x9E3779B97F4A7C15ULL), _stream_ };
+  }
+
+  /// Uniform in ]0, 1[
+  [[nodiscard]] double uniform(uint64_t index_, uint32_t draw_ = 0) const {
+    uint32_t block[4];
+    this->generate(index_, draw_ / 2, block);
+    uint64_t bits{ (draw_ % 2 == 0) ?
+                   (uint64_t(block[0]) << 32 | block[1]) :
+                   (uint64_t(block[2]) << 32 | block[3]) };
+    return (double(bits >> 11) + 0.5) * 0x1.0p-53;
+  }
+
+  /// Standard normal (uses the draws 2*draw_ and 2*draw_+1)
+  [[nodiscard]] double gaus(uint64_t index_, uint32_t draw_ = 0) const {
+    double u1{ this->uniform(index_, 2*draw_) };
+    double u2{ this->uniform(index_, 2*draw_+1) };
+    return std::sqrt( -2. * std::log(u1) ) * std::cos( 2. * M_PI * u2 );
+  }
+  [[nodiscard]] double gaus(double mean_, double sigma_, uint64_t index_, uint32_t draw_ = 0) const {
+    return mean_ + sigma_ * this->gaus(index_, draw_);
+  }
+
+  /// Poisson: multiplication method for small means, and the transformed
+  /// rejection (PTRS, Hormann 1993) otherwise.
+  [[nodiscard]] uint64_t poisson(double mean_, uint64_t index_) const {
+    if( not (mean_ > 0) ){ return 0; }
+    uint32_t draw{0};
+
+    if( mean_ < 10 ){
+      const double limit{ std::exp(-mean_) };
+      double product{ this->uniform(index_, draw++) };
+      uint64_t count{0};
+      while( product > limit and draw < 0xFFFF ){
+        count++;
+        product *= this->uniform(index_, draw++);
+      }
+      return count;
+    }
+
+    const double sqrtMean{ std::sqrt(mean_) };
+    const double logMean{ std::log(mean_) };
+    const double b{ 0.931 + 2.53 * sqrtMean };
+    const double a{ -0.059 + 0.02483 * b };
+    const double invAlpha{ 1.1239 + 1.1328 / (b - 3.4) };
+    const double vr{ 0.9277 - 3.6224 / (b - 2) };
+    while( draw < 0xFFFE ){
+      double u{ this->uniform(index_, draw++) - 0.5 };
+      double v{ this->uniform(index_, draw++) };
+      double us{ 0.5 - std::abs(u) };
+      double k{ std::floor( (2 * a / us + b) * u + mean_ + 0.43 ) };
+      if( us >= 0.07 and v <= vr ){ return uint64_t(k); }
+      if( k < 0 or (us < 0.013 and v > us) ){ continue; }
+      if( std::log(v) + std::log(invAlpha) - std::log(a / (us * us) + b)
+          <= -mean_ + k * logMean - std::lgamma(k + 1) ){
+        return uint64_t(k);
+      }
+    }
+    return uint64_t( std::floor(mean_ + 0.5) ); // never reached in practice
+  }
+
+  /// The raw Philox4x32-10 block for the given index and block counter.
+  void generate(uint64_t index_, uint32_t block_, uint32_t* out_) const {
+    uint32_t counter[4]{
+        uint32_t(index_), uint32_t(index_ >> 32),
+        uint32_t(_stream_), uint32_t((_stream_ >> 32) & 0xFFFF) | (block_ << 16)
+    };
+    uint32_t key[2]{ uint32_t(_seed_), uint32_t(_seed_ >> 32) };
+    for( int iRound = 0 ; iRound < 10 ; iRound++ ){
+      uint64_t product0{ uint64_t(0xD2511F53) * counter[0] };
+      uint64_t product1{ uint64_t(0xCD9E8D57) * counter[2] };
+      uint32_t next[4]{
+          uint32_t(product1 >> 32) ^ counter[1] ^ key[0], uint32_t(product1),
+          uint32_t(product0 >> 32) ^ counter[3] ^ key[1], uint32_t(product0)
+      };
+      counter[0] = next[0]; counter[1] = next[1]; counter[2] = next[2]; counter[3] = next[3];
+      key[0] += 0x9E3779B9; key[1] += 0xBB67AE85;
+    }
+    out_[0] = counter[0]; out_[1] = counter[1]; out_[2] = counter[2]; out_[3] = counter[3];
+  }
+
+  /// splitmix64 finalizer, to turn a seed and an index into a new seed
+  static uint64_t mix(uint64_t x_){
+    x_ = (x_ ^ (x_ >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x_ = (x_ ^ (x_ >> 27)) * 0x94D049BB133111EBULL;
+    return x_ ^ (x_ >> 31);
+  }
+
+private:
+  uint64_t _seed_{0};
+  uint64_t _stream_{0};
+
+};
+
+
+#endif //GUNDAM_COUNTER_RANDOM_H
+
+// Local Variables:
+// mode:c++
+// c-basic-offset:2
+// End:
@@ -0,0 +1,62 @@
+#ifndef GUNDAM_COVARIANCE_BLOCKS_H
+#define GUNDAM_COVARIANCE_BLOCKS_H
+
+#include "TMatrixDBase.h"
+#include "TMatrixDSym.h"
+
+#include <string>
+#include <vector>
+
+
+/*
+  CovarianceBlocks finds the independent blocks of a symmetric matrix: two
+  indices belong to the same block if they are connected by a chain of
+  non-zero off-diagonal elements.  The indices of a block don't need to be
+  contiguous.
+
+  A covariance matrix is block diagonal (up to a permutation) in the block
+  basis, so its Cholesky factor, inverse and eigen vectors can be computed
+  block by block: the cost scales with the size of the blocks instead of the
+  total number of parameters.
+*/
+
+class CovarianceBlocks{
+
+public:
+  CovarianceBlocks() = default;
+  explicit CovarianceBlocks(const TMatrixDBase& matrix_){ this->build(matrix_); }
+
+  /// Find the blocks of the (square) matrix.
+  void build(const TMatrixDBase& matrix_);
+
+  // getters
+  [[nodiscard]] int getNbIndices() const { return int(_blockIndexList_.size()); }
+  [[nodiscard]] int getNbBlocks() const { return int(_blockList_.size()); }
+  [[nodiscard]] int getBlockIndex(int index_) const { return _blockIndexList_[index_]; }
+  [[nodiscard]] const std::vector<int>& getBlock(int iBlock_) const { return _blockList_[iBlock_]; }
+  [[nodiscard]] const std::vector<std::vector<int>>& getBlockList() const { return _blockList_; }
+  [[nodiscard]] const std::vector<int>& getBlockIndexList() const { return _blockIndexList_; }
+  [[nodiscard]] int getLargestBlockSize() const;
+
+  /// The number of elements in the blocks (sum of the squared block sizes).
+  [[nodiscard]] size_t getNbBlockElements() const;
+
+  /// The dense sub-matrix of the block.
+  [[nodiscard]] TMatrixDSym getSubMatrix(const TMatrixDBase& matrix_, int iBlock_) const;
+
+  /// Short summary, e.g. "3 blocks (largest: 120/200)"
+  [[nodiscard]] std::string getSummary() const;
+
+private:
+  std::vector<int> _blockIndexList_{};         // block of each index
+  std::vector<std::vector<int>> _blockList_{}; // sorted indices of each block
+
+};
+
+
+#endif //GUNDAM_COVARIANCE_BLOCKS_H
+
+// Local Variables:
+// mode:c++
+// c-basic-offset:2
+// End:
@@ -0,0 +1,50 @@
+#ifndef GUNDAM_FORKED_WORKERS_H
+#define GUNDAM_FORKED_WORKERS_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+
+/*
+  Share a list of tasks among forked worker processes.  The workers inherit
+  the memory of the parent (e.g. the loaded events), so nothing has to be
+  reloaded.  Only the calling thread survives the fork: the workers can't
+  use the thread pools.
+
+  Each worker gets the tasks iWorker, iWorker + nWorkers, ... (interleaved,
+  so the workloads are similar and the first tasks come back early), and
+  sends one record per task through a pipe: [iTask, nValues, values...].
+  The parent hands the results over in the task order, as they come.
+*/
+
+namespace ForkedWorkers{
+
+  /// Send the values of a task to the parent (called in the worker).
+  typedef std::function<void(int iTask_, const std::vector<double>& values_)> SendFct;
+
+  /// Evaluate the tasks of a worker, and send each of them (called in the worker).
+  typedef std::function<void(const std::vector<int>& taskList_, const SendFct& sendFct_)> WorkerFct;
+
+  /// Receive the values of a task (called in the parent, in the task order).
+  typedef std::function<void(int iTask_, const std::vector<double>& values_)> ReceiveFct;
+
+  /// Run nTasks_ tasks with nWorkers_ forked processes.  initWorkerFct_ is
+  /// called first in each worker (e.g. to switch to single thread).  The
+  /// logger of the workers is muted.  This throws if a worker fails or if a
+  /// task hasn't been received: the remaining workers are then killed.
+  void run(
+      int nWorkers_, int nTasks_, const std::string& workerName_,
+      const std::function<void()>& initWorkerFct_,
+      const WorkerFct& workerFct_,
+      const ReceiveFct& receiveFct_
+  );
+
+}
+
+#endif //GUNDAM_FORKED_WORKERS_H
+
+// Local Variables:
+// mode:c++
+// c-basic-offset:2
+// End:
@@ -0,0 +1,91 @@
+#ifndef GUNDAM_FORMULA_PROGRAM_H
+#define GUNDAM_FORMULA_PROGRAM_H
+
+#include <string>
+#include <vector>
+
+
+/*
+  A FormulaProgram is a TFormula expression compiled once into a flat list
+  of instructions for a small stack machine.  Once compiled, the program is
+  never modified: eval() and evalBatch() are const and don't use any shared
+  state, so any number of threads can evaluate the same program.
+
+  The syntax is the usual subset of the TFormula one: numbers, the variables
+  x, y, z, t and x[i], the parameters [name] and [i], the arithmetic,
+  comparison and logical operators (^ and ** are the power), and the common
+  math functions (sqrt, exp, log, TMath::Exp, ...).  The parameters are read
+  from the array given to eval(), in the order of getParameterNameList().
+  Anything else (e.g. the predefined functions like gaus or pol2) makes
+  compile() fail, and the caller should keep using the TFormula.
+
+  evalBatch() evaluates the program for a list of inputs, instruction by
+  instruction, so the dispatch is paid once per instruction and the
+  arithmetic loops can be vectorised.
+*/
+
+class FormulaProgram{
+
+public:
+  FormulaProgram() = default;
+
+  /// Compile the expression.  Returns false if the expression can't be
+  /// compiled (see getError()), the program is then empty.
+  bool compile(const std::string& expression_);
+
+  /// Evaluate the program with the variables x_ and the parameters par_.
+  [[nodiscard]] double eval(const double* x_, const double* par_) const;
+
+  /// Evaluate the program n_ times: result_[i] = eval(x_[i], par_[i]).
+  void evalBatch(int n_, const double* const* x_, const double* const* par_, double* result_) const;
+
+  // getters
+  [[nodiscard]] bool isCompiled() const { return not _instructionList_.empty(); }
+  [[nodiscard]] int getNbInstructions() const { return int(_instructionList_.size()); }
+  [[nodiscard]] int getNbVariables() const { return _nbVariables_; }
+  [[nodiscard]] const std::string& getExpression() const { return _expression_; }
+  [[nodiscard]] const std::string& getError() const { return _error_; }
+
+  /// The parameters, as written in the expression without the brackets
+  /// ("0" for [0]), in order of appearance.
+  [[nodiscard]] const std::vector<std::string>& getParameterNameList() const { return _parameterNameList_; }
+
+  /// The largest number of values on the stack.
+  static constexpr int maxStackSize{32};
+
+protected:
+  enum class OpCode{
+    Constant, Variable, Parameter,
+    Negate, Not,
+    Add, Subtract, Multiply, Divide, Power,
+    Less, Greater, LessEqual, GreaterEqual, Equal, NotEqual,
+    And, Or,
+    Function1, Function2
+  };
+
+  struct Instruction{
+    OpCode opCode{OpCode::Constant};
+    int index{0};
+    double value{0};
+    double (*function1)(double){nullptr};
+    double (*function2)(double, double){nullptr};
+  };
+
+private:
+  class Compiler;
+
+  std::string _expression_{};
+  std::string _error_{};
+  int _nbVariables_{0};
+  std::vector<std::string> _parameterNameList_{};
+  std::vector<Instruction> _instructionList_{};
+
+};
+
+
+#endif //GUNDAM_FORMULA_PROGRAM_H
+
+// Local Variables:
+// mode:c++
+// c-basic-offset:2
+// End:
@@ -0,0 +1,284 @@
+#include "AsyncTreeWriter.h"
+
+#include "TBranchElement.h"
+#include "TLeaf.h"
+#include "TVectorD.h"
+#include "TMatrixDSym.h"
+
+#include "Logger.h"
+
+#include <algorithm>
+
+
+AsyncFileWriter::AsyncFileWriter(int queueSize_) : _queueSize_(std::max(1, queueSize_)) {}
+AsyncFileWriter::~AsyncFileWriter(){ this->stop(); }
+
+void AsyncFileWriter::post(std::function<void()> task_){
+  {
+    std::unique_lock<std::mutex> lock(_mutex_);
+    LogThrowIf(_isStopRequested_, "Posting to a stopped file writer.");
+    if( not _ioThread_.joinable() ){ _ioThread_ = std::thread(&AsyncFileWriter::ioLoop, this); }
+    _notFull_.wait(lock, [&]{ return _queue_.size() < _queueSize_; });
+    _queue_.emplace_back(std::move(task_));
+  }
+  _notEmpty_.notify_one();
+}
+void AsyncFileWriter::wait(){
+  std::unique_lock<std::mutex> lock(_mutex_);
+  _isIdle_.wait(lock, [&]{ return _queue_.empty() and not _isRunningTask_; });
+}
+void AsyncFileWriter::stop(){
+  {
+    std::lock_guard<std::mutex> lock(_mutex_);
+    _isStopRequested_ = true;
+  }
+  _notEmpty_.notify_one();
+  if( _ioThread_.joinable() ){ _ioThread_.join(); }
+}
+void AsyncFileWriter::ioLoop(){
+  while( true ){
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(_mutex_);
+      _notEmpty_.wait(lock, [&]{ return not _queue_.empty() or _isStopRequested_; });
+      if( _queue_.empty() ){ break; } // stop requested and everything is written
+      task = std::move(_queue_.front());
+      _queue_.pop_front();
+      _isRunningTask_ = true;
+    }
+    _notFull_.notify_one();
+
+    task();
+
+    {
+      std::lock_guard<std::mutex> lock(_mutex_);
+      _isRunningTask_ = false;
+    }
+    _isIdle_.notify_all();
+  }
+}
+
+
+AsyncTreeWriter::AsyncTreeWriter(TTree* sourceTree_, std::shared_ptr<AsyncFileWriter> fileWriter_) :
+    _sourceTree_(sourceTree_),
+    _outputDir_(gDirectory),
+    _fileWriter_(std::move(fileWriter_)) {
+  LogThrowIf(_sourceTree_ == nullptr, "No source tree provided.");
+  LogThrowIf(_fileWriter_ == nullptr, "No file writer provided.");
+}
+AsyncTreeWriter::~AsyncTreeWriter(){
+  // the queued entries point to this writer
+  if( _isStarted_ ){ _fileWriter_->wait(); }
+}
+
+void AsyncTreeWriter::setFloatBranchList(const std::vector<std::string>& floatBranchList_){
+  LogThrowIf(_isStarted_, "Can't change the branches once the writer has started.");
+  _floatBranchList_ = floatBranchList_;
+}
+void AsyncTreeWriter::setStatisticsBranch(const std::string& statisticsBranch_){
+  LogThrowIf(_isStarted_, "Can't change the branches once the writer has started.");
+  _statisticsBranch_ = statisticsBranch_;
+}
+
+void AsyncTreeWriter::fill(bool force_){
+  LogThrowIf(_isClosed_, "Filling a closed tree writer: " << _sourceTree_->GetName());
+  if( not _isStarted_ ){ this->start(); }
+
+  bool isWritten = force_ or (_nFills_ % _stride_) == 0;
+  bool isAccumulated = _isStatisticsEnabled_ and _statisticsColumn_ >= 0;
+  _nFills_++;
+  if( not isWritten and not isAccumulated ){ return; }
+
+  Entry entry;
+  {
+    std::lock_guard<std::mutex> lock(_poolMutex_);
+    if( not _entryPool_.empty() ){
+      entry = std::move(_entryPool_.back());
+      _entryPool_.pop_back();
+    }
+  }
+  entry.isWritten = isWritten;
+  entry.isAccumulated = isAccumulated;
+  entry.scalarList.resize(_nScalars_);
+  entry.floatVectorList.resize(_nFloatVectors_);
+  entry.doubleVectorList.resize(_nDoubleVectors_);
+
+  // Take the copy of the source values.  If the entry is only used for the
+  // statistics, then only that column is needed.
+  for( size_t iCol = 0 ; iCol < _columnList_.size() ; iCol++ ){
+    auto& col = _columnList_[iCol];
+    if( not isWritten and int(iCol) != _statisticsColumn_ ){ continue; }
+    switch( col.type ){
+      case Type::Int:    entry.scalarList[col.slot] = *static_cast<const int*>(col.source); break;
+      case Type::Float:  entry.scalarList[col.slot] = *static_cast<const float*>(col.source); break;
+      case Type::Double: entry.scalarList[col.slot] = *static_cast<const double*>(col.source); break;
+      case Type::VectorFloat:
+        entry.floatVectorList[col.slot] = *static_cast<const std::vector<float>*>(col.source);
+        break;
+      case Type::VectorDouble: {
+        auto* src = static_cast<const std::vector<double>*>(col.source);
+        if( col.storeAsFloat ){ entry.floatVectorList[col.slot].assign(src->begin(), src->end()); }
+        else{ entry.doubleVectorList[col.slot] = *src; }
+        break;
+      }
+    }
+  }
+
+  _fileWriter_->post([this, entry = std::move(entry)]() mutable {
+    if( entry.isAccumulated ){
+      this->accumulate( entry.floatVectorList[_columnList_[_statisticsColumn_].slot] );
+    }
+    if( entry.isWritten ){ this->writeEntry( entry ); }
+
+    std::lock_guard<std::mutex> lock(_poolMutex_);
+    _entryPool_.emplace_back( std::move(entry) );
+  });
+}
+void AsyncTreeWriter::close(){
+  if( _isClosed_ ){ return; }
+  if( not _isStarted_ ){ this->start(); }
+  _isClosed_ = true;
+
+  _fileWriter_->post([this]{ this->writeOutput(); });
+  _fileWriter_->wait();
+
+  if( _nSamples_ < 2 ){ return; }
+  LogInfo << "Saved the mean and covariance of " << _statisticsBranch_ << " over "
+          << _nSamples_ << " entries (" << _outputTree_->GetEntries() << " written)" << std::endl;
+}
+
+void AsyncTreeWriter::defineColumns(){
+  _columnList_.clear();
+  _nScalars_ = 0; _nFloatVectors_ = 0; _nDoubleVectors_ = 0;
+  _statisticsColumn_ = -1;
+
+  for( auto* obj : *_sourceTree_->GetListOfBranches() ){
+    auto* br = dynamic_cast<TBranch*>(obj);
+    if( br == nullptr ){ continue; }
+
+    Column col;
+    col.name = br->GetName();
+    auto* brElement = dynamic_cast<TBranchElement*>(br);
+    if( brElement != nullptr ){
+      std::string className{brElement->GetClassName()};
+      if     ( className == "vector<float>" ) { col.type = Type::VectorFloat; }
+      else if( className == "vector<double>" ){ col.type = Type::VectorDouble; }
+      else{ LogThrow("Unsupported branch type for " << col.name << ": " << className); }
+      col.source = brElement->GetObject();
+    }
+    else{
+      auto* leaf = dynamic_cast<TLeaf*>(br->GetListOfLeaves()->At(0));
+      LogThrowIf(leaf == nullptr, "No leaf for branch " << col.name);
+      std::string typeName{leaf->GetTypeName()};
+      if     ( typeName == "Int_t" )   { col.type = Type::Int; }
+      else if( typeName == "Float_t" ) { col.type = Type::Float; }
+      else if( typeName == "Double_t" ){ col.type = Type::Double; }
+      else{ LogThrow("Unsupported branch type for " << col.name << ": " << typeName); }
+      col.source = br->GetAddress();
+    }
+    LogThrowIf(col.source == nullptr, "No address set for branch " << col.name);
+
+    col.storeAsFloat = (
+        col.type == Type::VectorDouble
+        and std::find(_floatBranchList_.begin(), _floatBranchList_.end(), col.name) != _floatBranchList_.end()
+    );
+
+    if( col.type == Type::VectorFloat or col.storeAsFloat ){ col.slot = _nFloatVectors_++; }
+    else if( col.type == Type::VectorDouble ){ col.slot = _nDoubleVectors_++; }
+    else{ col.slot = _nScalars_++; }
+
+    if( col.name == _statisticsBranch_ ){
+      LogThrowIf(col.type != Type::VectorFloat, "Statistics are only accumulated for vector<float> branches: " << col.name);
+      _statisticsColumn_ = int(_columnList_.size());
+    }
+
+    _columnList_.emplace_back( std::move(col) );
+  }
+
+  LogThrowIf(not _statisticsBranch_.empty() and _statisticsColumn_ < 0,
+             "Could not find branch " << _statisticsBranch_ << " in " << _sourceTree_->GetName());
+}
+void AsyncTreeWriter::start(){
+  this->defineColumns();
+  _isStarted_ = true;
+
+  // The output branches point to the column buffers, so the column list
+  // can't change from now on.
+  _fileWriter_->post([this]{ this->createOutputTree(); });
+}
+void AsyncTreeWriter::createOutputTree(){
+  TDirectory::TContext context{_outputDir_};
+  _outputTree_ = new TTree(_sourceTree_->GetName(), _sourceTree_->GetTitle());
+  for( auto& col : _columnList_ ){
+    switch( col.type ){
+      case Type::Int:    _outputTree_->Branch(col.name.c_str(), &col.intValue); break;
+      case Type::Float:  _outputTree_->Branch(col.name.c_str(), &col.floatValue); break;
+      case Type::Double: _outputTree_->Branch(col.name.c_str(), &col.doubleValue); break;
+      case Type::VectorFloat: _outputTree_->Branch(col.name.c_str(), &col.floatVector); break;
+      case Type::VectorDouble:
+        if( col.storeAsFloat ){ _outputTree_->Branch(col.name.c_str(), &col.floatVector); }
+        else{ _outputTree_->Branch(col.name.c_str(), &col.doubleVector); }
+        break;
+    }
+  }
+}
+void AsyncTreeWriter::writeOutput(){
+  TDirectory::TContext context{_outputDir_};
+  _outputTree_->Write();
+
+  if( _nSamples_ < 2 ){ return; }
+  int dim = int(_mean_.size());
+  TVectorD mean(dim);
+  TMatrixDSym covariance(dim);
+  size_t idx{0};
+  for( int i = 0 ; i < dim ; i++ ){
+    mean(i) = _mean_[i];
+    for( int j = 0 ; j <= i ; j++ ){
+      covariance(i,j) = covariance(j,i) = _covariance_[idx++] / (_nSamples_ - 1.);
+    }
+  }
+  _outputDir_->WriteTObject(&mean, (std::string(_outputTree_->GetName()) + "_mean").c_str());
+  _outputDir_->WriteTObject(&covariance, (std::string(_outputTree_->GetName()) + "_covariance").c_str());
+}
+void AsyncTreeWriter::writeEntry(Entry& entry_){
+  for( auto& col : _columnList_ ){
+    switch( col.type ){
+      case Type::Int:    col.intValue = int(entry_.scalarList[col.slot]); break;
+      case Type::Float:  col.floatValue = float(entry_.scalarList[col.slot]); break;
+      case Type::Double: col.doubleValue = entry_.scalarList[col.slot]; break;
+      case Type::VectorFloat: std::swap(col.floatVector, entry_.floatVectorList[col.slot]); break;
+      case Type::VectorDouble:
+        if( col.storeAsFloat ){ std::swap(col.floatVector, entry_.floatVectorList[col.slot]); }
+        else{ std::swap(col.doubleVector, entry_.doubleVectorList[col.slot]); }
+        break;
+    }
+  }
+  _outputTree_->Fill();
+}
+void AsyncTreeWriter::accumulate(const std::vector<float>& point_){
+  // Welford's running mean and covariance.  Only the lower triangle of the
+  // covariance is kept.
+  if( _mean_.empty() ){
+    _mean_.assign(point_.size(), 0);
+    _covariance_.assign(point_.size()*(point_.size()+1)/2, 0);
+    _delta_.resize(point_.size());
+  }
+  if( point_.size() != _mean_.size() ){ return; }
+
+  _nSamples_ += 1;
+  for( size_t i = 0 ; i < point_.size() ; i++ ){
+    _delta_[i] = point_[i] - _mean_[i];
+    _mean_[i] += _delta_[i] / _nSamples_;
+  }
+  size_t idx{0};
+  for( size_t i = 0 ; i < point_.size() ; i++ ){
+    for( size_t j = 0 ; j <= i ; j++ ){
+      _covariance_[idx++] += _delta_[i] * (point_[j] - _mean_[j]);
+    }
+  }
+}
+
+// Local Variables:
+// mode:c++
+// c-basic-offset:2
+// End:
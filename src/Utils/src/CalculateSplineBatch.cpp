@@ -0,0 +1,127 @@
+#include "CalculateSplineBatch.h"
+
+#include "CalculateCompactSpline.h"
+#include "CalculateUniformSpline.h"
+#include "CalculateMonotonicSpline.h"
+#include "CalculateGeneralSpline.h"
+#undef CHECK_OFFSET // also defined by CalculateGraph
+#include "CalculateGraph.h"
+
+
+// The vectorised kernels are only compiled when the compiler supports the
+// instruction set (see CMakeLists.txt).
+namespace SplineBatch{
+#ifdef GUNDAM_SPLINE_BATCH_AVX2
+  namespace Avx2{
+    void evalCompactSpline(const Batch& batch_);
+    void evalUniformSpline(const Batch& batch_);
+    void evalMonotonicSpline(const Batch& batch_);
+  }
+#endif
+#ifdef GUNDAM_SPLINE_BATCH_AVX512
+  namespace Avx512{
+    void evalCompactSpline(const Batch& batch_);
+    void evalUniformSpline(const Batch& batch_);
+    void evalMonotonicSpline(const Batch& batch_);
+  }
+#endif
+}
+
+namespace {
+  SplineBatch::Isa& getCurrentIsa(){
+    static SplineBatch::Isa isa{SplineBatch::getBestSupportedIsa()};
+    return isa;
+  }
+
+  bool isSupported(SplineBatch::Isa isa_){
+    switch( isa_ ){
+#if defined(GUNDAM_SPLINE_BATCH_AVX2) && (defined(__GNUC__) || defined(__clang__))
+      case SplineBatch::Isa::Avx2: return __builtin_cpu_supports("avx2");
+#endif
+#if defined(GUNDAM_SPLINE_BATCH_AVX512) && (defined(__GNUC__) || defined(__clang__))
+      case SplineBatch::Isa::Avx512: return __builtin_cpu_supports("avx512f") and __builtin_cpu_supports("avx2");
+#endif
+      case SplineBatch::Isa::Portable: return true;
+      default: return false;
+    }
+  }
+}
+
+namespace SplineBatch{
+
+  Isa getBestSupportedIsa(){
+    if( isSupported(Isa::Avx512) ){ return Isa::Avx512; }
+    if( isSupported(Isa::Avx2) ){ return Isa::Avx2; }
+    return Isa::Portable;
+  }
+  Isa getIsa(){ return getCurrentIsa(); }
+  void setIsa(Isa isa_){
+    getCurrentIsa() = ( isSupported(isa_) ? isa_ : getBestSupportedIsa() );
+  }
+  const char* getIsaName(Isa isa_){
+    switch( isa_ ){
+      case Isa::Avx2: return "AVX2";
+      case Isa::Avx512: return "AVX-512";
+      default: return "portable";
+    }
+  }
+
+  void evalCompactSpline(const Batch& batch_){
+    switch( getCurrentIsa() ){
+#ifdef GUNDAM_SPLINE_BATCH_AVX512
+      case Isa::Avx512: Avx512::evalCompactSpline(batch_); return;
+#endif
+#ifdef GUNDAM_SPLINE_BATCH_AVX2
+      case Isa::Avx2: Avx2::evalCompactSpline(batch_); return;
+#endif
+      default: break;
+    }
+    for( int i = 0 ; i < batch_.size ; i++ ){
+      batch_.result[i] = CalculateCompactSpline(batch_.x[i], batch_.lowerBound[i], batch_.upperBound[i], batch_.data[i], batch_.dim[i]);
+    }
+  }
+  void evalUniformSpline(const Batch& batch_){
+    switch( getCurrentIsa() ){
+#ifdef GUNDAM_SPLINE_BATCH_AVX512
+      case Isa::Avx512: Avx512::evalUniformSpline(batch_); return;
+#endif
+#ifdef GUNDAM_SPLINE_BATCH_AVX2
+      case Isa::Avx2: Avx2::evalUniformSpline(batch_); return;
+#endif
+      default: break;
+    }
+    for( int i = 0 ; i < batch_.size ; i++ ){
+      batch_.result[i] = CalculateUniformSpline(batch_.x[i], batch_.lowerBound[i], batch_.upperBound[i], batch_.data[i], batch_.dim[i]);
+    }
+  }
+  void evalMonotonicSpline(const Batch& batch_){
+    switch( getCurrentIsa() ){
+#ifdef GUNDAM_SPLINE_BATCH_AVX512
+      case Isa::Avx512: Avx512::evalMonotonicSpline(batch_); return;
+#endif
+#ifdef GUNDAM_SPLINE_BATCH_AVX2
+      case Isa::Avx2: Avx2::evalMonotonicSpline(batch_); return;
+#endif
+      default: break;
+    }
+    for( int i = 0 ; i < batch_.size ; i++ ){
+      batch_.result[i] = CalculateMonotonicSpline(batch_.x[i], batch_.lowerBound[i], batch_.upperBound[i], batch_.data[i], batch_.dim[i]);
+    }
+  }
+  void evalGeneralSpline(const Batch& batch_){
+    for( int i = 0 ; i < batch_.size ; i++ ){
+      batch_.result[i] = CalculateGeneralSpline(batch_.x[i], batch_.lowerBound[i], batch_.upperBound[i], batch_.data[i], batch_.dim[i]);
+    }
+  }
+  void evalGraph(const Batch& batch_){
+    for( int i = 0 ; i < batch_.size ; i++ ){
+      batch_.result[i] = CalculateGraph(batch_.x[i], batch_.lowerBound[i], batch_.upperBound[i], batch_.data[i], batch_.dim[i]);
+    }
+  }
+
+}
+
+// Local Variables:
+// mode:c++
+// c-basic-offset:2
+// End:
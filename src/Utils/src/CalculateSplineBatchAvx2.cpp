@@ -0,0 +1,57 @@
+// This file is compiled with -mavx2 -ffp-contract=off (see CMakeLists.txt):
+// only include the headers with internal linkage here.
+#include "CalculateSplineBatch.impl.h"
+
+#include <immintrin.h>
+
+
+namespace {
+  struct Avx2Lanes{
+    typedef __m256d D;
+    typedef __m128i I;
+    typedef __m256i P;
+    static constexpr int width{4};
+
+    static D loadD(const double* p_){ return _mm256_loadu_pd(p_); }
+    static void storeD(double* p_, D v_){ _mm256_storeu_pd(p_, v_); }
+    static D set1D(double v_){ return _mm256_set1_pd(v_); }
+    static D add(D a_, D b_){ return _mm256_add_pd(a_, b_); }
+    static D sub(D a_, D b_){ return _mm256_sub_pd(a_, b_); }
+    static D mul(D a_, D b_){ return _mm256_mul_pd(a_, b_); }
+    static D div(D a_, D b_){ return _mm256_div_pd(a_, b_); }
+    static D neg(D a_){ return _mm256_xor_pd(a_, _mm256_set1_pd(-0.0)); }
+    static D select(D a_, D b_, D x_, D y_){ return _mm256_blendv_pd(y_, x_, _mm256_cmp_pd(a_, b_, _CMP_LT_OQ)); }
+    static D selectLE(D a_, D b_, D x_, D y_){ return _mm256_blendv_pd(y_, x_, _mm256_cmp_pd(a_, b_, _CMP_LE_OQ)); }
+
+    static P loadP(const double* const* p_){ return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p_)); }
+    static D gather(P p_, I i_){
+      // absolute addresses: p + 8*i
+      const __m256i address{_mm256_add_epi64(p_, _mm256_slli_epi64(_mm256_cvtepi32_epi64(i_), 3))};
+      return _mm256_i64gather_pd(static_cast<const double*>(nullptr), address, 1);
+    }
+
+    static I loadI(const int* p_){ return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p_)); }
+    static I set1I(int v_){ return _mm_set1_epi32(v_); }
+    static I addI(I a_, I b_){ return _mm_add_epi32(a_, b_); }
+    static I subI(I a_, I b_){ return _mm_sub_epi32(a_, b_); }
+    static I minI(I a_, I b_){ return _mm_min_epi32(a_, b_); }
+    static I maxI(I a_, I b_){ return _mm_max_epi32(a_, b_); }
+    static I selectGtI(I a_, I b_, I x_, I y_){ return _mm_blendv_epi8(y_, x_, _mm_cmpgt_epi32(a_, b_)); }
+    static I halfI(I a_){ return _mm_srai_epi32(_mm_add_epi32(a_, _mm_srli_epi32(a_, 31)), 1); }
+    static I truncI(D a_){ return _mm256_cvttpd_epi32(a_); }
+    static D toD(I a_){ return _mm256_cvtepi32_pd(a_); }
+  };
+}
+
+namespace SplineBatch{
+  namespace Avx2{
+    void evalCompactSpline(const Batch& batch_){ SplineBatchKernels<Avx2Lanes>::evalCompactSpline(batch_); }
+    void evalUniformSpline(const Batch& batch_){ SplineBatchKernels<Avx2Lanes>::evalUniformSpline(batch_); }
+    void evalMonotonicSpline(const Batch& batch_){ SplineBatchKernels<Avx2Lanes>::evalMonotonicSpline(batch_); }
+  }
+}
+
+// Local Variables:
+// mode:c++
+// c-basic-offset:2
+// End:
@@ -0,0 +1,59 @@
+// This file is compiled with -mavx512f -ffp-contract=off (see
+// CMakeLists.txt): only include the headers with internal linkage here.
+#include "CalculateSplineBatch.impl.h"
+
+#include <immintrin.h>
+
+
+namespace {
+  struct Avx512Lanes{
+    typedef __m512d D;
+    typedef __m256i I;
+    typedef __m512i P;
+    static constexpr int width{8};
+
+    static D loadD(const double* p_){ return _mm512_loadu_pd(p_); }
+    static void storeD(double* p_, D v_){ _mm512_storeu_pd(p_, v_); }
+    static D set1D(double v_){ return _mm512_set1_pd(v_); }
+    static D add(D a_, D b_){ return _mm512_add_pd(a_, b_); }
+    static D sub(D a_, D b_){ return _mm512_sub_pd(a_, b_); }
+    static D mul(D a_, D b_){ return _mm512_mul_pd(a_, b_); }
+    static D div(D a_, D b_){ return _mm512_div_pd(a_, b_); }
+    static D neg(D a_){
+      return _mm512_castsi512_pd(_mm512_xor_si512(_mm512_castpd_si512(a_), _mm512_set1_epi64(0x8000000000000000LL)));
+    }
+    static D select(D a_, D b_, D x_, D y_){ return _mm512_mask_blend_pd(_mm512_cmp_pd_mask(a_, b_, _CMP_LT_OQ), y_, x_); }
+    static D selectLE(D a_, D b_, D x_, D y_){ return _mm512_mask_blend_pd(_mm512_cmp_pd_mask(a_, b_, _CMP_LE_OQ), y_, x_); }
+
+    static P loadP(const double* const* p_){ return _mm512_loadu_si512(reinterpret_cast<const void*>(p_)); }
+    static D gather(P p_, I i_){
+      // absolute addresses: p + 8*i
+      const __m512i address{_mm512_add_epi64(p_, _mm512_slli_epi64(_mm512_cvtepi32_epi64(i_), 3))};
+      return _mm512_i64gather_pd(address, static_cast<const void*>(nullptr), 1);
+    }
+
+    static I loadI(const int* p_){ return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p_)); }
+    static I set1I(int v_){ return _mm256_set1_epi32(v_); }
+    static I addI(I a_, I b_){ return _mm256_add_epi32(a_, b_); }
+    static I subI(I a_, I b_){ return _mm256_sub_epi32(a_, b_); }
+    static I minI(I a_, I b_){ return _mm256_min_epi32(a_, b_); }
+    static I maxI(I a_, I b_){ return _mm256_max_epi32(a_, b_); }
+    static I selectGtI(I a_, I b_, I x_, I y_){ return _mm256_blendv_epi8(y_, x_, _mm256_cmpgt_epi32(a_, b_)); }
+    static I halfI(I a_){ return _mm256_srai_epi32(_mm256_add_epi32(a_, _mm256_srli_epi32(a_, 31)), 1); }
+    static I truncI(D a_){ return _mm512_cvttpd_epi32(a_); }
+    static D toD(I a_){ return _mm512_cvtepi32_pd(a_); }
+  };
+}
+
+namespace SplineBatch{
+  namespace Avx512{
+    void evalCompactSpline(const Batch& batch_){ SplineBatchKernels<Avx512Lanes>::evalCompactSpline(batch_); }
+    void evalUniformSpline(const Batch& batch_){ SplineBatchKernels<Avx512Lanes>::evalUniformSpline(batch_); }
+    void evalMonotonicSpline(const Batch& batch_){ SplineBatchKernels<Avx512Lanes>::evalMonotonicSpline(batch_); }
+  }
+}
+
+// Local Variables:
+// mode:c++
+// c-basic-offset:2
+// End:
@@ -0,0 +1,113 @@
+#include "CorrelatedThrowGenerator.h"
+
+#include "TDecompChol.h"
+#include "TRandom.h"
+#include "TMath.h"
+
+#include "Logger.h"
+
+#include <cmath>
+
+
+void CorrelatedThrowGenerator::setCovariance(const TMatrixD& covariance_){
+  LogThrowIf(covariance_.GetNrows() != covariance_.GetNcols(), "The covariance matrix is not square.");
+
+  // the factor of a block diagonal matrix is block diagonal: decompose the
+  // independent blocks separately
+  _blocks_.build(covariance_);
+  _nDim_ = covariance_.GetNrows();
+  _choleskyLowerList_.clear();
+  _choleskyLowerList_.resize(_blocks_.getNbBlocks());
+
+  for( int iBlock = 0 ; iBlock < _blocks_.getNbBlocks() ; iBlock++ ){
+    TDecompChol chol(_blocks_.getSubMatrix(covariance_, iBlock));
+    LogThrowIf(not chol.Decompose(), "Cholesky decomposition of the covariance matrix failed.");
+
+    // TDecompChol gives the upper factor U with C = U^T U, so L(i,k) = U(k,i)
+    const TMatrixD& upper = chol.GetU();
+    const int nBlockDim{upper.GetNrows()};
+    auto& lower = _choleskyLowerList_[iBlock];
+    lower.reserve( size_t(nBlockDim) * size_t(nBlockDim+1) / 2 );
+    for( int iDim = 0 ; iDim < nBlockDim ; iDim++ ){
+      for( int kDim = 0 ; kDim <= iDim ; kDim++ ){ lower.emplace_back( upper(kDim, iDim) ); }
+    }
+  }
+}
+
+void CorrelatedThrowGenerator::throwBlock(int nThrows_, std::vector<double>& throwList_){
+  LogThrowIf(_nDim_ == 0, "The covariance matrix has not been set.");
+  auto nThrows = size_t( std::max(0, nThrows_) );
+  auto nDim = size_t( _nDim_ );
+
+  // Box-Muller pairs are never shared between two throws, so each throw uses
+  // the same random numbers whatever the size of the block
+  size_t nUniformPerThrow{ 2 * ((nDim + 1) / 2) };
+  _uniformList_.resize( nThrows * nUniformPerThrow );
+  if( not _uniformList_.empty() ){ gRandom->RndmArray( int(_uniformList_.size()), _uniformList_.data() ); }
+
+  _normalList_.resize( nDim * nThrows );
+  for( size_t iThrow = 0 ; iThrow < nThrows ; iThrow++ ){
+    const double* uniform = &_uniformList_[iThrow * nUniformPerThrow];
+    for( size_t iDim = 0 ; iDim < nDim ; iDim += 2 ){
+      double radius = std::sqrt( -2. * std::log( uniform[iDim] ) );
+      double angle = TMath::TwoPi() * uniform[iDim+1];
+      _normalList_[iDim * nThrows + iThrow] = radius * std::cos(angle);
+      if( iDim+1 < nDim ){ _normalList_[(iDim+1) * nThrows + iThrow] = radius * std::sin(angle); }
+    }
+  }
+
+  // X = L.Z for the whole block: the inner loop runs over the throws, which
+  // are contiguous in the dimension major layout
+  _productList_.assign( nDim * nThrows, 0 );
+  for( int iBlock = 0 ; iBlock < _blocks_.getNbBlocks() ; iBlock++ ){
+    auto& block = _blocks_.getBlock(iBlock);
+    auto& lower = _choleskyLowerList_[iBlock];
+    for( size_t iSub = 0 ; iSub < block.size() ; iSub++ ){
+      const double* lowerRow = &lower[iSub * (iSub+1) / 2];
+      double* product = &_productList_[size_t(block[iSub]) * nThrows];
+      for( size_t kSub = 0 ; kSub <= iSub ; kSub++ ){
+        const double factor{lowerRow[kSub]};
+        if( factor == 0 ){ continue; }
+        const double* normal = &_normalList_[size_t(block[kSub]) * nThrows];
+        for( size_t iThrow = 0 ; iThrow < nThrows ; iThrow++ ){ product[iThrow] += factor * normal[iThrow]; }
+      }
+    }
+  }
+
+  throwList_.resize( nThrows * nDim );
+  for( size_t iDim = 0 ; iDim < nDim ; iDim++ ){
+    for( size_t iThrow = 0 ; iThrow < nThrows ; iThrow++ ){
+      throwList_[iThrow * nDim + iDim] = _productList_[iDim * nThrows + iThrow];
+    }
+  }
+}
+
+long CorrelatedThrowGenerator::throwAccepted(
+    std::vector<double>& out_,
+    const std::function<bool(const double*)>& isValid_,
+    long maxCandidates_
+){
+  auto nDim = size_t( _nDim_ );
+  long nChecked{0};
+  int blockSize{1};
+  while( nChecked < maxCandidates_ ){
+    this->throwBlock( blockSize, _candidateList_ );
+    for( int iCandidate = 0 ; iCandidate < blockSize ; iCandidate++ ){
+      nChecked++;
+      _nCandidates_++;
+      const double* candidate = &_candidateList_[size_t(iCandidate) * nDim];
+      if( not isValid_( candidate ) ){ continue; }
+
+      _nAccepted_++;
+      out_.assign( candidate, candidate + nDim );
+      return nChecked;
+    }
+    blockSize = std::min( 2*blockSize, _maxBlockSize_ );
+  }
+  return 0;
+}
+
+// Local Variables:
+// mode:c++
+// c-basic-offset:2
+// End:
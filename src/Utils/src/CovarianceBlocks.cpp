@@ -0,0 +1,87 @@
+#include "CovarianceBlocks.h"
+
+#include "Logger.h"
+
+#include <numeric>
+#include <sstream>
+#include <algorithm>
+
+
+void CovarianceBlocks::build(const TMatrixDBase& matrix_){
+  LogThrowIf(matrix_.GetNrows() != matrix_.GetNcols(), "The matrix is not square.");
+
+  const int nRows{matrix_.GetNrows()};
+  const double* array{matrix_.GetMatrixArray()};
+
+  // union-find on the non-zero off-diagonal elements
+  std::vector<int> parentList(nRows);
+  std::iota(parentList.begin(), parentList.end(), 0);
+  auto findRoot = [&](int index_){
+    while( parentList[index_] != index_ ){
+      parentList[index_] = parentList[parentList[index_]];
+      index_ = parentList[index_];
+    }
+    return index_;
+  };
+
+  for( int iRow = 0 ; iRow < nRows ; iRow++ ){
+    const double* row{array + size_t(iRow) * nRows};
+    for( int jCol = 0 ; jCol < iRow ; jCol++ ){
+      if( row[jCol] == 0 and array[size_t(jCol) * nRows + iRow] == 0 ){ continue; }
+      int iRoot{findRoot(iRow)};
+      int jRoot{findRoot(jCol)};
+      if( iRoot != jRoot ){ parentList[std::max(iRoot, jRoot)] = std::min(iRoot, jRoot); }
+    }
+  }
+
+  // the blocks are ordered by their first index
+  _blockIndexList_.assign(nRows, -1);
+  _blockList_.clear();
+  std::vector<int> rootBlockList(nRows, -1);
+  for( int iRow = 0 ; iRow < nRows ; iRow++ ){
+    int root{findRoot(iRow)};
+    if( rootBlockList[root] == -1 ){
+      rootBlockList[root] = int(_blockList_.size());
+      _blockList_.emplace_back();
+    }
+    _blockIndexList_[iRow] = rootBlockList[root];
+    _blockList_[rootBlockList[root]].emplace_back(iRow);
+  }
+}
+
+int CovarianceBlocks::getLargestBlockSize() const{
+  size_t largest{0};
+  for( auto& block : _blockList_ ){ largest = std::max(largest, block.size()); }
+  return int(largest);
+}
+size_t CovarianceBlocks::getNbBlockElements() const{
+  size_t nElements{0};
+  for( auto& block : _blockList_ ){ nElements += block.size() * block.size(); }
+  return nElements;
+}
+
+TMatrixDSym CovarianceBlocks::getSubMatrix(const TMatrixDBase& matrix_, int iBlock_) const{
+  auto& block = _blockList_[iBlock_];
+  const int nRows{matrix_.GetNrows()};
+  const double* array{matrix_.GetMatrixArray()};
+
+  TMatrixDSym out(int(block.size()));
+  for( size_t iSub = 0 ; iSub < block.size() ; iSub++ ){
+    for( size_t jSub = 0 ; jSub < block.size() ; jSub++ ){
+      out(int(iSub), int(jSub)) = array[size_t(block[iSub]) * nRows + block[jSub]];
+    }
+  }
+  return out;
+}
+
+std::string CovarianceBlocks::getSummary() const{
+  std::stringstream ss;
+  ss << getNbBlocks() << " independent block" << (getNbBlocks() > 1 ? "s" : "")
+     << " (largest: " << getLargestBlockSize() << "/" << getNbIndices() << ")";
+  return ss.str();
+}
+
+// Local Variables:
+// mode:c++
+// c-basic-offset:2
+// End:
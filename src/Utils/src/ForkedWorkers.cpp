@@ -0,0 +1,192 @@
+#include "ForkedWorkers.h"
+
+#include "Logger.h"
+
+#include <cerrno>
+#include <cmath>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+
+namespace{
+  // in the worker: write all the bytes, or leave
+  void writeAll(int fd_, const char* dataPtr_, size_t nBytes_){
+    while( nBytes_ > 0 ){
+      ssize_t nWritten = write( fd_, dataPtr_, nBytes_ );
+      if( nWritten < 0 and errno == EINTR ){ continue; }
+      if( nWritten <= 0 ){ _exit( EXIT_FAILURE ); }
+      dataPtr_ += nWritten;
+      nBytes_ -= size_t(nWritten);
+    }
+  }
+}
+
+namespace ForkedWorkers{
+
+  void run(
+      int nWorkers_, int nTasks_, const std::string& workerName_,
+      const std::function<void()>& initWorkerFct_,
+      const WorkerFct& workerFct_,
+      const ReceiveFct& receiveFct_
+  ){
+    // don't duplicate what is waiting in the buffers
+    std::cout.flush();
+    std::cerr.flush();
+
+    std::vector<pid_t> pidList(nWorkers_, -1);
+    std::vector<int> pipeReadEndList(nWorkers_, -1);
+
+    // the only error path of the parent: the workers still running are killed
+    auto stopWorkersFct = [&](){
+      for( int iWorker = 0 ; iWorker < nWorkers_ ; iWorker++ ){
+        if( pipeReadEndList[iWorker] >= 0 ){ close( pipeReadEndList[iWorker] ); pipeReadEndList[iWorker] = -1; }
+        if( pidList[iWorker] > 0 ){
+          kill( pidList[iWorker], SIGKILL );
+          waitpid( pidList[iWorker], nullptr, 0 );
+          pidList[iWorker] = -1;
+        }
+      }
+    };
+
+    try{
+      for( int iWorker = 0 ; iWorker < nWorkers_ ; iWorker++ ){
+        int pipeEnds[2];
+        LogThrowIf(pipe(pipeEnds) != 0, "Could not create pipe for " << workerName_ << " #" << iWorker);
+
+        pid_t pid = fork();
+        if( pid < 0 ){
+          close( pipeEnds[0] );
+          close( pipeEnds[1] );
+          LogThrow("Could not fork " << workerName_ << " #" << iWorker);
+        }
+
+        if( pid == 0 ){
+          // child: the read ends belong to the parent
+          close( pipeEnds[0] );
+          for( int iPrevious = 0 ; iPrevious < iWorker ; iPrevious++ ){ close( pipeReadEndList[iPrevious] ); }
+          Logger::setIsMuted( true );
+
+          // never let an exception bring the child back into the caller's code
+          try{
+            if( initWorkerFct_ ){ initWorkerFct_(); }
+
+            std::vector<int> taskList{};
+            for( int iTask = iWorker ; iTask < nTasks_ ; iTask += nWorkers_ ){ taskList.emplace_back( iTask ); }
+
+            std::vector<double> record{};
+            workerFct_( taskList, [&](int iTask_, const std::vector<double>& values_){
+              record.clear();
+              record.emplace_back( iTask_ );
+              record.emplace_back( double(values_.size()) );
+              record.insert( record.end(), values_.begin(), values_.end() );
+              writeAll( pipeEnds[1], reinterpret_cast<const char*>( record.data() ), record.size() * sizeof(double) );
+            });
+          }
+          catch( ... ){ _exit( EXIT_FAILURE ); }
+          close( pipeEnds[1] );
+
+          // skip the destructors / atexit handlers: they belong to the parent
+          _exit( EXIT_SUCCESS );
+        }
+
+        close( pipeEnds[1] );
+        pidList[iWorker] = pid;
+        pipeReadEndList[iWorker] = pipeEnds[0];
+      }
+
+      // read the workers as their records come, and hand them over in the task order
+      int nextTask{0};
+      std::map<int, std::vector<double>> pendingTaskList{};
+      std::vector<std::vector<char>> bytesList(nWorkers_);
+      int nOpenPipes{nWorkers_};
+      while( nOpenPipes > 0 ){
+        std::vector<pollfd> pollList{};
+        std::vector<int> pollWorkerList{};
+        for( int iWorker = 0 ; iWorker < nWorkers_ ; iWorker++ ){
+          if( pipeReadEndList[iWorker] < 0 ){ continue; }
+          pollList.emplace_back();
+          pollList.back().fd = pipeReadEndList[iWorker];
+          pollList.back().events = POLLIN;
+          pollWorkerList.emplace_back( iWorker );
+        }
+        if( poll( pollList.data(), pollList.size(), -1 ) < 0 ){
+          LogThrowIf(errno != EINTR, "Could not poll the " << workerName_ << "s.");
+          continue;
+        }
+
+        for( size_t iPoll = 0 ; iPoll < pollList.size() ; iPoll++ ){
+          if( pollList[iPoll].revents == 0 ){ continue; }
+          int iWorker{pollWorkerList[iPoll]};
+
+          char readBuffer[65536];
+          ssize_t nRead = read( pipeReadEndList[iWorker], readBuffer, sizeof(readBuffer) );
+          if( nRead < 0 and errno == EINTR ){ continue; }
+          if( nRead <= 0 ){
+            close( pipeReadEndList[iWorker] );
+            pipeReadEndList[iWorker] = -1;
+            nOpenPipes--;
+            continue;
+          }
+
+          // [iTask, nValues, values...]
+          auto& bytes = bytesList[iWorker];
+          bytes.insert( bytes.end(), readBuffer, readBuffer + nRead );
+          size_t nParsed{0};
+          while( bytes.size() - nParsed >= 2 * sizeof(double) ){
+            double header[2];
+            std::memcpy( header, bytes.data() + nParsed, sizeof(header) );
+            LogThrowIf(
+                not (header[1] >= 0) or header[1] != std::floor(header[1]) or header[1] > double(bytes.max_size()),
+                "Corrupted message from " << workerName_ << " #" << iWorker
+            );
+            auto nValues = size_t( header[1] );
+            size_t recordSize{ (2 + nValues) * sizeof(double) };
+            if( bytes.size() - nParsed < recordSize ){ break; }
+
+            auto iTask = int( header[0] );
+            LogThrowIf(
+                double(iTask) != header[0] or iTask < nextTask or iTask >= nTasks_ or pendingTaskList.count( iTask ) != 0,
+                "Corrupted message from " << workerName_ << " #" << iWorker
+            );
+            auto& values = pendingTaskList[iTask];
+            values.resize( nValues );
+            if( nValues != 0 ){ std::memcpy( values.data(), bytes.data() + nParsed + 2 * sizeof(double), nValues * sizeof(double) ); }
+            nParsed += recordSize;
+          }
+          bytes.erase( bytes.begin(), bytes.begin() + long(nParsed) );
+        }
+
+        while( not pendingTaskList.empty() and pendingTaskList.begin()->first == nextTask ){
+          receiveFct_( nextTask, pendingTaskList.begin()->second );
+          pendingTaskList.erase( pendingTaskList.begin() );
+          nextTask++;
+        }
+      }
+
+      for( int iWorker = 0 ; iWorker < nWorkers_ ; iWorker++ ){
+        int status{0};
+        waitpid( pidList[iWorker], &status, 0 );
+        pidList[iWorker] = -1;
+        LogThrowIf(not WIFEXITED(status) or WEXITSTATUS(status) != EXIT_SUCCESS, workerName_ << " #" << iWorker << " failed.");
+        LogThrowIf(not bytesList[iWorker].empty(), "Incomplete message from " << workerName_ << " #" << iWorker);
+      }
+      LogThrowIf(nextTask != nTasks_, "Only " << nextTask << "/" << nTasks_ << " tasks have been received from the " << workerName_ << "s.");
+    }
+    catch( ... ){
+      stopWorkersFct();
+      throw;
+    }
+  }
+
+}
+
+// Local Variables:
+// mode:c++
+// c-basic-offset:2
+// End:
@@ -0,0 +1,389 @@
+#include "FormulaProgram.h"
+
+#include <map>
+#include <cmath>
+#include <cctype>
+#include <cstdlib>
+#include <algorithm>
+
+
+namespace {
+
+  // the functions are wrapped so the overloads of <cmath> are resolved
+  double fctSqrt(double x_){ return std::sqrt(x_); }
+  double fctExp(double x_){ return std::exp(x_); }
+  double fctLog(double x_){ return std::log(x_); }
+  double fctLog10(double x_){ return std::log10(x_); }
+  double fctSin(double x_){ return std::sin(x_); }
+  double fctCos(double x_){ return std::cos(x_); }
+  double fctTan(double x_){ return std::tan(x_); }
+  double fctASin(double x_){ return std::asin(x_); }
+  double fctACos(double x_){ return std::acos(x_); }
+  double fctATan(double x_){ return std::atan(x_); }
+  double fctSinH(double x_){ return std::sinh(x_); }
+  double fctCosH(double x_){ return std::cosh(x_); }
+  double fctTanH(double x_){ return std::tanh(x_); }
+  double fctAbs(double x_){ return std::fabs(x_); }
+  double fctFloor(double x_){ return std::floor(x_); }
+  double fctCeil(double x_){ return std::ceil(x_); }
+  double fctSq(double x_){ return x_*x_; }
+  double fctATan2(double y_, double x_){ return std::atan2(y_, x_); }
+  double fctPow(double x_, double y_){ return std::pow(x_, y_); }
+  double fctMin(double x_, double y_){ return std::min(x_, y_); }
+  double fctMax(double x_, double y_){ return std::max(x_, y_); }
+
+  const std::map<std::string, double(*)(double)> function1Map{
+      {"sqrt", &fctSqrt}, {"TMath::Sqrt", &fctSqrt},
+      {"exp", &fctExp}, {"TMath::Exp", &fctExp},
+      {"log", &fctLog}, {"TMath::Log", &fctLog},
+      {"log10", &fctLog10}, {"TMath::Log10", &fctLog10},
+      {"sin", &fctSin}, {"TMath::Sin", &fctSin},
+      {"cos", &fctCos}, {"TMath::Cos", &fctCos},
+      {"tan", &fctTan}, {"TMath::Tan", &fctTan},
+      {"asin", &fctASin}, {"TMath::ASin", &fctASin},
+      {"acos", &fctACos}, {"TMath::ACos", &fctACos},
+      {"atan", &fctATan}, {"TMath::ATan", &fctATan},
+      {"sinh", &fctSinH}, {"TMath::SinH", &fctSinH},
+      {"cosh", &fctCosH}, {"TMath::CosH", &fctCosH},
+      {"tanh", &fctTanH}, {"TMath::TanH", &fctTanH},
+      {"abs", &fctAbs}, {"fabs", &fctAbs}, {"TMath::Abs", &fctAbs},
+      {"floor", &fctFloor}, {"TMath::Floor", &fctFloor},
+      {"ceil", &fctCeil}, {"TMath::Ceil", &fctCeil},
+      {"sq", &fctSq}, {"TMath::Sq", &fctSq},
+  };
+  const std::map<std::string, double(*)(double, double)> function2Map{
+      {"atan2", &fctATan2}, {"TMath::ATan2", &fctATan2},
+      {"pow", &fctPow}, {"TMath::Power", &fctPow},
+      {"min", &fctMin}, {"TMath::Min", &fctMin},
+      {"max", &fctMax}, {"TMath::Max", &fctMax},
+  };
+  // the constants of TFormula, and the TMath ones (which need "()")
+  const std::map<std::string, double> constantMap{
+      {"pi", M_PI}, {"e", M_E}, {"sqrt2", M_SQRT2}, {"ln10", M_LN10},
+  };
+  const std::map<std::string, double> constantFunctionMap{
+      {"TMath::Pi", M_PI}, {"TMath::TwoPi", 2*M_PI}, {"TMath::PiOver2", M_PI_2},
+      {"TMath::E", M_E}, {"TMath::Sqrt2", M_SQRT2}, {"TMath::Ln10", M_LN10},
+  };
+  const std::map<std::string, int> variableMap{ {"x", 0}, {"y", 1}, {"z", 2}, {"t", 3} };
+
+}
+
+
+// Recursive descent parser, from the lowest to the highest precedence:
+// ||, &&, == !=, < > <= >=, + -, * /, unary - + !, ^ (right associative).
+// The instructions are emitted in reverse polish order.
+class FormulaProgram::Compiler{
+
+public:
+  Compiler(const std::string& expression_, FormulaProgram& program_) : _str_(expression_), _program_(program_) {}
+
+  bool run(){
+    parseOr();
+    skipSpaces();
+    if( _error_.empty() and _pos_ != _str_.size() ){ setError("unexpected character"); }
+    return _error_.empty();
+  }
+
+  [[nodiscard]] const std::string& getError() const { return _error_; }
+
+private:
+  void setError(const std::string& what_){
+    if( _error_.empty() ){ _error_ = what_ + " at position " + std::to_string(_pos_); }
+  }
+
+  void skipSpaces(){ while( _pos_ < _str_.size() and std::isspace((unsigned char) _str_[_pos_]) ){ _pos_++; } }
+  bool accept(const char* token_){
+    skipSpaces();
+    std::string token{token_};
+    if( _str_.compare(_pos_, token.size(), token) != 0 ){ return false; }
+    _pos_ += token.size();
+    return true;
+  }
+  // accept a single char operator which isn't the beginning of a longer one
+  bool acceptSingle(char op_, const char* notFollowedBy_){
+    skipSpaces();
+    if( _pos_ >= _str_.size() or _str_[_pos_] != op_ ){ return false; }
+    if( _pos_+1 < _str_.size() and std::string(notFollowedBy_).find(_str_[_pos_+1]) != std::string::npos ){ return false; }
+    _pos_++;
+    return true;
+  }
+
+  void emit(OpCode opCode_, int index_ = 0, double value_ = 0){
+    Instruction instruction;
+    instruction.opCode = opCode_; instruction.index = index_; instruction.value = value_;
+    emit(instruction);
+  }
+  void emit(const Instruction& instruction_){
+    switch( instruction_.opCode ){
+      case OpCode::Constant: case OpCode::Variable: case OpCode::Parameter: _depth_++; break;
+      case OpCode::Negate: case OpCode::Not: case OpCode::Function1: break;
+      default: _depth_--; break; // binary operators
+    }
+    if( _depth_ > FormulaProgram::maxStackSize ){ setError("expression too deep"); }
+    _program_._instructionList_.emplace_back( instruction_ );
+  }
+
+  void parseOr(){
+    parseAnd();
+    while( _error_.empty() and accept("||") ){ parseAnd(); emit(OpCode::Or); }
+  }
+  void parseAnd(){
+    parseEquality();
+    while( _error_.empty() and accept("&&") ){ parseEquality(); emit(OpCode::And); }
+  }
+  void parseEquality(){
+    parseComparison();
+    while( _error_.empty() ){
+      if( accept("==") ){ parseComparison(); emit(OpCode::Equal); }
+      else if( accept("!=") ){ parseComparison(); emit(OpCode::NotEqual); }
+      else{ break; }
+    }
+  }
+  void parseComparison(){
+    parseSum();
+    while( _error_.empty() ){
+      if( accept("<=") ){ parseSum(); emit(OpCode::LessEqual); }
+      else if( accept(">=") ){ parseSum(); emit(OpCode::GreaterEqual); }
+      else if( acceptSingle('<', "<") ){ parseSum(); emit(OpCode::Less); }
+      else if( acceptSingle('>', ">") ){ parseSum(); emit(OpCode::Greater); }
+      else{ break; }
+    }
+  }
+  void parseSum(){
+    parseProduct();
+    while( _error_.empty() ){
+      if( accept("+") ){ parseProduct(); emit(OpCode::Add); }
+      else if( accept("-") ){ parseProduct(); emit(OpCode::Subtract); }
+      else{ break; }
+    }
+  }
+  void parseProduct(){
+    parseUnary();
+    while( _error_.empty() ){
+      if( acceptSingle('*', "*") ){ parseUnary(); emit(OpCode::Multiply); }
+      else if( accept("/") ){ parseUnary(); emit(OpCode::Divide); }
+      else{ break; }
+    }
+  }
+  void parseUnary(){
+    if( accept("-") ){ parseUnary(); emit(OpCode::Negate); }
+    else if( accept("+") ){ parseUnary(); }
+    else if( acceptSingle('!', "=") ){ parseUnary(); emit(OpCode::Not); }
+    else{ parsePower(); }
+  }
+  void parsePower(){
+    parsePrimary();
+    if( _error_.empty() and (accept("^") or accept("**")) ){ parseUnary(); emit(OpCode::Power); }
+  }
+
+  void parsePrimary(){
+    skipSpaces();
+    if( _pos_ >= _str_.size() ){ setError("unexpected end of expression"); return; }
+    char c{_str_[_pos_]};
+
+    if( c == '(' ){
+      _pos_++;
+      parseOr();
+      if( _error_.empty() and not accept(")") ){ setError("missing \")\""); }
+      return;
+    }
+
+    if( c == '[' ){
+      auto end = _str_.find(']', _pos_);
+      if( end == std::string::npos or end == _pos_+1 ){ setError("invalid parameter"); return; }
+      std::string name{_str_.substr(_pos_+1, end-_pos_-1)};
+      _pos_ = end+1;
+      auto& nameList = _program_._parameterNameList_;
+      auto found = std::find(nameList.begin(), nameList.end(), name);
+      if( found == nameList.end() ){ found = nameList.insert(nameList.end(), name); }
+      emit(OpCode::Parameter, int(found - nameList.begin()));
+      return;
+    }
+
+    if( std::isdigit((unsigned char) c) or c == '.' ){
+      const char* begin{_str_.c_str() + _pos_};
+      char* end{nullptr};
+      double value{std::strtod(begin, &end)};
+      if( end == begin ){ setError("invalid number"); return; }
+      _pos_ += end - begin;
+      emit(OpCode::Constant, 0, value);
+      return;
+    }
+
+    if( std::isalpha((unsigned char) c) or c == '_' ){
+      std::string name{readIdentifier()};
+
+      if( accept("[") ){
+        // x[i]
+        if( name != "x" ){ setError("unknown array \"" + name + "\""); return; }
+        skipSpaces();
+        const char* begin{_str_.c_str() + _pos_};
+        char* end{nullptr};
+        long index{std::strtol(begin, &end, 10)};
+        _pos_ += end - begin;
+        if( end == begin or index < 0 or not accept("]") ){ setError("invalid variable index"); return; }
+        emitVariable(int(index));
+        return;
+      }
+
+      if( accept("(") ){
+        if( constantFunctionMap.count(name) != 0 ){
+          if( not accept(")") ){ setError("missing \")\""); return; }
+          emit(OpCode::Constant, 0, constantFunctionMap.at(name));
+          return;
+        }
+        Instruction instruction;
+        if( function1Map.count(name) != 0 ){
+          parseOr();
+          instruction.opCode = OpCode::Function1;
+          instruction.function1 = function1Map.at(name);
+        }
+        else if( function2Map.count(name) != 0 ){
+          parseOr();
+          if( _error_.empty() and not accept(",") ){ setError("missing second argument"); return; }
+          parseOr();
+          instruction.opCode = OpCode::Function2;
+          instruction.function2 = function2Map.at(name);
+        }
+        else{ setError("unknown function \"" + name + "\""); return; }
+        if( _error_.empty() and not accept(")") ){ setError("missing \")\""); return; }
+        emit(instruction);
+        return;
+      }
+
+      if( variableMap.count(name) != 0 ){ emitVariable(variableMap.at(name)); return; }
+      if( constantMap.count(name) != 0 ){ emit(OpCode::Constant, 0, constantMap.at(name)); return; }
+      setError("unknown name \"" + name + "\"");
+      return;
+    }
+
+    setError("unexpected character");
+  }
+
+  std::string readIdentifier(){
+    size_t begin{_pos_};
+    while( _pos_ < _str_.size() ){
+      char c{_str_[_pos_]};
+      if( std::isalnum((unsigned char) c) or c == '_' ){ _pos_++; }
+      else if( c == ':' and _pos_+1 < _str_.size() and _str_[_pos_+1] == ':' ){ _pos_ += 2; }
+      else{ break; }
+    }
+    return _str_.substr(begin, _pos_ - begin);
+  }
+
+  void emitVariable(int index_){
+    _program_._nbVariables_ = std::max(_program_._nbVariables_, index_+1);
+    emit(OpCode::Variable, index_);
+  }
+
+  const std::string& _str_;
+  FormulaProgram& _program_;
+  size_t _pos_{0};
+  int _depth_{0};
+  std::string _error_{};
+
+};
+
+
+bool FormulaProgram::compile(const std::string& expression_){
+  *this = FormulaProgram();
+  _expression_ = expression_;
+
+  Compiler compiler(expression_, *this);
+  if( not compiler.run() ){
+    _error_ = compiler.getError();
+    _instructionList_.clear();
+    _parameterNameList_.clear();
+    _nbVariables_ = 0;
+    return false;
+  }
+  return true;
+}
+
+double FormulaProgram::eval(const double* x_, const double* par_) const {
+  double stack[maxStackSize];
+  int top{-1};
+  for( auto& instruction : _instructionList_ ){
+    switch( instruction.opCode ){
+      case OpCode::Constant:     stack[++top] = instruction.value; break;
+      case OpCode::Variable:     stack[++top] = x_[instruction.index]; break;
+      case OpCode::Parameter:    stack[++top] = par_[instruction.index]; break;
+      case OpCode::Negate:       stack[top] = -stack[top]; break;
+      case OpCode::Not:          stack[top] = !stack[top]; break;
+      case OpCode::Function1:    stack[top] = instruction.function1(stack[top]); break;
+      case OpCode::Add:          top--; stack[top] = stack[top] + stack[top+1]; break;
+      case OpCode::Subtract:     top--; stack[top] = stack[top] - stack[top+1]; break;
+      case OpCode::Multiply:     top--; stack[top] = stack[top] * stack[top+1]; break;
+      case OpCode::Divide:       top--; stack[top] = stack[top] / stack[top+1]; break;
+      case OpCode::Power:        top--; stack[top] = std::pow(stack[top], stack[top+1]); break;
+      case OpCode::Less:         top--; stack[top] = stack[top] < stack[top+1]; break;
+      case OpCode::Greater:      top--; stack[top] = stack[top] > stack[top+1]; break;
+      case OpCode::LessEqual:    top--; stack[top] = stack[top] <= stack[top+1]; break;
+      case OpCode::GreaterEqual: top--; stack[top] = stack[top] >= stack[top+1]; break;
+      case OpCode::Equal:        top--; stack[top] = stack[top] == stack[top+1]; break;
+      case OpCode::NotEqual:     top--; stack[top] = stack[top] != stack[top+1]; break;
+      case OpCode::And:          top--; stack[top] = stack[top] && stack[top+1]; break;
+      case OpCode::Or:           top--; stack[top] = stack[top] || stack[top+1]; break;
+      case OpCode::Function2:    top--; stack[top] = instruction.function2(stack[top], stack[top+1]); break;
+    }
+  }
+  return stack[0];
+}
+
+void FormulaProgram::evalBatch(int n_, const double* const* x_, const double* const* par_, double* result_) const {
+  // one row of the stack per entry of the chunk
+  constexpr int chunkSize{16};
+  double stack[maxStackSize][chunkSize];
+
+  for( int iFirst = 0 ; iFirst < n_ ; iFirst += chunkSize ){
+    const int size{ std::min(chunkSize, n_ - iFirst) };
+    const double* const* x{x_ + iFirst};
+    const double* const* par{par_ + iFirst};
+
+    int top{-1};
+    for( auto& instruction : _instructionList_ ){
+      double* a{nullptr}; const double* b{nullptr};
+      switch( instruction.opCode ){
+        case OpCode::Constant: case OpCode::Variable: case OpCode::Parameter:
+        case OpCode::Negate: case OpCode::Not: case OpCode::Function1:
+          break;
+        default:
+          top--; a = stack[top]; b = stack[top+1]; break;
+      }
+
+      switch( instruction.opCode ){
+        case OpCode::Constant:
+          top++; for( int i = 0 ; i < size ; i++ ){ stack[top][i] = instruction.value; } break;
+        case OpCode::Variable:
+          top++; for( int i = 0 ; i < size ; i++ ){ stack[top][i] = x[i][instruction.index]; } break;
+        case OpCode::Parameter:
+          top++; for( int i = 0 ; i < size ; i++ ){ stack[top][i] = par[i][instruction.index]; } break;
+        case OpCode::Negate:       for( int i = 0 ; i < size ; i++ ){ stack[top][i] = -stack[top][i]; } break;
+        case OpCode::Not:          for( int i = 0 ; i < size ; i++ ){ stack[top][i] = !stack[top][i]; } break;
+        case OpCode::Function1:    for( int i = 0 ; i < size ; i++ ){ stack[top][i] = instruction.function1(stack[top][i]); } break;
+        case OpCode::Add:          for( int i = 0 ; i < size ; i++ ){ a[i] = a[i] + b[i]; } break;
+        case OpCode::Subtract:     for( int i = 0 ; i < size ; i++ ){ a[i] = a[i] - b[i]; } break;
+        case OpCode::Multiply:     for( int i = 0 ; i < size ; i++ ){ a[i] = a[i] * b[i]; } break;
+        case OpCode::Divide:       for( int i = 0 ; i < size ; i++ ){ a[i] = a[i] / b[i]; } break;
+        case OpCode::Power:        for( int i = 0 ; i < size ; i++ ){ a[i] = std::pow(a[i], b[i]); } break;
+        case OpCode::Less:         for( int i = 0 ; i < size ; i++ ){ a[i] = a[i] < b[i]; } break;
+        case OpCode::Greater:      for( int i = 0 ; i < size ; i++ ){ a[i] = a[i] > b[i]; } break;
+        case OpCode::LessEqual:    for( int i = 0 ; i < size ; i++ ){ a[i] = a[i] <= b[i]; } break;
+        case OpCode::GreaterEqual: for( int i = 0 ; i < size ; i++ ){ a[i] = a[i] >= b[i]; } break;
+        case OpCode::Equal:        for( int i = 0 ; i < size ; i++ ){ a[i] = a[i] == b[i]; } break;
+        case OpCode::NotEqual:     for( int i = 0 ; i < size ; i++ ){ a[i] = a[i] != b[i]; } break;
+        case OpCode::And:          for( int i = 0 ; i < size ; i++ ){ a[i] = a[i] && b[i]; } break;
+        case OpCode::Or:           for( int i = 0 ; i < size ; i++ ){ a[i] = a[i] || b[i]; } break;
+        case OpCode::Function2:    for( int i = 0 ; i < size ; i++ ){ a[i] = instruction.function2(a[i], b[i]); } break;
+      }
+    }
+
+    for( int i = 0 ; i < size ; i++ ){ result_[iFirst + i] = stack[0][i]; }
+  }
+}
+
+// Local Variables:
+// mode:c++
+// c-basic-offset:2
+// End:
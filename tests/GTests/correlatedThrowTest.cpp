@@ -0,0 +1,150 @@
+#include <cmath>
+#include <vector>
+
+#include <TDecompChol.h>
+#include <TMath.h>
+#include <TMatrixD.h>
+#include <TMatrixDSym.h>
+#include <TRandom.h>
+
+#include "CorrelatedThrowGenerator.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+    // A positive definite covariance where the parameters given in
+    // blockList are correlated together (constant correlation).
+    TMatrixD makeCovariance(int nDim,
+                            const std::vector<std::vector<int>>& blockList) {
+        TMatrixD covariance(nDim, nDim);
+        for (int i = 0; i < nDim; ++i) covariance(i,i) = 1.0 + 0.5*i;
+        for (const auto& block : blockList) {
+            for (int i : block) {
+                for (int j : block) {
+                    if (i == j) continue;
+                    covariance(i,j) = 0.3*std::sqrt(covariance(i,i)
+                                                    *covariance(j,j));
+                }
+            }
+        }
+        return covariance;
+    }
+}
+
+// The throws don't depend on the number of throws generated together.
+TEST(CorrelatedThrowTest, BlockSizeIndependent)
+{
+    const int nDim = 5;
+    const int nThrows = 9;
+    CorrelatedThrowGenerator generator(makeCovariance(nDim, {{0,1,2,3,4}}));
+
+    gRandom->SetSeed(4357);
+    std::vector<double> blockThrows;
+    generator.throwBlock(nThrows, blockThrows);
+    ASSERT_EQ(blockThrows.size(), size_t(nThrows*nDim));
+
+    gRandom->SetSeed(4357);
+    std::vector<double> singleThrow;
+    for (int iThrow = 0; iThrow < nThrows; ++iThrow) {
+        generator.throwBlock(1, singleThrow);
+        ASSERT_EQ(singleThrow.size(), size_t(nDim));
+        for (int iDim = 0; iDim < nDim; ++iDim) {
+            EXPECT_EQ(singleThrow[iDim], blockThrows[iThrow*nDim + iDim])
+                << "Throw " << iThrow << " dimension " << iDim;
+        }
+    }
+
+    // The accepted throw is the first valid candidate of the sequence,
+    // even when the candidates are drawn by growing blocks.
+    gRandom->SetSeed(4357);
+    std::vector<double> accepted;
+    int nCalls{0};
+    long nChecked = generator.throwAccepted(accepted, [&](const double*){
+        return ++nCalls == 6;
+    });
+    EXPECT_EQ(nChecked, 6);
+    ASSERT_EQ(accepted.size(), size_t(nDim));
+    for (int iDim = 0; iDim < nDim; ++iDim) {
+        EXPECT_EQ(accepted[iDim], blockThrows[5*nDim + iDim])
+            << "Accepted throw dimension " << iDim;
+    }
+}
+
+// The covariance of the throws is the input covariance.
+TEST(CorrelatedThrowTest, Covariance)
+{
+    const int nDim = 4;
+    const int nThrows = 200000;
+    TMatrixD covariance = makeCovariance(nDim, {{0,1,2,3}});
+    CorrelatedThrowGenerator generator(covariance);
+
+    gRandom->SetSeed(1234);
+    std::vector<double> throws;
+    generator.throwBlock(nThrows, throws);
+
+    for (int i = 0; i < nDim; ++i) {
+        for (int j = 0; j <= i; ++j) {
+            double sum{0};
+            for (int iThrow = 0; iThrow < nThrows; ++iThrow) {
+                sum += throws[iThrow*nDim + i]*throws[iThrow*nDim + j];
+            }
+            double expected = covariance(i,j);
+            double sigma = std::sqrt((covariance(i,i)*covariance(j,j)
+                                      + expected*expected)/nThrows);
+            EXPECT_NEAR(sum/nThrows, expected, 5.0*sigma)
+                << "Covariance element " << i << "," << j;
+        }
+    }
+}
+
+// The independent blocks are factorised separately, and the throws are the
+// ones given by the Cholesky factor of the full matrix.
+TEST(CorrelatedThrowTest, BlocksMatchFullFactor)
+{
+    // The blocks don't need to be contiguous.
+    const int nDim = 7;
+    const int nThrows = 11;
+    TMatrixD covariance = makeCovariance(nDim, {{0,2,5}, {1,4,6}});
+    CorrelatedThrowGenerator generator(covariance);
+    ASSERT_EQ(generator.getBlocks().getNbBlocks(), 3);
+    EXPECT_EQ(generator.getBlocks().getBlock(0), std::vector<int>({0,2,5}));
+    EXPECT_EQ(generator.getBlocks().getBlock(1), std::vector<int>({1,4,6}));
+    EXPECT_EQ(generator.getBlocks().getBlock(2), std::vector<int>({3}));
+
+    gRandom->SetSeed(8191);
+    std::vector<double> throws;
+    generator.throwBlock(nThrows, throws);
+
+    // The reference uses the same Box-Muller pairs with the factor of the
+    // full matrix: C = U^T U, so X = U^T Z.
+    TMatrixDSym fullCovariance(nDim);
+    for (int i = 0; i < nDim; ++i) {
+        for (int j = 0; j < nDim; ++j) fullCovariance(i,j) = covariance(i,j);
+    }
+    TDecompChol chol(fullCovariance);
+    ASSERT_TRUE(chol.Decompose());
+    const TMatrixD& upper = chol.GetU();
+
+    const int nUniformPerThrow = 2*((nDim+1)/2);
+    std::vector<double> uniform(nThrows*nUniformPerThrow);
+    gRandom->SetSeed(8191);
+    gRandom->RndmArray(int(uniform.size()), uniform.data());
+
+    for (int iThrow = 0; iThrow < nThrows; ++iThrow) {
+        std::vector<double> normal(nDim+1);
+        for (int iDim = 0; iDim < nDim; iDim += 2) {
+            const double* u = &uniform[iThrow*nUniformPerThrow + iDim];
+            double radius = std::sqrt(-2.0*std::log(u[0]));
+            normal[iDim] = radius*std::cos(TMath::TwoPi()*u[1]);
+            normal[iDim+1] = radius*std::sin(TMath::TwoPi()*u[1]);
+        }
+        for (int iDim = 0; iDim < nDim; ++iDim) {
+            double expected{0};
+            for (int k = 0; k <= iDim; ++k) {
+                expected += upper(k,iDim)*normal[k];
+            }
+            EXPECT_NEAR(throws[iThrow*nDim + iDim], expected, 1E-12)
+                << "Throw " << iThrow << " dimension " << iDim;
+        }
+    }
+}
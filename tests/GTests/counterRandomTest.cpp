@@ -0,0 +1,141 @@
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "CounterRandom.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+    // The mean and the variance of n values given by a generator.
+    template<typename Generator>
+    void computeMoments(int n, Generator generator,
+                        double& mean, double& variance) {
+        double sum{0};
+        double sum2{0};
+        for (int i = 0; i < n; ++i) {
+            double v = generator(i);
+            sum += v;
+            sum2 += v*v;
+        }
+        mean = sum/n;
+        variance = sum2/n - mean*mean;
+    }
+
+    // Build the generator for a Philox4x32 counter and key (the 64 bits of
+    // the index, the 48 bits of the stream and the 16 bits of the block).
+    void generatePhilox(const uint32_t ctr[4], const uint32_t key[2],
+                        uint32_t out[4]) {
+        uint64_t seed = (uint64_t(key[1]) << 32) | key[0];
+        uint64_t stream = (uint64_t(ctr[3] & 0xFFFF) << 32) | ctr[2];
+        uint64_t index = (uint64_t(ctr[1]) << 32) | ctr[0];
+        uint32_t block = ctr[3] >> 16;
+        CounterRandom(seed, stream).generate(index, block, out);
+    }
+}
+
+// The known answers of Philox4x32-10 given with Random123 (kat_vectors).
+TEST(CounterRandomTest, PhiloxKnownAnswers)
+{
+    struct KnownAnswer {
+        uint32_t ctr[4];
+        uint32_t key[2];
+        uint32_t expected[4];
+    };
+    std::vector<KnownAnswer> answers{
+        {{0x00000000, 0x00000000, 0x00000000, 0x00000000},
+         {0x00000000, 0x00000000},
+         {0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}},
+        {{0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff},
+         {0xffffffff, 0xffffffff},
+         {0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}},
+        {{0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344},
+         {0xa4093822, 0x299f31d0},
+         {0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}},
+    };
+
+    for (const auto& answer : answers) {
+        uint32_t out[4];
+        generatePhilox(answer.ctr, answer.key, out);
+        for (int i = 0; i < 4; ++i) {
+            EXPECT_EQ(out[i], answer.expected[i])
+                << "Philox output " << i << " for counter " << std::hex
+                << answer.ctr[0] << " " << answer.ctr[1] << " "
+                << answer.ctr[2] << " " << answer.ctr[3];
+        }
+    }
+}
+
+TEST(CounterRandomTest, Reproducible)
+{
+    CounterRandom rng(12345, 7);
+    CounterRandom same(12345, 7);
+    CounterRandom otherStream(12345, 8);
+    CounterRandom subStream = rng.getSubStream(0);
+
+    // The values only depend on (seed, stream, index, draw), whatever the
+    // order of the calls.
+    for (int i = 99; i >= 0; --i) {
+        EXPECT_EQ(rng.uniform(i, 3), same.uniform(i, 3));
+        EXPECT_EQ(rng.gaus(i, 1), same.gaus(i, 1));
+        EXPECT_EQ(rng.poisson(4.5, i), same.poisson(4.5, i));
+        EXPECT_NE(rng.uniform(i), otherStream.uniform(i));
+        EXPECT_NE(rng.uniform(i), subStream.uniform(i));
+        EXPECT_NE(rng.uniform(i, 0), rng.uniform(i, 1));
+    }
+    EXPECT_EQ(subStream.getStream(), rng.getStream());
+    EXPECT_NE(rng.getSubStream(1).getSeed(), subStream.getSeed());
+}
+
+TEST(CounterRandomTest, UniformMoments)
+{
+    const int n = 1000000;
+    CounterRandom rng(2024, 1);
+    double mean;
+    double variance;
+    computeMoments(n, [&](int i){
+        double u = rng.uniform(i);
+        EXPECT_TRUE(0.0 < u && u < 1.0) << "Uniform out of ]0,1[: " << u;
+        return u;
+    }, mean, variance);
+    // Five standard deviations of the estimators.
+    EXPECT_NEAR(mean, 0.5, 5.0*std::sqrt(1.0/12.0/n));
+    EXPECT_NEAR(variance, 1.0/12.0, 5.0*std::sqrt(1.0/180.0/n));
+}
+
+TEST(CounterRandomTest, GausMoments)
+{
+    const int n = 1000000;
+    CounterRandom rng(2024, 2);
+    double mean;
+    double variance;
+    computeMoments(n, [&](int i){ return rng.gaus(i); }, mean, variance);
+    EXPECT_NEAR(mean, 0.0, 5.0*std::sqrt(1.0/n));
+    EXPECT_NEAR(variance, 1.0, 5.0*std::sqrt(2.0/n));
+
+    computeMoments(n, [&](int i){ return rng.gaus(3.0, 0.5, i, 1); },
+                   mean, variance);
+    EXPECT_NEAR(mean, 3.0, 5.0*0.5*std::sqrt(1.0/n));
+    EXPECT_NEAR(variance, 0.25, 5.0*0.25*std::sqrt(2.0/n));
+}
+
+// The means below 10 use the multiplication method, and the other ones use
+// the transformed rejection.
+TEST(CounterRandomTest, PoissonMoments)
+{
+    const int n = 200000;
+    CounterRandom rng(2024, 3);
+    for (double mu : {0.5, 3.0, 9.9, 10.0, 25.0, 300.0}) {
+        double mean;
+        double variance;
+        computeMoments(n, [&](int i){ return double(rng.poisson(mu, i)); },
+                       mean, variance);
+        // The variance of the sample variance is mu*(1+2*mu)/n.
+        EXPECT_NEAR(mean, mu, 5.0*std::sqrt(mu/n))
+            << "Poisson mean for mu=" << mu;
+        EXPECT_NEAR(variance, mu, 5.0*std::sqrt(mu*(1.0+2.0*mu)/n))
+            << "Poisson variance for mu=" << mu;
+    }
+    EXPECT_EQ(rng.poisson(0.0, 0), uint64_t(0));
+    EXPECT_EQ(rng.poisson(-1.0, 0), uint64_t(0));
+}
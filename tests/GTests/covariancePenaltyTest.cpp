@@ -0,0 +1,108 @@
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <TFile.h>
+#include <TMatrixDSym.h>
+#include <TRandom3.h>
+#include <TVectorD.h>
+
+#include "ParameterSet.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+    // The penalty computed with the full product delta^T C^-1 delta.
+    double fullPenalty(const ParameterSet& parSet,
+                       const TMatrixDSym& inverse) {
+        const auto& parList = parSet.getParameterList();
+        double penalty{0};
+        for (size_t i = 0; i < parList.size(); ++i) {
+            double iDelta = parList[i].getParameterValue()
+                - parList[i].getPriorValue();
+            for (size_t j = 0; j < parList.size(); ++j) {
+                double jDelta = parList[j].getParameterValue()
+                    - parList[j].getPriorValue();
+                penalty += iDelta*inverse(int(i),int(j))*jDelta;
+            }
+        }
+        return penalty;
+    }
+}
+
+// The incremental updates of the penalty (a few parameters moved) give the
+// same result as the full product, including after the periodic refresh.
+TEST(CovariancePenaltyTest, IncrementalMatchesFullProduct)
+{
+    // Three independent blocks, which aren't contiguous.
+    const int nPars = 8;
+    const std::vector<std::vector<int>> blockList{{0,3,5}, {1,2}, {4,6,7}};
+    TMatrixDSym covariance(nPars);
+    TVectorD prior(nPars);
+    for (int i = 0; i < nPars; ++i) {
+        covariance(i,i) = 0.04*(1.0 + i);
+        prior(i) = 1.0 + 0.1*i;
+    }
+    for (const auto& block : blockList) {
+        for (int i : block) {
+            for (int j : block) {
+                if (i == j) continue;
+                covariance(i,j) = 0.4*std::sqrt(covariance(i,i)
+                                                *covariance(j,j));
+            }
+        }
+    }
+
+    const std::string path{"covariancePenaltyTest.root"};
+    {
+        std::unique_ptr<TFile> file(TFile::Open(path.c_str(), "RECREATE"));
+        ASSERT_TRUE(file != nullptr && file->IsOpen());
+        covariance.Write("covariance");
+        prior.Write("prior");
+        file->Close();
+    }
+
+    JsonType config;
+    config["name"] = "penaltyTest";
+    config["parameterDefinitionFilePath"] = path;
+    config["covarianceMatrix"] = "covariance";
+    config["parameterPriorValueList"] = "prior";
+
+    ParameterSet parSet;
+    parSet.configure(config);
+    parSet.initialize();
+    std::remove(path.c_str());
+    ASSERT_EQ(parSet.getParameterList().size(), size_t(nPars));
+
+    TMatrixDSym inverse(covariance);
+    inverse.Invert();
+
+    auto& parList = parSet.getParameterList();
+    TRandom3 rng(4357);
+    EXPECT_NEAR(parSet.evalCovariancePenalty(), 0.0, 1E-12);
+    // More than 100 incremental updates happen between the full moves, so
+    // the refresh of the incremental cache is also checked.
+    for (int iStep = 0; iStep < 600; ++iStep) {
+        if (iStep % 150 == 149) {
+            // Move all the parameters (full product).
+            for (auto& par : parList) {
+                par.setParameterValue(par.getPriorValue()
+                                      + rng.Gaus(0.0, par.getStdDevValue()));
+            }
+        }
+        else if (iStep % 10 != 9) {
+            // Move one parameter, as in the gradient of Migrad.
+            auto& par = parList[rng.Integer(nPars)];
+            par.setParameterValue(par.getPriorValue()
+                                  + rng.Gaus(0.0, par.getStdDevValue()));
+        }
+        // else: nothing moved
+
+        double expected = fullPenalty(parSet, inverse);
+        double penalty = parSet.evalCovariancePenalty();
+        EXPECT_NEAR(penalty, expected, 1E-9*std::max(1.0, expected))
+            << "Penalty mismatch at step " << iStep;
+    }
+}
@@ -0,0 +1,108 @@
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <TFormula.h>
+
+#include "FormulaProgram.h"
+
+#include "gtest/gtest.h"
+
+// The compiled programs give the TFormula results, with the parameters
+// given in the order of getParameterNameList().
+TEST(FormulaProgramTest, MatchesTFormula)
+{
+    const std::vector<std::string> expressionList{
+        "[0]+[1]*x",
+        "[norm]*TMath::Exp(-0.5*(x-[mean])*(x-[mean])/([sigma]*[sigma]))",
+        "sqrt(x*x+y*y)+atan2(y,x)",
+        "x^2-2^y+pow(z,3)",
+        "(x>0)*x+(x<=0)*[a]*x",
+        "(x>1 && y<2) || !(z==0)",
+        "x[0]*x[1]-x[2]/x[3]",
+        "TMath::Max(x,y)-TMath::Min(x,[0])+TMath::Abs(z)",
+        "-x*-[0]+1.5e-1*log(fabs(y)+1)",
+        "TMath::Pi()*x",
+    };
+
+    for (const auto& expression : expressionList) {
+        FormulaProgram program;
+        ASSERT_TRUE(program.compile(expression))
+            << expression << ": " << program.getError();
+        TFormula formula("formula", expression.c_str());
+        ASSERT_TRUE(formula.IsValid()) << expression;
+
+        // Set the same parameter values in both.
+        const auto& parNameList = program.getParameterNameList();
+        std::vector<double> parList(parNameList.size());
+        for (size_t iPar = 0; iPar < parNameList.size(); ++iPar) {
+            const auto& name = parNameList[iPar];
+            bool isNumber = std::all_of(name.begin(), name.end(), [](char c){
+                return std::isdigit((unsigned char) c); });
+            int iFormulaPar = isNumber
+                ? std::stoi(name) : formula.GetParNumber(name.c_str());
+            ASSERT_TRUE(0 <= iFormulaPar && iFormulaPar < formula.GetNpar())
+                << expression << ": parameter [" << name << "]";
+            parList[iPar] = 0.6 + 0.45*iPar;
+            formula.SetParameter(iFormulaPar, parList[iPar]);
+        }
+
+        const int nVariables = std::max({program.getNbVariables(),
+                                         formula.GetNdim(), 1});
+        std::vector<std::vector<double>> xList;
+        for (int iPoint = 0; iPoint < 50; ++iPoint) {
+            std::vector<double> x(nVariables);
+            for (int iVar = 0; iVar < nVariables; ++iVar) {
+                x[iVar] = 2.5*std::sin(0.37*iPoint + 1.1*iVar) + 0.01;
+            }
+            xList.push_back(x);
+        }
+
+        std::vector<const double*> xPtrList;
+        std::vector<const double*> parPtrList;
+        for (const auto& x : xList) {
+            double expected = formula.EvalPar(x.data());
+            double result = program.eval(x.data(), parList.data());
+            if (std::isnan(expected)) {
+                EXPECT_TRUE(std::isnan(result)) << expression;
+            }
+            else {
+                EXPECT_NEAR(result, expected,
+                            1E-10*std::max(1.0, std::abs(expected)))
+                    << expression << " at x=" << x[0];
+            }
+            xPtrList.push_back(x.data());
+            parPtrList.push_back(parList.data());
+        }
+
+        // The batch evaluation gives the same results.
+        std::vector<double> resultList(xList.size());
+        program.evalBatch(int(xList.size()), xPtrList.data(),
+                          parPtrList.data(), resultList.data());
+        for (size_t iPoint = 0; iPoint < xList.size(); ++iPoint) {
+            double result = program.eval(xList[iPoint].data(),
+                                         parList.data());
+            if (std::isnan(result)) {
+                EXPECT_TRUE(std::isnan(resultList[iPoint])) << expression;
+            }
+            else {
+                EXPECT_EQ(resultList[iPoint], result)
+                    << expression << " (batch) point " << iPoint;
+            }
+        }
+    }
+}
+
+// The expressions which can't be compiled are rejected, so the caller keeps
+// using the TFormula.
+TEST(FormulaProgramTest, RejectsUnsupported)
+{
+    for (const std::string expression : {"gaus(0)", "pol2", "x+", "[0]*(1+"}) {
+        FormulaProgram program;
+        EXPECT_FALSE(program.compile(expression)) << expression;
+        EXPECT_FALSE(program.isCompiled()) << expression;
+        EXPECT_FALSE(program.getError().empty()) << expression;
+    }
+}
@@ -0,0 +1,366 @@
+#include <cmath>
+#include <sstream>
+#include <vector>
+
+#include "CalculateCompactSpline.h"
+#include "CalculateUniformSpline.h"
+#include "CalculateMonotonicSpline.h"
+#include "CalculateGeneralSpline.h"
+#undef CHECK_OFFSET // also defined by CalculateGraph
+#include "CalculateGraph.h"
+#include "CalculateSplineBasis.h"
+#include "CalculateSplineBatch.h"
+
+#include "gtest/gtest.h"
+
+namespace {
+    // The function sampled by the splines (not a cubic).
+    double testFunction(double x) { return 1.0 + 0.5*std::sin(1.3*x) + 0.1*x*x; }
+    double testSlope(double x) { return 0.65*std::cos(1.3*x) + 0.2*x; }
+
+    // The numbers of knots of the test splines.  The knot searches handle up
+    // to 17 knots.
+    const std::vector<int> knotCountList{2, 3, 5, 9, 17};
+
+    // The points where the splines are evaluated, including points before
+    // the first knot and after the last knot.
+    std::vector<double> makePoints() {
+        std::vector<double> points;
+        for (double x = -4.5; x <= 4.5; x += 0.037) points.push_back(x);
+        for (double x = -3.0; x <= 3.0; x += 0.75) points.push_back(x);
+        return points;
+    }
+
+    // Uniform knots between -3 and 3: data[2+n] is the value of knot n.
+    std::vector<double> makeCompactData(int nKnots, double scale) {
+        std::vector<double> data{-3.0, 6.0/(nKnots-1)};
+        for (int k = 0; k < nKnots; ++k) {
+            data.push_back(scale*testFunction(data[0] + k*data[1]));
+        }
+        return data;
+    }
+
+    // Uniform knots between -3 and 3 with (value, slope) pairs.
+    std::vector<double> makeUniformData(int nKnots, double scale) {
+        std::vector<double> data{-3.0, 6.0/(nKnots-1)};
+        for (int k = 0; k < nKnots; ++k) {
+            double x = data[0] + k*data[1];
+            data.push_back(scale*testFunction(x));
+            data.push_back(scale*testSlope(x));
+        }
+        return data;
+    }
+
+    // The knot positions of the general splines and graphs: between -3 and
+    // 3, not uniform.
+    std::vector<double> makeKnots(int nKnots) {
+        std::vector<double> knots;
+        for (int k = 0; k < nKnots; ++k) {
+            double u = -1.0 + 2.0*k/(nKnots-1);
+            knots.push_back(3.0*u*(0.6 + 0.4*u*u));
+        }
+        return knots;
+    }
+
+    // General spline: (value, slope, x) triplets.
+    std::vector<double> makeGeneralData(int nKnots, double scale) {
+        std::vector<double> knots = makeKnots(nKnots);
+        std::vector<double> data{knots.front(), 0.0};
+        for (double x : knots) {
+            data.push_back(scale*testFunction(x));
+            data.push_back(scale*testSlope(x));
+            data.push_back(x);
+        }
+        return data;
+    }
+
+    // Graph: (value, x) pairs.
+    std::vector<double> makeGraphData(int nKnots, double scale) {
+        std::vector<double> data;
+        for (double x : makeKnots(nKnots)) {
+            data.push_back(scale*testFunction(x));
+            data.push_back(x);
+        }
+        return data;
+    }
+
+    // The cubic Hermite interpolation on a segment.
+    double referenceHermite(double fx, double p1, double m1,
+                            double p2, double m2) {
+        return p1*(2.0*fx*fx*fx - 3.0*fx*fx + 1.0)
+            + m1*(fx*fx*fx - 2.0*fx*fx + fx)
+            + p2*(3.0*fx*fx - 2.0*fx*fx*fx)
+            + m2*(fx*fx*fx - fx*fx);
+    }
+
+    // The segment of x in a sorted list of knots (linear search), up to
+    // maxSegment.  The first and the last segments are extrapolated.
+    int referenceSegment(double x, const std::vector<double>& knots,
+                         int maxSegment) {
+        int ix = 0;
+        while (ix < maxSegment && x > knots[ix+1]) ++ix;
+        return ix;
+    }
+
+    double referenceUniform(double x, const std::vector<double>& data) {
+        const int nKnots = (int(data.size())-2)/2;
+        const double step = data[1];
+        const double xx = (x - data[0])/step;
+        int ix = int(std::floor(xx));
+        if (ix < 0) ix = 0;
+        if (ix > nKnots-2) ix = nKnots-2;
+        return referenceHermite(xx - ix,
+                                data[2+2*ix], data[2+2*ix+1]*step,
+                                data[2+2*ix+2], data[2+2*ix+3]*step);
+    }
+
+    double referenceGeneral(double x, const std::vector<double>& data) {
+        std::vector<double> knots;
+        for (size_t i = 4; i < data.size(); i += 3) knots.push_back(data[i]);
+        // The search of the general splines stops one segment early: the
+        // last segment is never used.
+        const int ix = referenceSegment(x, knots,
+                                        std::max(0, int(knots.size())-3));
+        const double step = knots[ix+1] - knots[ix];
+        return referenceHermite((x - knots[ix])/step,
+                                data[2+3*ix], data[2+3*ix+1]*step,
+                                data[2+3*ix+3], data[2+3*ix+4]*step);
+    }
+
+    double referenceGraph(double x, const std::vector<double>& data) {
+        std::vector<double> knots;
+        for (size_t i = 1; i < data.size(); i += 2) knots.push_back(data[i]);
+        const int ix = referenceSegment(x, knots, int(knots.size())-2);
+        const double x1 = knots[ix];
+        const double x2 = knots[ix+1];
+        return data[2*ix] + (x - x1)*(data[2*ix+2] - data[2*ix])/(x2 - x1);
+    }
+
+    // Check a value within a relative tolerance.
+    void expectClose(double value, double expected, const std::string& msg) {
+        EXPECT_NEAR(value, expected, 1E-10*std::max(1.0, std::abs(expected)))
+            << msg;
+    }
+
+    std::string describe(const char* type, int nKnots, double x) {
+        std::ostringstream tmp;
+        tmp << type << " with " << nKnots << " knots at x=" << x;
+        return tmp.str();
+    }
+}
+
+// The scalar kernels match a direct implementation of the interpolation,
+// including the extrapolation before the first and after the last knot.
+TEST(SplineKernelsTest, ScalarMatchesReference)
+{
+    for (int nKnots : knotCountList) {
+        auto uniform = makeUniformData(nKnots, 1.0);
+        auto general = makeGeneralData(nKnots, 1.0);
+        auto graph = makeGraphData(nKnots, 1.0);
+        for (double x : makePoints()) {
+            expectClose(CalculateUniformSpline(x, -100.0, 100.0,
+                                               uniform.data(),
+                                               int(uniform.size())),
+                        referenceUniform(x, uniform),
+                        describe("Uniform spline", nKnots, x));
+            expectClose(CalculateGeneralSpline(x, -100.0, 100.0,
+                                               general.data(),
+                                               int(general.size())),
+                        referenceGeneral(x, general),
+                        describe("General spline", nKnots, x));
+            // The graph search reads past the data beyond the last point.
+            if (x > graph.back()) continue;
+            expectClose(CalculateGraph(x, -100.0, 100.0,
+                                       graph.data(), int(graph.size())),
+                        referenceGraph(x, graph),
+                        describe("Graph", nKnots, x));
+        }
+    }
+}
+
+// The batch kernels give exactly the scalar results with every instruction
+// set, including the clamping of the responses.
+TEST(SplineKernelsTest, BatchMatchesScalar)
+{
+    typedef double (*ScalarFct)(double, double, double, const double*, int);
+    struct Kernel {
+        const char* name;
+        SplineBatch::BatchFct batchFct;
+        ScalarFct scalarFct;
+        std::vector<double> (*makeData)(int, double);
+        int dimOffset; // dim = data size + dimOffset
+        bool pastLastKnot; // evaluated beyond the last knot
+    };
+    const std::vector<Kernel> kernelList{
+        {"Compact spline", SplineBatch::evalCompactSpline,
+         CalculateCompactSpline, makeCompactData, -2, true},
+        {"Uniform spline", SplineBatch::evalUniformSpline,
+         CalculateUniformSpline, makeUniformData, 0, true},
+        {"Monotonic spline", SplineBatch::evalMonotonicSpline,
+         CalculateMonotonicSpline, makeCompactData, -2, true},
+        {"General spline", SplineBatch::evalGeneralSpline,
+         CalculateGeneralSpline, makeGeneralData, 0, true},
+        {"Graph", SplineBatch::evalGraph,
+         CalculateGraph, makeGraphData, 0, false},
+    };
+
+    const SplineBatch::Isa savedIsa = SplineBatch::getIsa();
+    const std::vector<double> points = makePoints();
+    for (auto isa : {SplineBatch::Isa::Portable, SplineBatch::Isa::Avx2,
+                     SplineBatch::Isa::Avx512}) {
+        SplineBatch::setIsa(isa);
+        const char* isaName = SplineBatch::getIsaName(SplineBatch::getIsa());
+        for (const auto& kernel : kernelList) {
+            // The graph search reads past the data beyond the last point, so
+            // the graphs are evaluated up to their last point (x=3).
+            std::vector<double> x(points);
+            if (not kernel.pastLastKnot) {
+                for (auto& value : x) value = std::min(value, 3.0);
+            }
+
+            // One dial per point, cycling through the spline sizes and
+            // scales, and through wide and tight bounds.
+            std::vector<std::vector<double>> dataList;
+            for (int nKnots : knotCountList) {
+                dataList.push_back(kernel.makeData(nKnots, 1.0));
+                dataList.push_back(kernel.makeData(nKnots, -0.7));
+            }
+            const int n = int(points.size());
+            std::vector<double> lower(n), upper(n), result(n);
+            std::vector<const double*> data(n);
+            std::vector<int> dim(n);
+            for (int i = 0; i < n; ++i) {
+                const auto& spline = dataList[i % dataList.size()];
+                data[i] = spline.data();
+                dim[i] = int(spline.size()) + kernel.dimOffset;
+                lower[i] = (i % 3 == 0) ? 0.8 : -100.0;
+                upper[i] = (i % 3 == 0) ? 1.2 : 100.0;
+            }
+            SplineBatch::Batch batch;
+            batch.size = n;
+            batch.x = x.data();
+            batch.lowerBound = lower.data();
+            batch.upperBound = upper.data();
+            batch.data = data.data();
+            batch.dim = dim.data();
+            batch.result = result.data();
+            kernel.batchFct(batch);
+
+            for (int i = 0; i < n; ++i) {
+                double expected = kernel.scalarFct(x[i], lower[i],
+                                                   upper[i], data[i], dim[i]);
+                EXPECT_EQ(result[i], expected)
+                    << kernel.name << " (" << isaName << ") dial " << i
+                    << " at x=" << x[i];
+            }
+        }
+    }
+    SplineBatch::setIsa(savedIsa);
+}
+
+// A basis computed with one spline gives the response of every spline on the
+// same knot grid (up to the rounding).
+TEST(SplineKernelsTest, BasisMatchesScalar)
+{
+    for (int nKnots : knotCountList) {
+        auto compact = makeCompactData(nKnots, 1.0);
+        auto otherCompact = makeCompactData(nKnots, -0.7);
+        auto uniform = makeUniformData(nKnots, 1.0);
+        auto otherUniform = makeUniformData(nKnots, -0.7);
+        auto general = makeGeneralData(nKnots, 1.0);
+        auto otherGeneral = makeGeneralData(nKnots, -0.7);
+        const int compactDim = int(compact.size()) - 2;
+        const int uniformDim = int(uniform.size());
+        const int generalDim = int(general.size());
+
+        // Splines with the same grid share the basis.
+        std::vector<double> grid;
+        std::vector<double> otherGrid;
+        GetGeneralSplineGrid(general.data(), generalDim, grid);
+        GetGeneralSplineGrid(otherGeneral.data(), generalDim, otherGrid);
+        EXPECT_EQ(grid, otherGrid);
+
+        for (double x : makePoints()) {
+            SplineBasis basis;
+            CalculateCompactSplineBasis(x, compact.data(), compactDim, basis);
+            expectClose(CalculateSplineFromBasis(basis, -100.0, 100.0,
+                                                 otherCompact.data()),
+                        CalculateCompactSpline(x, -100.0, 100.0,
+                                               otherCompact.data(),
+                                               compactDim),
+                        describe("Compact spline basis", nKnots, x));
+
+            CalculateUniformSplineBasis(x, uniform.data(), uniformDim, basis);
+            expectClose(CalculateSplineFromBasis(basis, -100.0, 100.0,
+                                                 otherUniform.data()),
+                        CalculateUniformSpline(x, -100.0, 100.0,
+                                               otherUniform.data(),
+                                               uniformDim),
+                        describe("Uniform spline basis", nKnots, x));
+
+            CalculateGeneralSplineBasis(x, general.data(), generalDim, basis);
+            expectClose(CalculateSplineFromBasis(basis, -100.0, 100.0,
+                                                 otherGeneral.data()),
+                        CalculateGeneralSpline(x, -100.0, 100.0,
+                                               otherGeneral.data(),
+                                               generalDim),
+                        describe("General spline basis", nKnots, x));
+
+            // The clamping is the one of the kernels.
+            expectClose(CalculateSplineFromBasis(basis, 0.9, 1.1,
+                                                 general.data()),
+                        CalculateGeneralSpline(x, 0.9, 1.1,
+                                               general.data(), generalDim),
+                        describe("Clamped general spline basis", nKnots, x));
+        }
+    }
+}
+
+// The hinted kernels give exactly the results of the searches, whatever the
+// previous segment: small steps (the hint is used) and jumps (the hint is
+// wrong), including beyond the first and the last knots of the splines.
+TEST(SplineKernelsTest, HintedMatchesSearch)
+{
+    for (int nKnots : knotCountList) {
+        auto general = makeGeneralData(nKnots, 1.0);
+        auto graph = makeGraphData(nKnots, 1.0);
+        const int generalDim = int(general.size());
+        const int graphDim = int(graph.size());
+
+        std::vector<double> points;
+        for (double x = -4.0; x <= 4.0; x += 0.01) points.push_back(x);
+        for (double x = 4.0; x >= -4.0; x -= 0.013) points.push_back(x);
+        for (int i = 0; i < 200; ++i) points.push_back(4.0*std::sin(1.7*i));
+
+        SegmentHint generalHint;
+        SegmentHint graphHint;
+        for (double x : points) {
+            EXPECT_EQ(CalculateGeneralSplineHinted(x, -100.0, 100.0,
+                                                   general.data(), generalDim,
+                                                   generalHint),
+                      CalculateGeneralSpline(x, -100.0, 100.0,
+                                             general.data(), generalDim))
+                << describe("Hinted general spline", nKnots, x);
+            EXPECT_EQ(generalHint.segment,
+                      FindGeneralSplineSegment(x, general.data(), generalDim))
+                << describe("General spline hint", nKnots, x);
+
+            // The graph search reads past the data beyond the last point.
+            if (x > graph.back()) continue;
+
+            EXPECT_EQ(CalculateGraphHinted(x, -100.0, 100.0,
+                                           graph.data(), graphDim, graphHint),
+                      CalculateGraph(x, -100.0, 100.0,
+                                     graph.data(), graphDim))
+                << describe("Hinted graph", nKnots, x);
+            EXPECT_EQ(graphHint.segment,
+                      FindGraphSegment(x, graph.data(), graphDim))
+                << describe("Graph hint", nKnots, x);
+        }
+
+        // The small steps mostly stay in the same segment.
+        EXPECT_EQ(generalHint.nCalls, long(points.size()));
+        EXPECT_GT(generalHint.nHits, generalHint.nCalls/2);
+        EXPECT_GT(graphHint.nHits, graphHint.nCalls/2);
+    }
+}
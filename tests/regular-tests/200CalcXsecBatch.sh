@@ -0,0 +1,44 @@
+#!/bin/bash
+
+# Set the base name for this test (should match the script name)
+BASE=200CalcXsecBatch
+
+# Get the directory containing the script from the command line
+# parameters (avoids bash trickery).  Use the current directory as the
+# default.
+DIR=.
+if [ ${#1} -gt 0 ]; then
+    DIR=${1}
+fi
+
+# Make sure that gundam has been setup.
+if ! which gundamCalcXsec; then
+    echo FAIL: Executable not found for gundamCalcXsec
+    exit 1
+fi
+
+# The toys are thrown around the fit done by the fast-tests.
+FITTER_FILE=${PWD}/200CovarianceFit.root
+if [ ! -f ${FITTER_FILE} ]; then
+    echo FAIL: Fitter output not found: ${FITTER_FILE}
+    exit 1
+fi
+
+# Set the expected locations for the config and output files.  The
+# fitter config refers to the binning of the fast-tests.
+export CONFIG_DIR=${DIR}/../fast-tests
+export DATA_DIR=${PWD}
+
+# Generate the same toys, one at a time and four per batch.  With the
+# same seed, the throws must be identical.
+for BATCH in 1 4; do
+    CONFIG_FILE=${DIR}/${BASE}-batch${BATCH}.yaml
+    OUTPUT_FILE=${DATA_DIR}/${BASE}-batch${BATCH}.root
+
+    echo ${OUTPUT_FILE}
+    echo ${CONFIG_FILE}
+
+    gundamCalcXsec -t 1 -s 10000 -n 20 -c ${CONFIG_FILE} -f ${FITTER_FILE} -o ${OUTPUT_FILE}
+done
+
+# End of the script